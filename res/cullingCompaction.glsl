@@ -0,0 +1,23 @@
+// Compaction shared by the cull shaders. The includer enables GL_KHR_shader_subgroup_ballot,
+// declares the visibleInstances array and defines COMPACTION_COUNTER as the instance count of
+// the draw command the visible instances are appended to.
+
+// Every invocation of the subgroup has to call this, visible or not. firstVisible is where the
+// draw's instances start in visibleInstances.
+void compactVisible(uint instance, bool visible, uint firstVisible) {
+    // One atomic per subgroup reserves room for all of its visible instances, which are then
+    // written in order at their prefix sum within the subgroup.
+    uvec4 ballot = subgroupBallot(visible);
+    uint visibleCount = subgroupBallotBitCount(ballot);
+    uint base = 0;
+
+    if (subgroupElect() && visibleCount > 0) {
+        base = atomicAdd(COMPACTION_COUNTER, visibleCount);
+    }
+
+    base = firstVisible + subgroupBroadcastFirst(base);
+
+    if (visible) {
+        visibleInstances[base + subgroupBallotExclusiveBitCount(ballot)] = instance;
+    }
+}
@@ -252,10 +252,12 @@ class App {
 
         textureImage = Image::createTextureArray("res/cubesImg.png", vulkanState.allocator,
                                                  vulkanState.commands, vulkanState.graphicsQueue,
-                                                 vulkanState.device, true, 16, 16, 4);
-        textureImageView = textureImage.createTextureView(vulkanState.device);
-        textureSampler = textureImage.createTextureSampler(
-            vulkanState.physicalDevice, vulkanState.device, VK_FILTER_NEAREST, VK_FILTER_NEAREST);
+                                                 vulkanState.device, true, 16, 16, 4, nullptr,
+                                                 &vulkanState.extensions);
+        textureImageView =
+            textureImage.getTextureView(vulkanState.imageViewCache, vulkanState.device);
+        textureSampler = textureImage.getTextureSampler(
+            vulkanState.samplerCache, vulkanState.device, VK_FILTER_NEAREST, VK_FILTER_NEAREST);
 
         generateVoxelMesh();
         voxelModel = Model<VertexData, uint16_t, InstanceData>::fromVerticesAndIndices(
@@ -362,10 +364,12 @@ class App {
 
         vulkanState.commands.beginBuffer(currentFrame);
 
-        renderPass.begin(imageIndex, commandBuffer, extent, clearValues);
-        pipeline.bind(commandBuffer, currentFrame);
+        StateTracker& stateTracker = vulkanState.stateTrackers[currentFrame];
 
-        voxelModel.draw(commandBuffer);
+        renderPass.begin(imageIndex, commandBuffer, extent, clearValues, &stateTracker);
+        pipeline.bind(commandBuffer, currentFrame, &stateTracker);
+
+        voxelModel.draw(commandBuffer, &stateTracker);
 
         renderPass.end(commandBuffer);
 
@@ -383,9 +387,8 @@ class App {
 
         ubo.destroy(vulkanState.allocator);
 
-        vkDestroySampler(vulkanState.device, textureSampler, nullptr);
-        vkDestroyImageView(vulkanState.device, textureImageView, nullptr);
-        textureImage.destroy(vulkanState.allocator);
+        vulkanState.samplerCache.release(vulkanState.device, textureSampler);
+        textureImage.destroy(vulkanState.allocator, vulkanState.imageViewCache, vulkanState.device);
 
         voxelModel.destroy(vulkanState.allocator);
     }
@@ -398,7 +401,7 @@ class App {
                 this->init(vulkanState, window, width, height);
             };
 
-        std::function<void(VulkanState&)> updateCallback = [&](VulkanState vulkanState) {
+        std::function<void(VulkanState&)> updateCallback = [&](VulkanState& vulkanState) {
             this->update(vulkanState);
         };
 
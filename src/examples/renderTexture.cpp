@@ -206,7 +206,53 @@ class App {
     std::vector<uint16_t> voxelIndices;
     std::vector<VkClearValue> clearValues;
 
+    // The final pass descriptor writes point into these.
+    VkDescriptorBufferInfo finalBufferInfo{};
+    VkDescriptorImageInfo finalImageInfo{};
+    VkDescriptorImageInfo finalColorImageInfo{};
+
   public:
+    void writeFinalDescriptors(std::vector<VkWriteDescriptorSet>& descriptorWrites,
+                               VkDescriptorSet descriptorSet, uint32_t i) {
+        finalBufferInfo.buffer = ubo.getBuffer(i);
+        finalBufferInfo.offset = 0;
+        finalBufferInfo.range = ubo.getDataSize();
+
+        finalImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        finalImageInfo.imageView = textureImageView;
+        finalImageInfo.sampler = textureSampler;
+
+        finalColorImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        finalColorImageInfo.imageView = colorImageView;
+        finalColorImageInfo.sampler = colorSampler;
+
+        descriptorWrites.resize(3);
+
+        descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[0].dstSet = descriptorSet;
+        descriptorWrites[0].dstBinding = 0;
+        descriptorWrites[0].dstArrayElement = 0;
+        descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        descriptorWrites[0].descriptorCount = 1;
+        descriptorWrites[0].pBufferInfo = &finalBufferInfo;
+
+        descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[1].dstSet = descriptorSet;
+        descriptorWrites[1].dstBinding = 1;
+        descriptorWrites[1].dstArrayElement = 0;
+        descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        descriptorWrites[1].descriptorCount = 1;
+        descriptorWrites[1].pImageInfo = &finalImageInfo;
+
+        descriptorWrites[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[2].dstSet = descriptorSet;
+        descriptorWrites[2].dstBinding = 2;
+        descriptorWrites[2].dstArrayElement = 0;
+        descriptorWrites[2].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        descriptorWrites[2].descriptorCount = 1;
+        descriptorWrites[2].pImageInfo = &finalColorImageInfo;
+    }
+
     int32_t getVoxel(size_t x, size_t y, size_t z) {
         if (x < 0 || x >= mapSize || y < 0 || y >= mapSize || z < 0 || z >= mapSize) {
             return 0;
@@ -258,10 +304,12 @@ class App {
 
         textureImage = Image::createTextureArray("res/cubesImg.png", vulkanState.allocator,
                                                  vulkanState.commands, vulkanState.graphicsQueue,
-                                                 vulkanState.device, true, 16, 16, 4);
-        textureImageView = textureImage.createTextureView(vulkanState.device);
-        textureSampler = textureImage.createTextureSampler(
-            vulkanState.physicalDevice, vulkanState.device, VK_FILTER_NEAREST, VK_FILTER_NEAREST);
+                                                 vulkanState.device, true, 16, 16, 4, nullptr,
+                                                 &vulkanState.extensions);
+        textureImageView =
+            textureImage.getTextureView(vulkanState.imageViewCache, vulkanState.device);
+        textureSampler = textureImage.getTextureSampler(
+            vulkanState.samplerCache, vulkanState.device, VK_FILTER_NEAREST, VK_FILTER_NEAREST);
 
         VkSamplerCreateInfo samplerInfo{};
         samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
@@ -279,10 +327,7 @@ class App {
         samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
         samplerInfo.maxLod = 1.0f;
 
-        if (vkCreateSampler(vulkanState.device, &samplerInfo, nullptr, &colorSampler) !=
-            VK_SUCCESS) {
-            throw std::runtime_error("Failed to create color sampler!");
-        }
+        colorSampler = vulkanState.samplerCache.get(vulkanState.device, samplerInfo);
 
         generateVoxelMesh();
         voxelModel = Model<VertexData, uint16_t, InstanceData>::fromVerticesAndIndices(
@@ -376,94 +421,63 @@ class App {
         finalRenderPass.create(vulkanState.physicalDevice, vulkanState.device,
                                vulkanState.allocator, vulkanState.swapchain, true, false);
 
-        finalPipeline.createDescriptorSetLayout(
-            vulkanState.device, [&](std::vector<VkDescriptorSetLayoutBinding>& bindings) {
-                VkDescriptorSetLayoutBinding uboLayoutBinding{};
-                uboLayoutBinding.binding = 0;
-                uboLayoutBinding.descriptorCount = 1;
-                uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-                uboLayoutBinding.pImmutableSamplers = nullptr;
-                uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-
-                VkDescriptorSetLayoutBinding samplerLayoutBinding{};
-                samplerLayoutBinding.binding = 1;
-                samplerLayoutBinding.descriptorCount = 1;
-                samplerLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-                samplerLayoutBinding.pImmutableSamplers = nullptr;
-                samplerLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-
-                VkDescriptorSetLayoutBinding depthSamplerLayoutBinding{};
-                depthSamplerLayoutBinding.binding = 2;
-                depthSamplerLayoutBinding.descriptorCount = 1;
-                depthSamplerLayoutBinding.descriptorType =
-                    VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-                depthSamplerLayoutBinding.pImmutableSamplers = nullptr;
-                depthSamplerLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-
-                bindings.push_back(uboLayoutBinding);
-                bindings.push_back(samplerLayoutBinding);
-                bindings.push_back(depthSamplerLayoutBinding);
-            });
-        finalPipeline.createDescriptorPool(
-            vulkanState.maxFramesInFlight, vulkanState.device,
-            [&](std::vector<VkDescriptorPoolSize> poolSizes) {
-                poolSizes.resize(3);
-                poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-                poolSizes[0].descriptorCount = static_cast<uint32_t>(vulkanState.maxFramesInFlight);
-                poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-                poolSizes[1].descriptorCount = static_cast<uint32_t>(vulkanState.maxFramesInFlight);
-                poolSizes[2].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-                poolSizes[2].descriptorCount = static_cast<uint32_t>(vulkanState.maxFramesInFlight);
-            });
-        finalPipeline.createDescriptorSets(
-            vulkanState.maxFramesInFlight, vulkanState.device,
-            [&](std::vector<VkWriteDescriptorSet>& descriptorWrites, VkDescriptorSet descriptorSet,
-                uint32_t i) {
-                VkDescriptorBufferInfo bufferInfo{};
-                bufferInfo.buffer = ubo.getBuffer(i);
-                bufferInfo.offset = 0;
-                bufferInfo.range = ubo.getDataSize();
-
-                VkDescriptorImageInfo imageInfo{};
-                imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-                imageInfo.imageView = textureImageView;
-                imageInfo.sampler = textureSampler;
-
-                VkDescriptorImageInfo depthImageInfo{};
-                depthImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-                depthImageInfo.imageView = colorImageView;
-                depthImageInfo.sampler = colorSampler;
-
-                descriptorWrites.resize(3);
-
-                descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-                descriptorWrites[0].dstSet = descriptorSet;
-                descriptorWrites[0].dstBinding = 0;
-                descriptorWrites[0].dstArrayElement = 0;
-                descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-                descriptorWrites[0].descriptorCount = 1;
-                descriptorWrites[0].pBufferInfo = &bufferInfo;
-
-                descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-                descriptorWrites[1].dstSet = descriptorSet;
-                descriptorWrites[1].dstBinding = 1;
-                descriptorWrites[1].dstArrayElement = 0;
-                descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-                descriptorWrites[1].descriptorCount = 1;
-                descriptorWrites[1].pImageInfo = &imageInfo;
-
-                descriptorWrites[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-                descriptorWrites[2].dstSet = descriptorSet;
-                descriptorWrites[2].dstBinding = 2;
-                descriptorWrites[2].dstArrayElement = 0;
-                descriptorWrites[2].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-                descriptorWrites[2].descriptorCount = 1;
-                descriptorWrites[2].pImageInfo = &depthImageInfo;
+        auto setupFinalBindings = [&](std::vector<VkDescriptorSetLayoutBinding>& bindings) {
+            VkDescriptorSetLayoutBinding uboLayoutBinding{};
+            uboLayoutBinding.binding = 0;
+            uboLayoutBinding.descriptorCount = 1;
+            uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+            uboLayoutBinding.pImmutableSamplers = nullptr;
+            uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+
+            VkDescriptorSetLayoutBinding samplerLayoutBinding{};
+            samplerLayoutBinding.binding = 1;
+            samplerLayoutBinding.descriptorCount = 1;
+            samplerLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            samplerLayoutBinding.pImmutableSamplers = nullptr;
+            samplerLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+            VkDescriptorSetLayoutBinding depthSamplerLayoutBinding{};
+            depthSamplerLayoutBinding.binding = 2;
+            depthSamplerLayoutBinding.descriptorCount = 1;
+            depthSamplerLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            depthSamplerLayoutBinding.pImmutableSamplers = nullptr;
+            depthSamplerLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+            bindings.push_back(uboLayoutBinding);
+            bindings.push_back(samplerLayoutBinding);
+            bindings.push_back(depthSamplerLayoutBinding);
+        };
 
-                vkUpdateDescriptorSets(vulkanState.device,
-                                       static_cast<uint32_t>(descriptorWrites.size()),
-                                       descriptorWrites.data(), 0, nullptr);
-            });
+        if (vulkanState.extensions.pushDescriptor) {
+            // The offscreen color view changes on every resize, so it is pushed while recording.
+            finalPipeline.createPushDescriptorSetLayout(vulkanState.device, vulkanState.extensions,
+                                                        setupFinalBindings);
+        } else {
+            finalPipeline.createDescriptorSetLayout(vulkanState.device, setupFinalBindings);
+            finalPipeline.createDescriptorPool(
+                vulkanState.maxFramesInFlight, vulkanState.device,
+                [&](std::vector<VkDescriptorPoolSize> poolSizes) {
+                    poolSizes.resize(3);
+                    poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+                    poolSizes[0].descriptorCount =
+                        static_cast<uint32_t>(vulkanState.maxFramesInFlight);
+                    poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+                    poolSizes[1].descriptorCount =
+                        static_cast<uint32_t>(vulkanState.maxFramesInFlight);
+                    poolSizes[2].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+                    poolSizes[2].descriptorCount =
+                        static_cast<uint32_t>(vulkanState.maxFramesInFlight);
+                });
+            finalPipeline.createDescriptorSets(
+                vulkanState.maxFramesInFlight, vulkanState.device,
+                [&](std::vector<VkWriteDescriptorSet>& descriptorWrites,
+                    VkDescriptorSet descriptorSet, uint32_t i) {
+                    writeFinalDescriptors(descriptorWrites, descriptorSet, i);
+                    vkUpdateDescriptorSets(vulkanState.device,
+                                           static_cast<uint32_t>(descriptorWrites.size()),
+                                           descriptorWrites.data(), 0, nullptr);
+                });
+        }
         finalPipeline.create<VertexData, InstanceData>("res/renderTextureFinalShader.vert.spv",
                                                        "res/renderTextureFinalShader.frag.spv",
                                                        vulkanState.device, finalRenderPass, false);
@@ -549,6 +563,12 @@ class App {
         finalRenderPass.begin(imageIndex, commandBuffer, extent, clearValues);
         finalPipeline.bind(commandBuffer, currentFrame);
 
+        if (vulkanState.extensions.pushDescriptor) {
+            std::vector<VkWriteDescriptorSet> descriptorWrites;
+            writeFinalDescriptors(descriptorWrites, VK_NULL_HANDLE, currentFrame);
+            finalPipeline.pushDescriptors(commandBuffer, descriptorWrites);
+        }
+
         voxelModel.draw(commandBuffer);
 
         finalRenderPass.end(commandBuffer);
@@ -573,11 +593,10 @@ class App {
 
         ubo.destroy(vulkanState.allocator);
 
-        vkDestroySampler(vulkanState.device, colorSampler, nullptr);
+        vulkanState.samplerCache.release(vulkanState.device, colorSampler);
 
-        vkDestroySampler(vulkanState.device, textureSampler, nullptr);
-        vkDestroyImageView(vulkanState.device, textureImageView, nullptr);
-        textureImage.destroy(vulkanState.allocator);
+        vulkanState.samplerCache.release(vulkanState.device, textureSampler);
+        textureImage.destroy(vulkanState.allocator, vulkanState.imageViewCache, vulkanState.device);
 
         voxelModel.destroy(vulkanState.allocator);
     }
@@ -590,7 +609,7 @@ class App {
                 this->init(vulkanState, window, width, height);
             };
 
-        std::function<void(VulkanState&)> updateCallback = [&](VulkanState vulkanState) {
+        std::function<void(VulkanState&)> updateCallback = [&](VulkanState& vulkanState) {
             this->update(vulkanState);
         };
 
@@ -106,6 +106,7 @@ class App {
     Model<VertexData, uint16_t, InstanceData> updateTestModel;
 
     uint32_t frameCount = 0;
+    std::vector<uint8_t> stampPixels;
 
     std::vector<VkClearValue> clearValues;
 
@@ -120,10 +121,12 @@ class App {
 
         textureImage =
             Image::createTexture("res/updateImg.png", vulkanState.allocator, vulkanState.commands,
-                                 vulkanState.graphicsQueue, vulkanState.device, true);
-        textureImageView = textureImage.createTextureView(vulkanState.device);
+                                 vulkanState.graphicsQueue, vulkanState.device, true, nullptr,
+                                 &vulkanState.extensions);
+        textureImageView =
+            textureImage.getTextureView(vulkanState.imageViewCache, vulkanState.device);
         textureSampler =
-            textureImage.createTextureSampler(vulkanState.physicalDevice, vulkanState.device);
+            textureImage.getTextureSampler(vulkanState.samplerCache, vulkanState.device);
 
         updateTestModel = Model<VertexData, uint16_t, InstanceData>::create(3, vulkanState.allocator,
             vulkanState.commands, vulkanState.graphicsQueue, vulkanState.device);
@@ -156,18 +159,10 @@ class App {
 
                 bindings.push_back(uboLayoutBinding);
                 bindings.push_back(samplerLayoutBinding);
-            });
-        pipeline.createDescriptorPool(
-            vulkanState.maxFramesInFlight, vulkanState.device,
-            [&](std::vector<VkDescriptorPoolSize> poolSizes) {
-                poolSizes.resize(2);
-                poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-                poolSizes[0].descriptorCount = static_cast<uint32_t>(vulkanState.maxFramesInFlight);
-                poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-                poolSizes[1].descriptorCount = static_cast<uint32_t>(vulkanState.maxFramesInFlight);
-            });
+            },
+            &vulkanState.descriptorLayoutCache);
         pipeline.createDescriptorSets(
-            vulkanState.maxFramesInFlight, vulkanState.device,
+            vulkanState.maxFramesInFlight, vulkanState.device, vulkanState.descriptorAllocator,
             [&](std::vector<VkWriteDescriptorSet>& descriptorWrites, VkDescriptorSet descriptorSet,
                 uint32_t i) {
                 VkDescriptorBufferInfo bufferInfo{};
@@ -206,6 +201,14 @@ class App {
                                                   "res/updateShader.frag.spv", vulkanState.device,
                                                   renderPass, false);
 
+        stampPixels.resize(16 * 16 * 4);
+        for (size_t i = 0; i < stampPixels.size(); i += 4) {
+            stampPixels[i] = 255;
+            stampPixels[i + 1] = 255;
+            stampPixels[i + 2] = 0;
+            stampPixels[i + 3] = 255;
+        }
+
         clearValues.resize(2);
         clearValues[0].color = {{0.0f, 0.0f, 0.0f, 1.0f}};
         clearValues[1].depthStencil = {1.0f, 0};
@@ -251,6 +254,18 @@ class App {
 
         vulkanState.commands.beginBuffer(currentFrame);
 
+        // Stamp a block into the texture now and then, which has to happen outside the render
+        // pass.
+        if (frameCount % 600 == 0) {
+            uint32_t stampCount = (textureImage.getWidth() / 16) * (textureImage.getHeight() / 16);
+            uint32_t stamp = (frameCount / 600) % stampCount;
+            uint32_t stampsPerRow = textureImage.getWidth() / 16;
+
+            textureImage.updateRegion(vulkanState.stagingRing, commandBuffer, stampPixels.data(),
+                                      (stamp % stampsPerRow) * 16, (stamp / stampsPerRow) * 16, 16,
+                                      16, 0, 0, true);
+        }
+
         renderPass.begin(imageIndex, commandBuffer, extent, clearValues);
         pipeline.bind(commandBuffer, currentFrame);
 
@@ -272,9 +287,8 @@ class App {
 
         ubo.destroy(vulkanState.allocator);
 
-        vkDestroySampler(vulkanState.device, textureSampler, nullptr);
-        vkDestroyImageView(vulkanState.device, textureImageView, nullptr);
-        textureImage.destroy(vulkanState.allocator);
+        vulkanState.samplerCache.release(vulkanState.device, textureSampler);
+        textureImage.destroy(vulkanState.allocator, vulkanState.imageViewCache, vulkanState.device);
 
         updateTestModel.destroy(vulkanState.allocator);
     }
@@ -287,7 +301,7 @@ class App {
                 this->init(vulkanState, window, width, height);
             };
 
-        std::function<void(VulkanState&)> updateCallback = [&](VulkanState vulkanState) {
+        std::function<void(VulkanState&)> updateCallback = [&](VulkanState& vulkanState) {
             this->update(vulkanState);
         };
 
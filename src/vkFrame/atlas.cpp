@@ -0,0 +1,180 @@
+#include "atlas.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+TextureAtlas::TextureAtlas() {}
+
+TextureAtlas::TextureAtlas(uint32_t layerWidth, uint32_t layerHeight, uint32_t padding)
+    : layerWidth(layerWidth), layerHeight(layerHeight), padding(padding) {}
+
+uint32_t TextureAtlas::add(const std::string& image) {
+    int32_t width, height, texChannels;
+    stbi_uc* pixels = stbi_load(image.c_str(), &width, &height, &texChannels, STBI_rgb_alpha);
+
+    if (!pixels) {
+        throw std::runtime_error("Failed to load atlas image!");
+    }
+
+    uint32_t id = add(pixels, width, height);
+    stbi_image_free(pixels);
+
+    return id;
+}
+
+uint32_t TextureAtlas::add(const uint8_t* pixels, uint32_t width, uint32_t height) {
+    if (width == 0 || height == 0) {
+        throw std::runtime_error("Atlas image must not be empty!");
+    }
+
+    if (width + padding * 2 > layerWidth || height + padding * 2 > layerHeight) {
+        throw std::runtime_error("Atlas image is larger than an atlas layer!");
+    }
+
+    Entry entry;
+    entry.width = width;
+    entry.height = height;
+    entry.pixels.assign(pixels, pixels + static_cast<size_t>(width) * height * 4);
+    entries.push_back(std::move(entry));
+    dirty = true;
+
+    return static_cast<uint32_t>(entries.size() - 1);
+}
+
+void TextureAtlas::pack() {
+    std::vector<uint32_t> order(entries.size());
+    for (uint32_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+
+    // Shelf packing works best when each shelf holds images of a similar height.
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        if (entries[a].height != entries[b].height) {
+            return entries[a].height > entries[b].height;
+        }
+
+        return entries[a].width > entries[b].width;
+    });
+
+    uint32_t layer = 0;
+    uint32_t cursorX = 0;
+    uint32_t shelfY = 0;
+    uint32_t shelfHeight = 0;
+
+    for (uint32_t i : order) {
+        Entry& entry = entries[i];
+        uint32_t paddedWidth = entry.width + padding * 2;
+        uint32_t paddedHeight = entry.height + padding * 2;
+
+        if (cursorX + paddedWidth > layerWidth) {
+            shelfY += shelfHeight;
+            cursorX = 0;
+            shelfHeight = 0;
+        }
+
+        if (shelfY + paddedHeight > layerHeight) {
+            layer++;
+            shelfY = 0;
+            cursorX = 0;
+            shelfHeight = 0;
+        }
+
+        entry.x = cursorX + padding;
+        entry.y = shelfY + padding;
+        entry.layer = layer;
+
+        cursorX += paddedWidth;
+        shelfHeight = std::max(shelfHeight, paddedHeight);
+    }
+
+    layerCount = layer + 1;
+
+    regions.resize(entries.size());
+    for (size_t i = 0; i < entries.size(); i++) {
+        const Entry& entry = entries[i];
+        regions[i].u0 = entry.x / static_cast<float>(layerWidth);
+        regions[i].v0 = entry.y / static_cast<float>(layerHeight);
+        regions[i].u1 = (entry.x + entry.width) / static_cast<float>(layerWidth);
+        regions[i].v1 = (entry.y + entry.height) / static_cast<float>(layerHeight);
+        regions[i].layer = entry.layer;
+    }
+
+    dirty = false;
+}
+
+Image TextureAtlas::build(VmaAllocator allocator, Commands& commands, VkQueue graphicsQueue,
+                          VkDevice device, bool enableMipmaps,
+                          MipmapGenerator* mipmapGenerator) {
+    if (dirty) {
+        pack();
+    }
+
+    size_t layerByteSize = static_cast<size_t>(layerWidth) * layerHeight * 4;
+    std::vector<uint8_t> pixels(layerByteSize * layerCount, 0);
+
+    for (const Entry& entry : entries) {
+        blit(entry, pixels.data() + layerByteSize * entry.layer);
+    }
+
+    Buffer stagingBuffer(allocator, pixels.size(), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, true);
+    stagingBuffer.setData(pixels.data());
+
+    // Layers are stacked vertically in the staging buffer, one full layer after another.
+    Image atlasImage = Image::fromBuffer(stagingBuffer, allocator, commands, graphicsQueue, device,
+                                         enableMipmaps, layerWidth, layerHeight, layerCount,
+                                         layerWidth, layerHeight * layerCount, mipmapGenerator);
+    // Sampled as a sampler2DArray even when everything fits into one layer.
+    atlasImage.setViewType(VK_IMAGE_VIEW_TYPE_2D_ARRAY);
+
+    stagingBuffer.destroy(allocator);
+
+    return atlasImage;
+}
+
+void TextureAtlas::blit(const Entry& entry, uint8_t* layerPixels) {
+    // Extrude the edges of each image into its padding so that filtering and mipmapping don't
+    // bleed neighbouring images into it.
+    int32_t pad = static_cast<int32_t>(padding);
+    int32_t width = static_cast<int32_t>(entry.width);
+    int32_t height = static_cast<int32_t>(entry.height);
+
+    for (int32_t y = -pad; y < height + pad; y++) {
+        int32_t srcY = std::clamp(y, 0, height - 1);
+        uint8_t* dstRow = layerPixels + ((entry.y + y) * layerWidth + entry.x) * 4;
+        const uint8_t* srcRow = entry.pixels.data() + srcY * width * 4;
+
+        for (int32_t x = -pad; x < 0; x++) {
+            memcpy(dstRow + x * 4, srcRow, 4);
+        }
+
+        memcpy(dstRow, srcRow, width * 4);
+
+        for (int32_t x = width; x < width + pad; x++) {
+            memcpy(dstRow + x * 4, srcRow + (width - 1) * 4, 4);
+        }
+    }
+}
+
+const AtlasRegion& TextureAtlas::getRegion(uint32_t id) {
+    if (dirty) {
+        pack();
+    }
+
+    if (id >= regions.size()) {
+        throw std::out_of_range("Unknown atlas image!");
+    }
+
+    return regions[id];
+}
+
+uint32_t TextureAtlas::getLayerCount() {
+    if (dirty) {
+        pack();
+    }
+
+    return layerCount;
+}
+
+uint32_t TextureAtlas::getLayerWidth() { return layerWidth; }
+
+uint32_t TextureAtlas::getLayerHeight() { return layerHeight; }
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <vk_mem_alloc.h>
+#include <vulkan/vulkan.h>
+
+#include <cinttypes>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "image.hpp"
+
+struct AtlasRegion {
+    float u0 = 0.0f;
+    float v0 = 0.0f;
+    float u1 = 0.0f;
+    float v1 = 0.0f;
+    uint32_t layer = 0;
+};
+
+/*
+ * Packs many RGBA8 images of varying sizes into the layers of a single texture array,
+ * so that they can all be sampled through one descriptor binding.
+ */
+class TextureAtlas {
+  public:
+    TextureAtlas();
+    TextureAtlas(uint32_t layerWidth, uint32_t layerHeight, uint32_t padding = 1);
+
+    uint32_t add(const std::string& image);
+    uint32_t add(const uint8_t* pixels, uint32_t width, uint32_t height);
+    void pack();
+    Image build(VmaAllocator allocator, Commands& commands, VkQueue graphicsQueue, VkDevice device,
+                bool enableMipmaps, MipmapGenerator* mipmapGenerator = nullptr);
+
+    const AtlasRegion& getRegion(uint32_t id);
+    uint32_t getLayerCount();
+    uint32_t getLayerWidth();
+    uint32_t getLayerHeight();
+
+  private:
+    struct Entry {
+        std::vector<uint8_t> pixels;
+        uint32_t width;
+        uint32_t height;
+        uint32_t x = 0;
+        uint32_t y = 0;
+        uint32_t layer = 0;
+    };
+
+    void blit(const Entry& entry, uint8_t* layerPixels);
+
+    std::vector<Entry> entries;
+    std::vector<AtlasRegion> regions;
+    uint32_t layerWidth = 0;
+    uint32_t layerHeight = 0;
+    uint32_t padding = 1;
+    uint32_t layerCount = 0;
+    bool dirty = true;
+};
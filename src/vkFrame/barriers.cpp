@@ -0,0 +1,179 @@
+#include "barriers.hpp"
+
+static const VkAccessFlags writeAccessMask =
+    VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+    VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT |
+    VK_ACCESS_HOST_WRITE_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+
+ImageAccess getLayoutAccess(VkImageLayout layout) {
+    switch (layout) {
+    case VK_IMAGE_LAYOUT_UNDEFINED:
+        return {layout, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0};
+    case VK_IMAGE_LAYOUT_GENERAL:
+        return {layout, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT};
+    case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
+        return {layout, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT};
+    case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL:
+        return {layout,
+                VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT |
+                    VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT |
+                    VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT};
+    case VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL:
+        return {layout,
+                VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT |
+                    VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_SHADER_READ_BIT};
+    case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
+        // Sampled by draws as well as by the compute passes, like mipmapping and culling.
+        return {layout,
+                VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+                    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                VK_ACCESS_SHADER_READ_BIT};
+    case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
+        return {layout, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT};
+    case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
+        return {layout, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT};
+    case VK_IMAGE_LAYOUT_PRESENT_SRC_KHR:
+        return {layout, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0};
+    default:
+        throw std::invalid_argument("Unsupported layout transition!");
+    }
+}
+
+void BarrierBatch::transition(Image& image, VkImageLayout newLayout, uint32_t baseMipLevel,
+                              uint32_t levelCount, uint32_t baseArrayLayer, uint32_t layerCount) {
+    transition(image, getLayoutAccess(newLayout), baseMipLevel, levelCount, baseArrayLayer,
+               layerCount);
+}
+
+void BarrierBatch::transition(Image& image, const ImageAccess& newAccess, uint32_t baseMipLevel,
+                              uint32_t levelCount, uint32_t baseArrayLayer, uint32_t layerCount) {
+    if (levelCount == VK_REMAINING_MIP_LEVELS) {
+        levelCount = image.getMipmapLevels() - baseMipLevel;
+    }
+
+    if (layerCount == VK_REMAINING_ARRAY_LAYERS) {
+        layerCount = image.getLayerCount() - baseArrayLayer;
+    }
+
+    for (uint32_t mipLevel = baseMipLevel; mipLevel < baseMipLevel + levelCount; mipLevel++) {
+        // Neighbouring layers that share the same previous state are covered by one barrier.
+        uint32_t runStart = baseArrayLayer;
+        ImageAccess runAccess = image.getSubresourceAccess(mipLevel, baseArrayLayer);
+
+        for (uint32_t layer = baseArrayLayer; layer <= baseArrayLayer + layerCount; layer++) {
+            bool endOfRange = layer == baseArrayLayer + layerCount;
+
+            if (!endOfRange) {
+                const ImageAccess& access = image.getSubresourceAccess(mipLevel, layer);
+
+                if (access.layout == runAccess.layout && access.stageMask == runAccess.stageMask &&
+                    access.accessMask == runAccess.accessMask) {
+                    continue;
+                }
+            }
+
+            addBarrier(image, runAccess, newAccess, mipLevel, runStart, layer - runStart);
+
+            if (!endOfRange) {
+                runStart = layer;
+                runAccess = image.getSubresourceAccess(mipLevel, layer);
+            }
+        }
+    }
+}
+
+void BarrierBatch::addBarrier(Image& image, const ImageAccess& oldAccess,
+                              const ImageAccess& newAccess, uint32_t mipLevel,
+                              uint32_t baseArrayLayer, uint32_t layerCount) {
+    bool readAfterRead = oldAccess.layout == newAccess.layout &&
+                         !(oldAccess.accessMask & writeAccessMask) &&
+                         !(newAccess.accessMask & writeAccessMask);
+
+    if (readAfterRead) {
+        // Nothing to wait for, but later writes have to wait on both sets of readers.
+        ImageAccess mergedAccess = newAccess;
+        mergedAccess.stageMask |= oldAccess.stageMask;
+        mergedAccess.accessMask |= oldAccess.accessMask;
+        image.setSubresourceAccess(mergedAccess, mipLevel, 1, baseArrayLayer, layerCount);
+        return;
+    }
+
+    image.setSubresourceAccess(newAccess, mipLevel, 1, baseArrayLayer, layerCount);
+
+    // Merge with the previous barrier when this one continues it onto the next mip level.
+    if (!imageBarriers.empty()) {
+        VkImageMemoryBarrier& last = imageBarriers.back();
+        VkImageSubresourceRange& range = last.subresourceRange;
+
+        if (last.image == image.getImage() && last.oldLayout == oldAccess.layout &&
+            last.newLayout == newAccess.layout &&
+            last.srcAccessMask == (oldAccess.accessMask & writeAccessMask) &&
+            last.dstAccessMask == newAccess.accessMask &&
+            range.baseMipLevel + range.levelCount == mipLevel &&
+            range.baseArrayLayer == baseArrayLayer && range.layerCount == layerCount) {
+            range.levelCount++;
+            srcStageMask |= oldAccess.stageMask;
+            dstStageMask |= newAccess.stageMask;
+            return;
+        }
+    }
+
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = oldAccess.layout;
+    barrier.newLayout = newAccess.layout;
+    barrier.srcAccessMask = oldAccess.accessMask & writeAccessMask;
+    barrier.dstAccessMask = newAccess.accessMask;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image.getImage();
+    barrier.subresourceRange.aspectMask = image.getAspectMask();
+    barrier.subresourceRange.baseMipLevel = mipLevel;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.baseArrayLayer = baseArrayLayer;
+    barrier.subresourceRange.layerCount = layerCount;
+    imageBarriers.push_back(barrier);
+
+    srcStageMask |= oldAccess.stageMask;
+    dstStageMask |= newAccess.stageMask;
+}
+
+void BarrierBatch::bufferBarrier(VkBuffer buffer, VkPipelineStageFlags srcStageMask,
+                                 VkAccessFlags srcAccessMask, VkPipelineStageFlags dstStageMask,
+                                 VkAccessFlags dstAccessMask, VkDeviceSize offset,
+                                 VkDeviceSize size) {
+    VkBufferMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.srcAccessMask = srcAccessMask;
+    barrier.dstAccessMask = dstAccessMask;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.buffer = buffer;
+    barrier.offset = offset;
+    barrier.size = size;
+    bufferBarriers.push_back(barrier);
+
+    this->srcStageMask |= srcStageMask;
+    this->dstStageMask |= dstStageMask;
+}
+
+void BarrierBatch::flush(VkCommandBuffer commandBuffer) {
+    if (empty()) {
+        return;
+    }
+
+    vkCmdPipelineBarrier(commandBuffer, srcStageMask, dstStageMask, 0, 0, nullptr,
+                         static_cast<uint32_t>(bufferBarriers.size()), bufferBarriers.data(),
+                         static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data());
+
+    imageBarriers.clear();
+    bufferBarriers.clear();
+    srcStageMask = 0;
+    dstStageMask = 0;
+}
+
+bool BarrierBatch::empty() { return imageBarriers.empty() && bufferBarriers.empty(); }
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+
+#include "image.hpp"
+
+ImageAccess getLayoutAccess(VkImageLayout layout);
+
+/*
+ * Collects image transitions and buffer barriers and emits them as a single vkCmdPipelineBarrier
+ * into an existing command buffer. The source stage, access and layout of each subresource come
+ * from the state tracked by the Image, so callers only describe where the image is going.
+ */
+class BarrierBatch {
+  public:
+    void transition(Image& image, VkImageLayout newLayout, uint32_t baseMipLevel = 0,
+                    uint32_t levelCount = VK_REMAINING_MIP_LEVELS, uint32_t baseArrayLayer = 0,
+                    uint32_t layerCount = VK_REMAINING_ARRAY_LAYERS);
+    void transition(Image& image, const ImageAccess& newAccess, uint32_t baseMipLevel = 0,
+                    uint32_t levelCount = VK_REMAINING_MIP_LEVELS, uint32_t baseArrayLayer = 0,
+                    uint32_t layerCount = VK_REMAINING_ARRAY_LAYERS);
+    // Buffers aren't tracked, so both sides of the dependency are given explicitly.
+    void bufferBarrier(VkBuffer buffer, VkPipelineStageFlags srcStageMask,
+                       VkAccessFlags srcAccessMask, VkPipelineStageFlags dstStageMask,
+                       VkAccessFlags dstAccessMask, VkDeviceSize offset = 0,
+                       VkDeviceSize size = VK_WHOLE_SIZE);
+    void flush(VkCommandBuffer commandBuffer);
+    bool empty();
+
+  private:
+    void addBarrier(Image& image, const ImageAccess& oldAccess, const ImageAccess& newAccess,
+                    uint32_t mipLevel, uint32_t baseArrayLayer, uint32_t layerCount);
+
+    std::vector<VkImageMemoryBarrier> imageBarriers;
+    std::vector<VkBufferMemoryBarrier> bufferBarriers;
+    VkPipelineStageFlags srcStageMask = 0;
+    VkPipelineStageFlags dstStageMask = 0;
+};
@@ -0,0 +1,148 @@
+#include "bindlessTable.hpp"
+
+#include <algorithm>
+#include <array>
+
+void BindlessTextureTable::create(VkPhysicalDevice physicalDevice, VkDevice device,
+                                  const DeviceExtensions& extensions, uint32_t maxImages,
+                                  uint32_t maxSamplers) {
+    if (!extensions.descriptorIndexing) {
+        throw std::runtime_error("Bindless textures require descriptor indexing support!");
+    }
+
+    VkPhysicalDeviceVulkan12Properties vulkan12Properties{};
+    vulkan12Properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES;
+
+    VkPhysicalDeviceProperties2 properties{};
+    properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    properties.pNext = &vulkan12Properties;
+    vkGetPhysicalDeviceProperties2(physicalDevice, &properties);
+
+    images.capacity =
+        std::min(maxImages, vulkan12Properties.maxPerStageDescriptorUpdateAfterBindSampledImages);
+    samplers.capacity =
+        std::min(maxSamplers, vulkan12Properties.maxPerStageDescriptorUpdateAfterBindSamplers);
+
+    std::array<VkDescriptorSetLayoutBinding, 2> bindings{};
+    bindings[0].binding = 0;
+    bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+    bindings[0].descriptorCount = images.capacity;
+    bindings[0].stageFlags = VK_SHADER_STAGE_ALL;
+    bindings[1].binding = 1;
+    bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
+    bindings[1].descriptorCount = samplers.capacity;
+    bindings[1].stageFlags = VK_SHADER_STAGE_ALL;
+
+    // Unused entries may stay empty and entries can be written while the set is bound.
+    std::array<VkDescriptorBindingFlags, 2> bindingFlags{};
+    bindingFlags[0] =
+        VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT;
+    bindingFlags[1] = bindingFlags[0];
+
+    VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo{};
+    bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+    bindingFlagsInfo.bindingCount = static_cast<uint32_t>(bindingFlags.size());
+    bindingFlagsInfo.pBindingFlags = bindingFlags.data();
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.pNext = &bindingFlagsInfo;
+    layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &descriptorSetLayout) !=
+        VK_SUCCESS) {
+        throw std::runtime_error("Failed to create bindless descriptor set layout!");
+    }
+
+    std::array<VkDescriptorPoolSize, 2> poolSizes{};
+    poolSizes[0].type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+    poolSizes[0].descriptorCount = images.capacity;
+    poolSizes[1].type = VK_DESCRIPTOR_TYPE_SAMPLER;
+    poolSizes[1].descriptorCount = samplers.capacity;
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolInfo.pPoolSizes = poolSizes.data();
+    poolInfo.maxSets = 1;
+
+    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create bindless descriptor pool!");
+    }
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = descriptorPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &descriptorSetLayout;
+
+    if (vkAllocateDescriptorSets(device, &allocInfo, &descriptorSet) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate bindless descriptor set!");
+    }
+}
+
+uint32_t BindlessTextureTable::addImage(VkDevice device, VkImageView imageView) {
+    bool created;
+    uint32_t index = images.acquire(imageView, created);
+
+    if (created) {
+        VkDescriptorImageInfo imageInfo{};
+        imageInfo.imageView = imageView;
+        imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        write(device, 0, index, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, imageInfo);
+    }
+
+    return index;
+}
+
+uint32_t BindlessTextureTable::addSampler(VkDevice device, VkSampler sampler) {
+    bool created;
+    uint32_t index = samplers.acquire(sampler, created);
+
+    if (created) {
+        VkDescriptorImageInfo imageInfo{};
+        imageInfo.sampler = sampler;
+        write(device, 1, index, VK_DESCRIPTOR_TYPE_SAMPLER, imageInfo);
+    }
+
+    return index;
+}
+
+void BindlessTextureTable::releaseImage(VkImageView imageView) { images.release(imageView); }
+
+void BindlessTextureTable::releaseSampler(VkSampler sampler) { samplers.release(sampler); }
+
+void BindlessTextureTable::write(VkDevice device, uint32_t binding, uint32_t index,
+                                 VkDescriptorType type, const VkDescriptorImageInfo& imageInfo) {
+    VkWriteDescriptorSet descriptorWrite{};
+    descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrite.dstSet = descriptorSet;
+    descriptorWrite.dstBinding = binding;
+    descriptorWrite.dstArrayElement = index;
+    descriptorWrite.descriptorType = type;
+    descriptorWrite.descriptorCount = 1;
+    descriptorWrite.pImageInfo = &imageInfo;
+
+    vkUpdateDescriptorSets(device, 1, &descriptorWrite, 0, nullptr);
+}
+
+void BindlessTextureTable::bind(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout,
+                                uint32_t set, VkPipelineBindPoint bindPoint) {
+    vkCmdBindDescriptorSets(commandBuffer, bindPoint, pipelineLayout, set, 1, &descriptorSet, 0,
+                            nullptr);
+}
+
+void BindlessTextureTable::destroy(VkDevice device) {
+    vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+    vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
+
+    images = Slots<VkImageView>();
+    samplers = Slots<VkSampler>();
+}
+
+VkDescriptorSetLayout BindlessTextureTable::getLayout() { return descriptorSetLayout; }
+
+VkDescriptorSet BindlessTextureTable::getSet() { return descriptorSet; }
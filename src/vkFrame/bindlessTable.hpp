@@ -0,0 +1,98 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cinttypes>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include "deviceExtensions.hpp"
+
+/*
+ * A single descriptor set holding every texture and sampler in use, indexed from shaders:
+ *
+ *     layout(set = N, binding = 0) uniform texture2D textures[];
+ *     layout(set = N, binding = 1) uniform sampler samplers[];
+ *
+ * Views and samplers get stable indices for as long as they are registered, so draws can pick
+ * their textures from instance or material data without rebinding descriptor sets. Indices are
+ * recycled on release, so a view must only be released once no frame in flight still uses it.
+ * Images register their texture view with Image::registerBindless.
+ */
+class BindlessTextureTable {
+  public:
+    void create(VkPhysicalDevice physicalDevice, VkDevice device,
+                const DeviceExtensions& extensions, uint32_t maxImages = 4096,
+                uint32_t maxSamplers = 64);
+    uint32_t addImage(VkDevice device, VkImageView imageView);
+    uint32_t addSampler(VkDevice device, VkSampler sampler);
+    void releaseImage(VkImageView imageView);
+    void releaseSampler(VkSampler sampler);
+    void bind(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout, uint32_t set,
+              VkPipelineBindPoint bindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS);
+    void destroy(VkDevice device);
+
+    VkDescriptorSetLayout getLayout();
+    VkDescriptorSet getSet();
+
+  private:
+    template <typename T> struct Slots {
+        struct Entry {
+            uint32_t index;
+            uint32_t refCount;
+        };
+
+        std::unordered_map<T, Entry> entries;
+        std::vector<uint32_t> freeIndices;
+        uint32_t nextIndex = 0;
+        uint32_t capacity = 0;
+
+        uint32_t acquire(T handle, bool& created) {
+            auto it = entries.find(handle);
+
+            if (it != entries.end()) {
+                it->second.refCount++;
+                created = false;
+                return it->second.index;
+            }
+
+            uint32_t index;
+
+            if (!freeIndices.empty()) {
+                index = freeIndices.back();
+                freeIndices.pop_back();
+            } else if (nextIndex < capacity) {
+                index = nextIndex++;
+            } else {
+                throw std::runtime_error("Bindless texture table is full!");
+            }
+
+            entries[handle] = Entry{index, 1};
+            created = true;
+            return index;
+        }
+
+        void release(T handle) {
+            auto it = entries.find(handle);
+
+            if (it == entries.end()) {
+                throw std::invalid_argument("Handle isn't registered in the bindless table!");
+            }
+
+            if (--it->second.refCount == 0) {
+                freeIndices.push_back(it->second.index);
+                entries.erase(it);
+            }
+        }
+    };
+
+    void write(VkDevice device, uint32_t binding, uint32_t index, VkDescriptorType type,
+               const VkDescriptorImageInfo& imageInfo);
+
+    VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
+    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+    VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+    Slots<VkImageView> images;
+    Slots<VkSampler> samplers;
+};
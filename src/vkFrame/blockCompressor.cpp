@@ -0,0 +1,353 @@
+#include "blockCompressor.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+static uint16_t packRgb565(const float color[3]) {
+    uint32_t r = static_cast<uint32_t>(std::clamp(color[0], 0.0f, 255.0f) * 31.0f / 255.0f + 0.5f);
+    uint32_t g = static_cast<uint32_t>(std::clamp(color[1], 0.0f, 255.0f) * 63.0f / 255.0f + 0.5f);
+    uint32_t b = static_cast<uint32_t>(std::clamp(color[2], 0.0f, 255.0f) * 31.0f / 255.0f + 0.5f);
+
+    return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+static void unpackRgb565(uint16_t packed, int32_t color[3]) {
+    int32_t r = (packed >> 11) & 31;
+    int32_t g = (packed >> 5) & 63;
+    int32_t b = packed & 31;
+
+    color[0] = (r << 3) | (r >> 2);
+    color[1] = (g << 2) | (g >> 4);
+    color[2] = (b << 3) | (b >> 2);
+}
+
+// Picks the closest of the four palette colours for every pixel and returns the total error.
+static uint32_t selectColorIndices(const uint8_t* block, uint16_t color0, uint16_t color1,
+                                   uint32_t& indices) {
+    int32_t palette[4][3];
+    unpackRgb565(color0, palette[0]);
+    unpackRgb565(color1, palette[1]);
+
+    for (uint32_t c = 0; c < 3; c++) {
+        palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+        palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+    }
+
+    uint32_t totalError = 0;
+    indices = 0;
+
+    for (uint32_t i = 0; i < 16; i++) {
+        uint32_t bestIndex = 0;
+        uint32_t bestError = UINT32_MAX;
+
+        for (uint32_t p = 0; p < 4; p++) {
+            int32_t dr = block[i * 4] - palette[p][0];
+            int32_t dg = block[i * 4 + 1] - palette[p][1];
+            int32_t db = block[i * 4 + 2] - palette[p][2];
+            uint32_t error = static_cast<uint32_t>(dr * dr + dg * dg + db * db);
+
+            if (error < bestError) {
+                bestError = error;
+                bestIndex = p;
+            }
+        }
+
+        indices |= bestIndex << (i * 2);
+        totalError += bestError;
+    }
+
+    return totalError;
+}
+
+static void findPrincipalEndpoints(const uint8_t* block, float minColor[3], float maxColor[3]) {
+    float mean[3] = {0.0f, 0.0f, 0.0f};
+    for (uint32_t i = 0; i < 16; i++) {
+        for (uint32_t c = 0; c < 3; c++) {
+            mean[c] += block[i * 4 + c] / 16.0f;
+        }
+    }
+
+    float covariance[6] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+    for (uint32_t i = 0; i < 16; i++) {
+        float r = block[i * 4] - mean[0];
+        float g = block[i * 4 + 1] - mean[1];
+        float b = block[i * 4 + 2] - mean[2];
+
+        covariance[0] += r * r;
+        covariance[1] += r * g;
+        covariance[2] += r * b;
+        covariance[3] += g * g;
+        covariance[4] += g * b;
+        covariance[5] += b * b;
+    }
+
+    // A few rounds of power iteration are enough to find the dominant axis of a 4x4 block.
+    float axis[3] = {1.0f, 1.0f, 1.0f};
+    for (uint32_t iteration = 0; iteration < 4; iteration++) {
+        float x = covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2];
+        float y = covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2];
+        float z = covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2];
+        float length = std::max(std::max(std::abs(x), std::abs(y)), std::abs(z));
+
+        if (length < 1e-6f) {
+            break;
+        }
+
+        axis[0] = x / length;
+        axis[1] = y / length;
+        axis[2] = z / length;
+    }
+
+    float axisLengthSquared = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+    float minProjection = 0.0f;
+    float maxProjection = 0.0f;
+
+    for (uint32_t i = 0; i < 16; i++) {
+        float projection = ((block[i * 4] - mean[0]) * axis[0] +
+                            (block[i * 4 + 1] - mean[1]) * axis[1] +
+                            (block[i * 4 + 2] - mean[2]) * axis[2]) /
+                           axisLengthSquared;
+        minProjection = std::min(minProjection, projection);
+        maxProjection = std::max(maxProjection, projection);
+    }
+
+    for (uint32_t c = 0; c < 3; c++) {
+        minColor[c] = mean[c] + axis[c] * minProjection;
+        maxColor[c] = mean[c] + axis[c] * maxProjection;
+    }
+}
+
+// Solves for the endpoints that best reproduce the block with the given palette indices.
+static bool refineEndpoints(const uint8_t* block, uint32_t indices, float minColor[3],
+                            float maxColor[3]) {
+    static const float weights[4] = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+
+    float aa = 0.0f;
+    float ab = 0.0f;
+    float bb = 0.0f;
+    float ax[3] = {0.0f, 0.0f, 0.0f};
+    float bx[3] = {0.0f, 0.0f, 0.0f};
+
+    for (uint32_t i = 0; i < 16; i++) {
+        float a = weights[(indices >> (i * 2)) & 3];
+        float b = 1.0f - a;
+
+        aa += a * a;
+        ab += a * b;
+        bb += b * b;
+
+        for (uint32_t c = 0; c < 3; c++) {
+            ax[c] += a * block[i * 4 + c];
+            bx[c] += b * block[i * 4 + c];
+        }
+    }
+
+    float determinant = aa * bb - ab * ab;
+
+    if (std::abs(determinant) < 1e-6f) {
+        return false;
+    }
+
+    for (uint32_t c = 0; c < 3; c++) {
+        maxColor[c] = (ax[c] * bb - bx[c] * ab) / determinant;
+        minColor[c] = (bx[c] * aa - ax[c] * ab) / determinant;
+    }
+
+    return true;
+}
+
+void BlockCompressor::compress(const uint8_t* pixels, uint32_t width, uint32_t height,
+                               BlockFormat format, CompressionQuality quality, uint8_t* dst,
+                               uint32_t threadCount) {
+    uint32_t blockRows = (height + 3) / 4;
+    uint32_t blockCount = blockRows * ((width + 3) / 4);
+
+    if (threadCount == 0) {
+        threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    // Small levels aren't worth the cost of starting threads for.
+    if (blockCount < 1024) {
+        threadCount = 1;
+    }
+
+    threadCount = std::min(threadCount, blockRows);
+
+    if (threadCount <= 1) {
+        compressRows(pixels, width, height, format, quality, dst, 0, blockRows);
+        return;
+    }
+
+    std::vector<std::thread> threads;
+    uint32_t rowsPerThread = (blockRows + threadCount - 1) / threadCount;
+
+    for (uint32_t firstRow = 0; firstRow < blockRows; firstRow += rowsPerThread) {
+        uint32_t endRow = std::min(firstRow + rowsPerThread, blockRows);
+        threads.emplace_back(compressRows, pixels, width, height, format, quality, dst, firstRow,
+                             endRow);
+    }
+
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+void BlockCompressor::compressRows(const uint8_t* pixels, uint32_t width, uint32_t height,
+                                   BlockFormat format, CompressionQuality quality, uint8_t* dst,
+                                   uint32_t firstRow, uint32_t endRow) {
+    uint32_t blocksPerRow = (width + 3) / 4;
+    uint32_t blockByteSize = getBlockByteSize(format);
+    uint8_t block[64];
+
+    for (uint32_t blockY = firstRow; blockY < endRow; blockY++) {
+        for (uint32_t blockX = 0; blockX < blocksPerRow; blockX++) {
+            for (uint32_t y = 0; y < 4; y++) {
+                uint32_t srcY = std::min(blockY * 4 + y, height - 1);
+
+                for (uint32_t x = 0; x < 4; x++) {
+                    uint32_t srcX = std::min(blockX * 4 + x, width - 1);
+                    const uint8_t* src = pixels + (static_cast<size_t>(srcY) * width + srcX) * 4;
+                    std::copy(src, src + 4, block + (y * 4 + x) * 4);
+                }
+            }
+
+            uint8_t* blockDst =
+                dst + (static_cast<size_t>(blockY) * blocksPerRow + blockX) * blockByteSize;
+
+            if (format == BlockFormat::BC3) {
+                encodeAlphaBlock(block, blockDst);
+                blockDst += 8;
+            }
+
+            encodeColorBlock(block, quality, blockDst);
+        }
+    }
+}
+
+void BlockCompressor::encodeColorBlock(const uint8_t* block, CompressionQuality quality,
+                                       uint8_t* dst) {
+    float minColor[3];
+    float maxColor[3];
+
+    if (quality == CompressionQuality::High) {
+        findPrincipalEndpoints(block, minColor, maxColor);
+    } else {
+        for (uint32_t c = 0; c < 3; c++) {
+            minColor[c] = 255.0f;
+            maxColor[c] = 0.0f;
+        }
+
+        for (uint32_t i = 0; i < 16; i++) {
+            for (uint32_t c = 0; c < 3; c++) {
+                minColor[c] = std::min(minColor[c], static_cast<float>(block[i * 4 + c]));
+                maxColor[c] = std::max(maxColor[c], static_cast<float>(block[i * 4 + c]));
+            }
+        }
+
+        // Pulling the endpoints slightly inwards lowers the error for most blocks.
+        for (uint32_t c = 0; c < 3; c++) {
+            float inset = (maxColor[c] - minColor[c]) / 16.0f;
+            minColor[c] += inset;
+            maxColor[c] -= inset;
+        }
+    }
+
+    uint16_t color0 = packRgb565(maxColor);
+    uint16_t color1 = packRgb565(minColor);
+    uint32_t indices;
+    uint32_t error = selectColorIndices(block, color0, color1, indices);
+
+    if (quality == CompressionQuality::High &&
+        refineEndpoints(block, indices, minColor, maxColor)) {
+        uint16_t refinedColor0 = packRgb565(maxColor);
+        uint16_t refinedColor1 = packRgb565(minColor);
+        uint32_t refinedIndices;
+
+        if (selectColorIndices(block, refinedColor0, refinedColor1, refinedIndices) < error) {
+            color0 = refinedColor0;
+            color1 = refinedColor1;
+            indices = refinedIndices;
+        }
+    }
+
+    // The four colour mode is only used when the first endpoint is the larger one, so swap
+    // the endpoints and remap 0 <-> 1 and 2 <-> 3 when needed.
+    if (color0 < color1) {
+        std::swap(color0, color1);
+        indices ^= 0x55555555;
+    } else if (color0 == color1) {
+        indices = 0;
+    }
+
+    dst[0] = color0 & 0xff;
+    dst[1] = color0 >> 8;
+    dst[2] = color1 & 0xff;
+    dst[3] = color1 >> 8;
+    dst[4] = indices & 0xff;
+    dst[5] = (indices >> 8) & 0xff;
+    dst[6] = (indices >> 16) & 0xff;
+    dst[7] = indices >> 24;
+}
+
+void BlockCompressor::encodeAlphaBlock(const uint8_t* block, uint8_t* dst) {
+    int32_t alpha0 = 0;
+    int32_t alpha1 = 255;
+
+    for (uint32_t i = 0; i < 16; i++) {
+        alpha0 = std::max(alpha0, static_cast<int32_t>(block[i * 4 + 3]));
+        alpha1 = std::min(alpha1, static_cast<int32_t>(block[i * 4 + 3]));
+    }
+
+    dst[0] = static_cast<uint8_t>(alpha0);
+    dst[1] = static_cast<uint8_t>(alpha1);
+
+    uint64_t indices = 0;
+
+    if (alpha0 != alpha1) {
+        int32_t palette[8] = {alpha0, alpha1};
+        for (int32_t i = 2; i < 8; i++) {
+            palette[i] = ((8 - i) * alpha0 + (i - 1) * alpha1) / 7;
+        }
+
+        for (uint32_t i = 0; i < 16; i++) {
+            int32_t alpha = block[i * 4 + 3];
+            uint64_t bestIndex = 0;
+            int32_t bestError = INT32_MAX;
+
+            for (uint32_t p = 0; p < 8; p++) {
+                int32_t error = std::abs(alpha - palette[p]);
+
+                if (error < bestError) {
+                    bestError = error;
+                    bestIndex = p;
+                }
+            }
+
+            indices |= bestIndex << (i * 3);
+        }
+    }
+
+    for (uint32_t i = 0; i < 6; i++) {
+        dst[2 + i] = static_cast<uint8_t>(indices >> (i * 8));
+    }
+}
+
+VkDeviceSize BlockCompressor::getCompressedSize(uint32_t width, uint32_t height,
+                                                BlockFormat format) {
+    return static_cast<VkDeviceSize>((width + 3) / 4) * ((height + 3) / 4) *
+           getBlockByteSize(format);
+}
+
+uint32_t BlockCompressor::getBlockByteSize(BlockFormat format) {
+    return format == BlockFormat::BC1 ? 8 : 16;
+}
+
+VkFormat BlockCompressor::getFormat(BlockFormat format, bool srgb) {
+    if (format == BlockFormat::BC1) {
+        return srgb ? VK_FORMAT_BC1_RGB_SRGB_BLOCK : VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+    }
+
+    return srgb ? VK_FORMAT_BC3_SRGB_BLOCK : VK_FORMAT_BC3_UNORM_BLOCK;
+}
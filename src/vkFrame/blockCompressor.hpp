@@ -0,0 +1,38 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cinttypes>
+
+enum class BlockFormat {
+    BC1,
+    BC3,
+};
+
+enum class CompressionQuality {
+    // Endpoints from the colour bounding box.
+    Fast,
+    // Endpoints along the principal axis of the block, refined by least squares.
+    High,
+};
+
+/*
+ * Encodes RGBA8 pixels into BC1 or BC3 blocks on the CPU, splitting the rows of blocks across
+ * worker threads. Images whose size isn't a multiple of 4 are padded by repeating edge pixels.
+ */
+class BlockCompressor {
+  public:
+    static void compress(const uint8_t* pixels, uint32_t width, uint32_t height,
+                         BlockFormat format, CompressionQuality quality, uint8_t* dst,
+                         uint32_t threadCount = 0);
+    static VkDeviceSize getCompressedSize(uint32_t width, uint32_t height, BlockFormat format);
+    static uint32_t getBlockByteSize(BlockFormat format);
+    static VkFormat getFormat(BlockFormat format, bool srgb);
+
+  private:
+    static void compressRows(const uint8_t* pixels, uint32_t width, uint32_t height,
+                             BlockFormat format, CompressionQuality quality, uint8_t* dst,
+                             uint32_t firstRow, uint32_t endRow);
+    static void encodeColorBlock(const uint8_t* block, CompressionQuality quality, uint8_t* dst);
+    static void encodeAlphaBlock(const uint8_t* block, uint8_t* dst);
+};
@@ -3,7 +3,7 @@
 Buffer::Buffer() {}
 
 Buffer::Buffer(VmaAllocator allocator, VkDeviceSize byteSize, VkBufferUsageFlags usage,
-               bool cpuAccessible) : byteSize(byteSize) {
+               bool cpuAccessible, bool hostReadback) : byteSize(byteSize) {
     VkBufferCreateInfo bufferInfo{};
     bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
     bufferInfo.size = byteSize;
@@ -12,7 +12,10 @@ Buffer::Buffer(VmaAllocator allocator, VkDeviceSize byteSize, VkBufferUsageFlags
 
     VmaAllocationCreateInfo allocCreateInfo = {};
     allocCreateInfo.usage = VMA_MEMORY_USAGE_AUTO;
-    if (cpuAccessible) {
+    if (hostReadback) {
+        allocCreateInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT |
+                                VMA_ALLOCATION_CREATE_MAPPED_BIT;
+    } else if (cpuAccessible) {
         allocCreateInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT |
                                 VMA_ALLOCATION_CREATE_MAPPED_BIT;
     }
@@ -21,6 +24,16 @@ Buffer::Buffer(VmaAllocator allocator, VkDeviceSize byteSize, VkBufferUsageFlags
                         &allocInfo) != VK_SUCCESS) {
         throw std::runtime_error("Failed to create buffer!");
     }
+
+    if (byteSize != 0 && (usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT) != 0) {
+        VmaAllocatorInfo allocatorInfo{};
+        vmaGetAllocatorInfo(allocator, &allocatorInfo);
+
+        VkBufferDeviceAddressInfo addressInfo{};
+        addressInfo.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO;
+        addressInfo.buffer = buffer;
+        deviceAddress = vkGetBufferDeviceAddress(allocatorInfo.device, &addressInfo);
+    }
 }
 
 void Buffer::copyTo(VmaAllocator& allocator, VkQueue graphicsQueue, VkDevice device,
@@ -40,6 +53,16 @@ const VkBuffer& Buffer::getBuffer() { return buffer; }
 
 size_t Buffer::getSize() { return byteSize; }
 
+VkDeviceAddress Buffer::getDeviceAddress() {
+    if (deviceAddress == 0) {
+        throw std::runtime_error("Buffer wasn't created with a device address!");
+    }
+
+    return deviceAddress;
+}
+
+void* Buffer::getMappedData() { return allocInfo.pMappedData; }
+
 void Buffer::map(VmaAllocator allocator, void** data) {
     if (byteSize == 0) return;
 
@@ -52,6 +75,16 @@ void Buffer::unmap(VmaAllocator allocator) {
     vmaUnmapMemory(allocator, allocation);
 }
 
+void Buffer::invalidate(VmaAllocator allocator) {
+    if (byteSize == 0) return;
+
+    vmaInvalidateAllocation(allocator, allocation, 0, VK_WHOLE_SIZE);
+}
+
+VkDeviceSize Buffer::alignSize(VkDeviceSize size, VkDeviceSize alignment) {
+    return (size + alignment - 1) / alignment * alignment;
+}
+
 void Buffer::destroy(VmaAllocator& allocator) {
     if (byteSize == 0) return;
 
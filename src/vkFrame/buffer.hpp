@@ -13,7 +13,8 @@ class Buffer {
   public:
     template <typename T>
     static Buffer fromIndices(VmaAllocator allocator, Commands& commands, VkQueue graphicsQueue,
-                              VkDevice device, const std::vector<T>& indices) {
+                              VkDevice device, const std::vector<T>& indices,
+                              VkBufferUsageFlags extraUsage = 0) {
         size_t indexSize = sizeof(indices[0]);
 
         // Only accept 16 or 32 bit types.
@@ -27,7 +28,9 @@ class Buffer {
         stagingBuffer.setData(indices.data());
 
         Buffer indexBuffer(allocator, bufferByteSize,
-                          VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, false);
+                          VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT |
+                              extraUsage,
+                          false);
 
         stagingBuffer.copyTo(allocator, graphicsQueue, device, commands, indexBuffer);
         stagingBuffer.destroy(allocator);
@@ -37,14 +40,16 @@ class Buffer {
 
     template <typename T>
     static Buffer fromVertices(VmaAllocator allocator, Commands& commands, VkQueue graphicsQueue,
-                               VkDevice device, const std::vector<T>& vertices) {
+                               VkDevice device, const std::vector<T>& vertices,
+                               VkBufferUsageFlags extraUsage = 0) {
         VkDeviceSize bufferByteSize = sizeof(vertices[0]) * vertices.size();
 
         Buffer stagingBuffer(allocator, bufferByteSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, true);
         stagingBuffer.setData(vertices.data());
 
         Buffer vertexBuffer(allocator, bufferByteSize,
-                            VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                            VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
+                                extraUsage,
                             false);
 
         stagingBuffer.copyTo(allocator, graphicsQueue, device, commands, vertexBuffer);
@@ -54,20 +59,30 @@ class Buffer {
     }
 
     Buffer();
+    // Buffers the host reads back from get memory cached for random access, which has to be
+    // invalidated before the GPU's writes can be read.
     Buffer(VmaAllocator allocator, VkDeviceSize byteSize, VkBufferUsageFlags usage,
-           bool cpuAccessible);
+           bool cpuAccessible, bool hostReadback = false);
     void destroy(VmaAllocator& allocator);
     void setData(const void* data);
     void copyTo(VmaAllocator& allocator, VkQueue graphicsQueue, VkDevice device, Commands& commands,
                 Buffer& dst);
     const VkBuffer& getBuffer();
     size_t getSize();
+    VkDeviceAddress getDeviceAddress();
+    void* getMappedData();
     void map(VmaAllocator allocator, void** data);
     void unmap(VmaAllocator allocator);
+    void invalidate(VmaAllocator allocator);
+
+    // Rounds size up to a multiple of alignment, such as a device's minimum offset alignment.
+    static VkDeviceSize alignSize(VkDeviceSize size, VkDeviceSize alignment);
 
   private:
     VkBuffer buffer;
     VmaAllocation allocation;
     VmaAllocationInfo allocInfo;
     size_t byteSize = 0;
+    // Only set for buffers created with VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT.
+    VkDeviceAddress deviceAddress = 0;
 };
@@ -0,0 +1,163 @@
+#include "computePipeline.hpp"
+
+#include "pipeline.hpp"
+
+void ComputePipeline::create(const std::string& computeShader, VkDevice device,
+                             uint32_t localSizeX, uint32_t localSizeY, uint32_t localSizeZ) {
+    this->computeShader = computeShader;
+    localSize[0] = localSizeX;
+    localSize[1] = localSizeY;
+    localSize[2] = localSizeZ;
+
+    std::vector<VkDescriptorSetLayout> setLayouts;
+
+    if (descriptors.getLayout() != VK_NULL_HANDLE) {
+        setLayouts.push_back(descriptors.getLayout());
+    }
+
+    setLayouts.insert(setLayouts.end(), extraSetLayouts.begin(), extraSetLayouts.end());
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
+    pipelineLayoutInfo.pSetLayouts = setLayouts.data();
+    pipelineLayoutInfo.pushConstantRangeCount = static_cast<uint32_t>(pushConstantRanges.size());
+    pipelineLayoutInfo.pPushConstantRanges = pushConstantRanges.data();
+
+    if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) !=
+        VK_SUCCESS) {
+        throw std::runtime_error("Failed to create compute pipeline layout!");
+    }
+
+    VkShaderModule shaderModule =
+        Pipeline::createShaderModule(Pipeline::readFile(computeShader), device);
+
+    VkComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module = shaderModule;
+    pipelineInfo.stage.pName = "main";
+    pipelineInfo.stage.pSpecializationInfo = specialization.getInfo();
+    pipelineInfo.layout = pipelineLayout;
+
+    VkResult result = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr,
+                                               &computePipeline);
+    vkDestroyShaderModule(device, shaderModule, nullptr);
+
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create compute pipeline!");
+    }
+}
+
+void ComputePipeline::recreate(VkDevice device, const uint32_t maxFramesInFlight) {
+    cleanup(device);
+
+    if (descriptors.isCreated()) {
+        descriptors.recreate(device, maxFramesInFlight);
+    }
+
+    create(computeShader, device, localSize[0], localSize[1], localSize[2]);
+}
+
+void ComputePipeline::createDescriptorSetLayout(
+    VkDevice device,
+    std::function<void(std::vector<VkDescriptorSetLayoutBinding>&)> setupBindings,
+    DescriptorLayoutCache* layoutCache) {
+    descriptors.createLayout(device, setupBindings, layoutCache);
+}
+
+void ComputePipeline::createDescriptorPool(
+    const uint32_t maxFramesInFlight, VkDevice device,
+    std::function<void(std::vector<VkDescriptorPoolSize>& poolSizes)> setupPool) {
+    descriptors.createPool(maxFramesInFlight, device, setupPool);
+}
+
+void ComputePipeline::createDescriptorSets(
+    const uint32_t maxFramesInFlight, VkDevice device,
+    std::function<void(std::vector<VkWriteDescriptorSet>&, VkDescriptorSet, uint32_t)>
+        setupDescriptor) {
+    descriptors.createSets(maxFramesInFlight, device, setupDescriptor);
+}
+
+void ComputePipeline::createDescriptorSets(
+    const uint32_t maxFramesInFlight, VkDevice device, DescriptorAllocator& allocator,
+    std::function<void(std::vector<VkWriteDescriptorSet>&, VkDescriptorSet, uint32_t)>
+        setupDescriptor) {
+    descriptors.createSets(maxFramesInFlight, device, allocator, setupDescriptor);
+}
+
+void ComputePipeline::addSetLayout(VkDescriptorSetLayout setLayout) {
+    extraSetLayouts.push_back(setLayout);
+}
+
+void ComputePipeline::setSpecialization(const SpecializationConstants& constants) {
+    specialization = constants;
+}
+
+void ComputePipeline::bind(VkCommandBuffer commandBuffer, uint32_t currentFrame,
+                           StateTracker* stateTracker) {
+    const std::vector<VkDescriptorSet>& descriptorSets = descriptors.getSets();
+
+    if (stateTracker != nullptr) {
+        if (!descriptorSets.empty()) {
+            stateTracker->bindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+                                             pipelineLayout, 0, 1, &descriptorSets[currentFrame]);
+        }
+
+        stateTracker->bindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+                                   computePipeline);
+        return;
+    }
+
+    if (!descriptorSets.empty()) {
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0,
+                                1, &descriptorSets[currentFrame], 0, nullptr);
+    }
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, computePipeline);
+}
+
+void ComputePipeline::dispatch(VkCommandBuffer commandBuffer, uint32_t groupCountX,
+                               uint32_t groupCountY, uint32_t groupCountZ) {
+    vkCmdDispatch(commandBuffer, groupCountX, groupCountY, groupCountZ);
+}
+
+void ComputePipeline::dispatchThreads(VkCommandBuffer commandBuffer, uint32_t threadCountX,
+                                      uint32_t threadCountY, uint32_t threadCountZ) {
+    vkCmdDispatch(commandBuffer, (threadCountX + localSize[0] - 1) / localSize[0],
+                  (threadCountY + localSize[1] - 1) / localSize[1],
+                  (threadCountZ + localSize[2] - 1) / localSize[2]);
+}
+
+void ComputePipeline::dispatchIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer,
+                                       VkDeviceSize offset) {
+    vkCmdDispatchIndirect(commandBuffer, buffer, offset);
+}
+
+void ComputePipeline::cleanup(VkDevice device) {
+    vkDestroyPipeline(device, computePipeline, nullptr);
+    vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+
+    descriptors.destroy(device);
+}
+
+VkPipelineLayout ComputePipeline::getLayout() { return pipelineLayout; }
+
+VkDescriptorSetLayout ComputePipeline::getDescriptorSetLayout() {
+    return descriptors.getLayout();
+}
+
+void ComputePipeline::addWriteBarrier(BarrierBatch& barriers, VkBuffer buffer,
+                                      VkPipelineStageFlags dstStageMask,
+                                      VkAccessFlags dstAccessMask, VkDeviceSize offset,
+                                      VkDeviceSize size) {
+    barriers.bufferBarrier(buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                           VK_ACCESS_SHADER_WRITE_BIT, dstStageMask, dstAccessMask, offset, size);
+}
+
+void ComputePipeline::addWriteBarrier(BarrierBatch& barriers, Image& image,
+                                      VkImageLayout newLayout) {
+    // The image's tracked state still records the compute writes, which the batch waits on.
+    barriers.transition(image, newLayout);
+}
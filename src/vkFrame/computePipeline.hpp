@@ -0,0 +1,101 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "barriers.hpp"
+#include "descriptorAllocator.hpp"
+#include "descriptorLayoutCache.hpp"
+#include "descriptorSets.hpp"
+#include "specializationConstants.hpp"
+#include "stateTracker.hpp"
+
+/*
+ * A compute shader with its own descriptor set, set up through the same callbacks as Pipeline.
+ * Storage buffers and images are declared in the bindings like any other descriptor, and the
+ * barrier helpers make the shader's writes visible to whatever reads them next.
+ */
+class ComputePipeline {
+  public:
+    // The local size is only used to round thread counts up to whole workgroups and has to match
+    // the one declared in the shader.
+    void create(const std::string& computeShader, VkDevice device, uint32_t localSizeX = 64,
+                uint32_t localSizeY = 1, uint32_t localSizeZ = 1);
+    void recreate(VkDevice device, const uint32_t maxFramesInFlight);
+
+    void createDescriptorSetLayout(
+        VkDevice device,
+        std::function<void(std::vector<VkDescriptorSetLayoutBinding>&)> setupBindings,
+        DescriptorLayoutCache* layoutCache = nullptr);
+    void createDescriptorPool(
+        const uint32_t maxFramesInFlight, VkDevice device,
+        std::function<void(std::vector<VkDescriptorPoolSize>& poolSizes)> setupPool);
+    void createDescriptorSets(
+        const uint32_t maxFramesInFlight, VkDevice device,
+        std::function<void(std::vector<VkWriteDescriptorSet>&, VkDescriptorSet, uint32_t)>
+            setupDescriptor);
+    void createDescriptorSets(
+        const uint32_t maxFramesInFlight, VkDevice device, DescriptorAllocator& allocator,
+        std::function<void(std::vector<VkWriteDescriptorSet>&, VkDescriptorSet, uint32_t)>
+            setupDescriptor);
+    void addSetLayout(VkDescriptorSetLayout setLayout);
+    // Has to be called before the pipeline is created.
+    void setSpecialization(const SpecializationConstants& constants);
+
+    template <typename T> void addPushConstantRange(uint32_t offset = 0) {
+        static_assert(sizeof(T) % 4 == 0, "Push constant size must be a multiple of 4!");
+        static_assert(sizeof(T) <= 128, "Push constants larger than 128 bytes aren't portable!");
+
+        if (offset % 4 != 0 || offset + sizeof(T) > 128) {
+            throw std::invalid_argument("Push constant range is out of bounds!");
+        }
+
+        VkPushConstantRange pushConstantRange{};
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        pushConstantRange.offset = offset;
+        pushConstantRange.size = static_cast<uint32_t>(sizeof(T));
+        pushConstantRanges.push_back(pushConstantRange);
+    }
+
+    template <typename T>
+    void pushConstants(VkCommandBuffer commandBuffer, const T& data, uint32_t offset = 0) {
+        vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, offset,
+                           static_cast<uint32_t>(sizeof(T)), &data);
+    }
+
+    void bind(VkCommandBuffer commandBuffer, uint32_t currentFrame,
+              StateTracker* stateTracker = nullptr);
+    void dispatch(VkCommandBuffer commandBuffer, uint32_t groupCountX, uint32_t groupCountY = 1,
+                  uint32_t groupCountZ = 1);
+    void dispatchThreads(VkCommandBuffer commandBuffer, uint32_t threadCountX,
+                         uint32_t threadCountY = 1, uint32_t threadCountZ = 1);
+    void dispatchIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset = 0);
+    void cleanup(VkDevice device);
+
+    VkPipelineLayout getLayout();
+    VkDescriptorSetLayout getDescriptorSetLayout();
+
+    // Makes the shader's writes to a buffer visible to a later stage, such as indirect draw
+    // commands, vertex input or another dispatch.
+    static void addWriteBarrier(BarrierBatch& barriers, VkBuffer buffer,
+                                VkPipelineStageFlags dstStageMask, VkAccessFlags dstAccessMask,
+                                VkDeviceSize offset = 0, VkDeviceSize size = VK_WHOLE_SIZE);
+    // Moves a storage image the shader wrote in VK_IMAGE_LAYOUT_GENERAL to its next layout.
+    static void addWriteBarrier(BarrierBatch& barriers, Image& image, VkImageLayout newLayout);
+
+  private:
+    VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+    VkPipeline computePipeline = VK_NULL_HANDLE;
+
+    DescriptorSets descriptors;
+    std::vector<VkDescriptorSetLayout> extraSetLayouts;
+    std::vector<VkPushConstantRange> pushConstantRanges;
+
+    std::string computeShader;
+    SpecializationConstants specialization;
+    uint32_t localSize[3] = {64, 1, 1};
+};
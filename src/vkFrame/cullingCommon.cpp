@@ -0,0 +1,104 @@
+#include "cullingCommon.hpp"
+
+#include <cstring>
+
+void CullingBuffers::create(VkPhysicalDevice physicalDevice, VmaAllocator allocator,
+                            uint32_t maxInstances, uint32_t drawCommandCount,
+                            uint32_t maxFramesInFlight) {
+    VkPhysicalDeviceSubgroupProperties subgroupProperties{};
+    subgroupProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_PROPERTIES;
+
+    VkPhysicalDeviceProperties2 properties{};
+    properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    properties.pNext = &subgroupProperties;
+    vkGetPhysicalDeviceProperties2(physicalDevice, &properties);
+
+    VkSubgroupFeatureFlags requiredOperations =
+        VK_SUBGROUP_FEATURE_BASIC_BIT | VK_SUBGROUP_FEATURE_BALLOT_BIT;
+
+    if ((subgroupProperties.supportedStages & VK_SHADER_STAGE_COMPUTE_BIT) == 0 ||
+        (subgroupProperties.supportedOperations & requiredOperations) != requiredOperations) {
+        throw std::runtime_error("GPU culling requires subgroup ballot support!");
+    }
+
+    VkDeviceSize alignment = properties.properties.limits.minStorageBufferOffsetAlignment;
+
+    this->maxInstances = maxInstances;
+    visibleInstanceRange = Buffer::alignSize(sizeof(uint32_t) * maxInstances, alignment);
+    drawCommandRange =
+        Buffer::alignSize(sizeof(VkDrawIndexedIndirectCommand) * drawCommandCount, alignment);
+
+    boundsBuffer = Buffer(allocator, sizeof(glm::vec4) * maxInstances,
+                          VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                          false);
+    visibleInstanceBuffer =
+        Buffer(allocator, visibleInstanceRange * maxFramesInFlight,
+               VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, false);
+    drawCommandBuffer = Buffer(allocator, drawCommandRange * maxFramesInFlight,
+                               VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                                   VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                                   VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                               false);
+}
+
+void CullingBuffers::updateBounds(const std::vector<glm::vec4>& spheres, VmaAllocator allocator,
+                                  Commands& commands, VkQueue graphicsQueue, VkDevice device,
+                                  std::function<void(VkCommandBuffer)> recordUpload) {
+    if (spheres.size() > maxInstances) {
+        throw std::invalid_argument("More instances than the culler was created for!");
+    }
+
+    instanceCount = static_cast<uint32_t>(spheres.size());
+
+    if (instanceCount == 0) {
+        return;
+    }
+
+    VkDeviceSize byteSize = sizeof(glm::vec4) * spheres.size();
+    Buffer stagingBuffer(allocator, byteSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, true);
+    memcpy(stagingBuffer.getMappedData(), spheres.data(), byteSize);
+
+    VkCommandBuffer commandBuffer = commands.beginSingleTime(graphicsQueue, device);
+
+    VkBufferCopy copyRegion{};
+    copyRegion.size = byteSize;
+    vkCmdCopyBuffer(commandBuffer, stagingBuffer.getBuffer(), boundsBuffer.getBuffer(), 1,
+                    &copyRegion);
+
+    if (recordUpload) {
+        recordUpload(commandBuffer);
+    }
+
+    commands.endSingleTime(commandBuffer, graphicsQueue, device);
+    stagingBuffer.destroy(allocator);
+}
+
+void CullingBuffers::destroy(VmaAllocator allocator) {
+    boundsBuffer.destroy(allocator);
+    visibleInstanceBuffer.destroy(allocator);
+    drawCommandBuffer.destroy(allocator);
+}
+
+uint32_t CullingBuffers::getMaxInstances() { return maxInstances; }
+
+uint32_t CullingBuffers::getInstanceCount() { return instanceCount; }
+
+const VkBuffer& CullingBuffers::getBoundsBuffer() { return boundsBuffer.getBuffer(); }
+
+const VkBuffer& CullingBuffers::getVisibleInstanceBuffer() {
+    return visibleInstanceBuffer.getBuffer();
+}
+
+VkDeviceSize CullingBuffers::getVisibleInstanceOffset(uint32_t currentFrame) {
+    return visibleInstanceRange * currentFrame;
+}
+
+VkDeviceSize CullingBuffers::getVisibleInstanceRange() { return visibleInstanceRange; }
+
+const VkBuffer& CullingBuffers::getDrawCommandBuffer() { return drawCommandBuffer.getBuffer(); }
+
+VkDeviceSize CullingBuffers::getDrawCommandOffset(uint32_t currentFrame) {
+    return drawCommandRange * currentFrame;
+}
+
+VkDeviceSize CullingBuffers::getDrawCommandRange() { return drawCommandRange; }
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <vk_mem_alloc.h>
+#include <vulkan/vulkan.h>
+
+#include <glm/glm.hpp>
+
+#include <cinttypes>
+#include <functional>
+#include <stdexcept>
+#include <vector>
+
+#include "buffer.hpp"
+#include "commands.hpp"
+
+/*
+ * The buffers every GPU culler works on: the bounding spheres of the instances, and per frame
+ * in flight a list of the visible instances and the indirect draw commands the cull shader
+ * compacts them into. Per-frame regions are aligned for use as storage buffer offsets. Creating
+ * them checks for the subgroup ballots the cull shaders compact with.
+ */
+class CullingBuffers {
+  public:
+    void create(VkPhysicalDevice physicalDevice, VmaAllocator allocator, uint32_t maxInstances,
+                uint32_t drawCommandCount, uint32_t maxFramesInFlight);
+    // Bounding spheres of the instances, center in xyz and radius in w. recordUpload can record
+    // more commands into the upload's command buffer.
+    void updateBounds(const std::vector<glm::vec4>& spheres, VmaAllocator allocator,
+                      Commands& commands, VkQueue graphicsQueue, VkDevice device,
+                      std::function<void(VkCommandBuffer)> recordUpload = nullptr);
+    void destroy(VmaAllocator allocator);
+
+    uint32_t getMaxInstances();
+    uint32_t getInstanceCount();
+    const VkBuffer& getBoundsBuffer();
+    const VkBuffer& getVisibleInstanceBuffer();
+    VkDeviceSize getVisibleInstanceOffset(uint32_t currentFrame);
+    VkDeviceSize getVisibleInstanceRange();
+    const VkBuffer& getDrawCommandBuffer();
+    VkDeviceSize getDrawCommandOffset(uint32_t currentFrame);
+    VkDeviceSize getDrawCommandRange();
+
+  private:
+    Buffer boundsBuffer;
+    Buffer visibleInstanceBuffer;
+    Buffer drawCommandBuffer;
+    uint32_t maxInstances = 0;
+    uint32_t instanceCount = 0;
+    VkDeviceSize visibleInstanceRange = 0;
+    VkDeviceSize drawCommandRange = 0;
+};
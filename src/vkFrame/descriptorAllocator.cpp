@@ -0,0 +1,115 @@
+#include "descriptorAllocator.hpp"
+
+#include <algorithm>
+
+const uint32_t maxSetsPerPool = 4096;
+
+void DescriptorAllocator::create(uint32_t initialSetsPerPool,
+                                 const std::vector<DescriptorPoolRatio>& ratios) {
+    setsPerPool = std::max(initialSetsPerPool, 1u);
+
+    if (ratios.empty()) {
+        this->ratios = {{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2.0f},
+                        {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1.0f},
+                        {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2.0f},
+                        {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4.0f},
+                        {VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 1.0f},
+                        {VK_DESCRIPTOR_TYPE_SAMPLER, 1.0f},
+                        {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1.0f}};
+    } else {
+        this->ratios = ratios;
+    }
+}
+
+VkDescriptorSet DescriptorAllocator::allocate(VkDevice device, VkDescriptorSetLayout layout) {
+    if (currentPool == VK_NULL_HANDLE) {
+        currentPool = getPool(device);
+    }
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = currentPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &layout;
+
+    VkDescriptorSet descriptorSet;
+    VkResult result = vkAllocateDescriptorSets(device, &allocInfo, &descriptorSet);
+
+    if (result == VK_ERROR_OUT_OF_POOL_MEMORY || result == VK_ERROR_FRAGMENTED_POOL) {
+        fullPools.push_back(currentPool);
+        currentPool = getPool(device);
+
+        allocInfo.descriptorPool = currentPool;
+        result = vkAllocateDescriptorSets(device, &allocInfo, &descriptorSet);
+    }
+
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate descriptor set!");
+    }
+
+    return descriptorSet;
+}
+
+void DescriptorAllocator::reset(VkDevice device) {
+    if (currentPool != VK_NULL_HANDLE) {
+        fullPools.push_back(currentPool);
+        currentPool = VK_NULL_HANDLE;
+    }
+
+    for (VkDescriptorPool pool : fullPools) {
+        vkResetDescriptorPool(device, pool, 0);
+        freePools.push_back(pool);
+    }
+
+    fullPools.clear();
+}
+
+void DescriptorAllocator::destroy(VkDevice device) {
+    reset(device);
+
+    for (VkDescriptorPool pool : freePools) {
+        vkDestroyDescriptorPool(device, pool, nullptr);
+    }
+
+    freePools.clear();
+}
+
+size_t DescriptorAllocator::getPoolCount() {
+    return fullPools.size() + freePools.size() + (currentPool != VK_NULL_HANDLE ? 1 : 0);
+}
+
+VkDescriptorPool DescriptorAllocator::getPool(VkDevice device) {
+    if (!freePools.empty()) {
+        VkDescriptorPool pool = freePools.back();
+        freePools.pop_back();
+        return pool;
+    }
+
+    std::vector<VkDescriptorPoolSize> poolSizes;
+    poolSizes.reserve(ratios.size());
+
+    for (const DescriptorPoolRatio& ratio : ratios) {
+        VkDescriptorPoolSize poolSize{};
+        poolSize.type = ratio.type;
+        poolSize.descriptorCount =
+            std::max(static_cast<uint32_t>(ratio.ratio * static_cast<float>(setsPerPool)), 1u);
+        poolSizes.push_back(poolSize);
+    }
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolInfo.pPoolSizes = poolSizes.data();
+    poolInfo.maxSets = setsPerPool;
+
+    VkDescriptorPool pool;
+
+    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &pool) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create descriptor pool!");
+    }
+
+    // Every pool that runs out is followed by a bigger one, so the chain stays short.
+    setsPerPool = std::min(setsPerPool + setsPerPool / 2, maxSetsPerPool);
+
+    return pool;
+}
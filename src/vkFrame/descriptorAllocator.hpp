@@ -0,0 +1,37 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cinttypes>
+#include <stdexcept>
+#include <vector>
+
+struct DescriptorPoolRatio {
+    VkDescriptorType type;
+    float ratio;
+};
+
+/*
+ * Hands out descriptor sets from a chain of pools, creating a larger pool whenever the current
+ * one runs out. Sets are never freed one by one: a per-frame allocator is reset as a whole once
+ * its frame's fence has been waited on, a persistent one lives until it is destroyed.
+ */
+class DescriptorAllocator {
+  public:
+    void create(uint32_t initialSetsPerPool = 64,
+                const std::vector<DescriptorPoolRatio>& ratios = {});
+    VkDescriptorSet allocate(VkDevice device, VkDescriptorSetLayout layout);
+    void reset(VkDevice device);
+    void destroy(VkDevice device);
+
+    size_t getPoolCount();
+
+  private:
+    VkDescriptorPool getPool(VkDevice device);
+
+    std::vector<DescriptorPoolRatio> ratios;
+    std::vector<VkDescriptorPool> fullPools;
+    std::vector<VkDescriptorPool> freePools;
+    VkDescriptorPool currentPool = VK_NULL_HANDLE;
+    uint32_t setsPerPool = 64;
+};
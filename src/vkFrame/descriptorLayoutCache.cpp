@@ -0,0 +1,131 @@
+#include "descriptorLayoutCache.hpp"
+
+#include <algorithm>
+
+VkDescriptorSetLayout
+DescriptorLayoutCache::get(VkDevice device,
+                           const std::vector<VkDescriptorSetLayoutBinding>& bindings) {
+    std::vector<VkDescriptorSetLayoutBinding> sortedBindings = bindings;
+    std::sort(sortedBindings.begin(), sortedBindings.end(),
+              [](const VkDescriptorSetLayoutBinding& a, const VkDescriptorSetLayoutBinding& b) {
+                  return a.binding < b.binding;
+              });
+
+    Key key;
+    key.reserve(sortedBindings.size() * 4);
+
+    for (const VkDescriptorSetLayoutBinding& binding : sortedBindings) {
+        if (binding.pImmutableSamplers != nullptr) {
+            throw std::invalid_argument("Cached layouts can't have immutable samplers!");
+        }
+
+        key.push_back(binding.binding);
+        key.push_back(binding.descriptorType);
+        key.push_back(binding.descriptorCount);
+        key.push_back(binding.stageFlags);
+    }
+
+    auto it = layouts.find(key);
+
+    if (it != layouts.end()) {
+        return it->second.layout;
+    }
+
+    Entry entry{};
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = static_cast<uint32_t>(sortedBindings.size());
+    layoutInfo.pBindings = sortedBindings.data();
+
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &entry.layout) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create descriptor set layout!");
+    }
+
+    std::vector<VkDescriptorUpdateTemplateEntry> templateEntries;
+
+    for (const VkDescriptorSetLayoutBinding& binding : sortedBindings) {
+        if (binding.descriptorCount == 0) {
+            continue;
+        }
+
+        VkDescriptorUpdateTemplateEntry templateEntry{};
+        templateEntry.dstBinding = binding.binding;
+        templateEntry.dstArrayElement = 0;
+        templateEntry.descriptorCount = binding.descriptorCount;
+        templateEntry.descriptorType = binding.descriptorType;
+        templateEntry.offset = entry.descriptorCount * sizeof(DescriptorData);
+        templateEntry.stride = sizeof(DescriptorData);
+        templateEntries.push_back(templateEntry);
+
+        entry.descriptorCount += binding.descriptorCount;
+    }
+
+    if (!templateEntries.empty()) {
+        VkDescriptorUpdateTemplateCreateInfo templateInfo{};
+        templateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO;
+        templateInfo.descriptorUpdateEntryCount = static_cast<uint32_t>(templateEntries.size());
+        templateInfo.pDescriptorUpdateEntries = templateEntries.data();
+        templateInfo.templateType = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET;
+        templateInfo.descriptorSetLayout = entry.layout;
+
+        if (vkCreateDescriptorUpdateTemplate(device, &templateInfo, nullptr,
+                                             &entry.updateTemplate) != VK_SUCCESS) {
+            vkDestroyDescriptorSetLayout(device, entry.layout, nullptr);
+            throw std::runtime_error("Failed to create descriptor update template!");
+        }
+    }
+
+    layouts[key] = entry;
+    layoutKeys[entry.layout] = key;
+
+    return entry.layout;
+}
+
+void DescriptorLayoutCache::update(VkDevice device, VkDescriptorSet descriptorSet,
+                                   VkDescriptorSetLayout layout,
+                                   const std::vector<DescriptorData>& data) {
+    const Entry& entry = getEntry(layout);
+
+    if (data.size() != entry.descriptorCount) {
+        throw std::invalid_argument("Descriptor data doesn't match the set layout!");
+    }
+
+    if (entry.updateTemplate != VK_NULL_HANDLE) {
+        vkUpdateDescriptorSetWithTemplate(device, descriptorSet, entry.updateTemplate,
+                                          data.data());
+    }
+}
+
+void DescriptorLayoutCache::destroy(VkDevice device) {
+    for (auto& [key, entry] : layouts) {
+        if (entry.updateTemplate != VK_NULL_HANDLE) {
+            vkDestroyDescriptorUpdateTemplate(device, entry.updateTemplate, nullptr);
+        }
+
+        vkDestroyDescriptorSetLayout(device, entry.layout, nullptr);
+    }
+
+    layouts.clear();
+    layoutKeys.clear();
+}
+
+uint32_t DescriptorLayoutCache::getDescriptorCount(VkDescriptorSetLayout layout) {
+    return getEntry(layout).descriptorCount;
+}
+
+size_t DescriptorLayoutCache::getLayoutCount() { return layouts.size(); }
+
+const DescriptorLayoutCache::Entry& DescriptorLayoutCache::getEntry(VkDescriptorSetLayout layout) {
+    auto keyIt = layoutKeys.find(layout);
+
+    if (keyIt == layoutKeys.end()) {
+        throw std::invalid_argument("Layout wasn't created by this cache!");
+    }
+
+    return layouts.at(keyIt->second);
+}
+
+size_t DescriptorLayoutCache::KeyHash::operator()(const Key& key) const {
+    return static_cast<size_t>(hashBytes(key.data(), key.size() * sizeof(uint32_t)));
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cinttypes>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include "hash.hpp"
+
+// One descriptor worth of data for an update template, interpreted by the binding's type.
+union DescriptorData {
+    VkDescriptorImageInfo image;
+    VkDescriptorBufferInfo buffer;
+    VkBufferView texelBuffer;
+};
+
+/*
+ * Deduplicates descriptor set layouts by their bindings, so pipelines and materials that declare
+ * the same interface share one layout and their sets are interchangeable. Every layout comes with
+ * an update template that writes all of its descriptors from one array of DescriptorData, ordered
+ * by binding number and then array element.
+ */
+class DescriptorLayoutCache {
+  public:
+    VkDescriptorSetLayout get(VkDevice device,
+                              const std::vector<VkDescriptorSetLayoutBinding>& bindings);
+    void update(VkDevice device, VkDescriptorSet descriptorSet, VkDescriptorSetLayout layout,
+                const std::vector<DescriptorData>& data);
+    void destroy(VkDevice device);
+
+    uint32_t getDescriptorCount(VkDescriptorSetLayout layout);
+    size_t getLayoutCount();
+
+  private:
+    using Key = std::vector<uint32_t>;
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+
+    struct Entry {
+        VkDescriptorSetLayout layout;
+        VkDescriptorUpdateTemplate updateTemplate;
+        uint32_t descriptorCount;
+    };
+
+    const Entry& getEntry(VkDescriptorSetLayout layout);
+
+    std::unordered_map<Key, Entry, KeyHash> layouts;
+    std::unordered_map<VkDescriptorSetLayout, Key> layoutKeys;
+};
@@ -0,0 +1,126 @@
+#include "descriptorSets.hpp"
+
+void DescriptorSets::createLayout(
+    VkDevice device,
+    std::function<void(std::vector<VkDescriptorSetLayoutBinding>&)> setupBindings,
+    DescriptorLayoutCache* layoutCache, VkDescriptorSetLayoutCreateFlags flags) {
+    this->setupBindings = setupBindings;
+    this->layoutCache = layoutCache;
+    this->layoutFlags = flags;
+
+    std::vector<VkDescriptorSetLayoutBinding> bindings;
+    setupBindings(bindings);
+
+    if (layoutCache != nullptr) {
+        layout = layoutCache->get(device, bindings);
+        return;
+    }
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.flags = flags;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &layout) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create descriptor set layout!");
+    }
+}
+
+void DescriptorSets::createPool(
+    const uint32_t maxFramesInFlight, VkDevice device,
+    std::function<void(std::vector<VkDescriptorPoolSize>& poolSizes)> setupPool) {
+    this->setupPool = setupPool;
+
+    std::vector<VkDescriptorPoolSize> poolSizes;
+    setupPool(poolSizes);
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolInfo.pPoolSizes = poolSizes.data();
+    poolInfo.maxSets = static_cast<uint32_t>(maxFramesInFlight);
+
+    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &pool) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create descriptor pool!");
+    }
+}
+
+void DescriptorSets::createSets(
+    const uint32_t maxFramesInFlight, VkDevice device,
+    std::function<void(std::vector<VkWriteDescriptorSet>&, VkDescriptorSet, uint32_t)>
+        setupDescriptor) {
+    this->setupDescriptor = setupDescriptor;
+
+    std::vector<VkDescriptorSetLayout> layouts(maxFramesInFlight, layout);
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = pool;
+    allocInfo.descriptorSetCount = static_cast<uint32_t>(maxFramesInFlight);
+    allocInfo.pSetLayouts = layouts.data();
+
+    sets.resize(maxFramesInFlight);
+    if (vkAllocateDescriptorSets(device, &allocInfo, sets.data()) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate descriptor sets!");
+    }
+
+    for (uint32_t i = 0; i < maxFramesInFlight; i++) {
+        std::vector<VkWriteDescriptorSet> descriptorWrites;
+        setupDescriptor(descriptorWrites, sets[i], i);
+    }
+}
+
+void DescriptorSets::createSets(
+    const uint32_t maxFramesInFlight, VkDevice device, DescriptorAllocator& allocator,
+    std::function<void(std::vector<VkWriteDescriptorSet>&, VkDescriptorSet, uint32_t)>
+        setupDescriptor) {
+    if (layoutCache == nullptr) {
+        throw std::invalid_argument("Allocated descriptor sets need a cached layout!");
+    }
+
+    this->setupDescriptor = setupDescriptor;
+    this->allocator = &allocator;
+
+    sets.resize(maxFramesInFlight);
+    for (uint32_t i = 0; i < maxFramesInFlight; i++) {
+        sets[i] = allocator.allocate(device, layout);
+
+        std::vector<VkWriteDescriptorSet> descriptorWrites;
+        setupDescriptor(descriptorWrites, sets[i], i);
+    }
+}
+
+void DescriptorSets::recreate(VkDevice device, const uint32_t maxFramesInFlight,
+                              bool allocateSets) {
+    createLayout(device, setupBindings, layoutCache, layoutFlags);
+
+    if (allocator != nullptr) {
+        for (uint32_t i = 0; i < sets.size(); i++) {
+            std::vector<VkWriteDescriptorSet> descriptorWrites;
+            setupDescriptor(descriptorWrites, sets[i], i);
+        }
+    } else if (allocateSets) {
+        createPool(maxFramesInFlight, device, setupPool);
+        createSets(maxFramesInFlight, device, setupDescriptor);
+    }
+}
+
+void DescriptorSets::destroy(VkDevice device) {
+    if (allocator == nullptr) {
+        vkDestroyDescriptorPool(device, pool, nullptr);
+        pool = VK_NULL_HANDLE;
+    }
+
+    if (layoutCache == nullptr) {
+        vkDestroyDescriptorSetLayout(device, layout, nullptr);
+        layout = VK_NULL_HANDLE;
+    }
+}
+
+bool DescriptorSets::isCreated() { return static_cast<bool>(setupBindings); }
+
+bool DescriptorSets::isLayoutCached() { return layoutCache != nullptr; }
+
+VkDescriptorSetLayout DescriptorSets::getLayout() { return layout; }
+
+const std::vector<VkDescriptorSet>& DescriptorSets::getSets() { return sets; }
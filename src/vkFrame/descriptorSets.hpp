@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <functional>
+#include <stdexcept>
+#include <vector>
+
+#include "descriptorAllocator.hpp"
+#include "descriptorLayoutCache.hpp"
+
+/*
+ * The per-frame descriptor sets of a pipeline's set 0, together with the callbacks that declare
+ * and write them, so Pipeline and ComputePipeline create, recreate and destroy them the same way.
+ * The layout is either owned or shared through a DescriptorLayoutCache, and the sets come from an
+ * owned pool or from a DescriptorAllocator.
+ */
+class DescriptorSets {
+  public:
+    void createLayout(VkDevice device,
+                      std::function<void(std::vector<VkDescriptorSetLayoutBinding>&)> setupBindings,
+                      DescriptorLayoutCache* layoutCache = nullptr,
+                      VkDescriptorSetLayoutCreateFlags flags = 0);
+    void createPool(const uint32_t maxFramesInFlight, VkDevice device,
+                    std::function<void(std::vector<VkDescriptorPoolSize>& poolSizes)> setupPool);
+    void createSets(
+        const uint32_t maxFramesInFlight, VkDevice device,
+        std::function<void(std::vector<VkWriteDescriptorSet>&, VkDescriptorSet, uint32_t)>
+            setupDescriptor);
+    void createSets(
+        const uint32_t maxFramesInFlight, VkDevice device, DescriptorAllocator& allocator,
+        std::function<void(std::vector<VkWriteDescriptorSet>&, VkDescriptorSet, uint32_t)>
+            setupDescriptor);
+    // Rebuilds everything from the stored callbacks. Sets from an allocator are kept and only
+    // rewritten, since the cached layout they were allocated with doesn't change. Push descriptor
+    // layouts pass allocateSets = false, as they have no sets.
+    void recreate(VkDevice device, const uint32_t maxFramesInFlight, bool allocateSets = true);
+    void destroy(VkDevice device);
+
+    bool isCreated();
+    bool isLayoutCached();
+    VkDescriptorSetLayout getLayout();
+    const std::vector<VkDescriptorSet>& getSets();
+
+  private:
+    VkDescriptorSetLayout layout = VK_NULL_HANDLE;
+    VkDescriptorSetLayoutCreateFlags layoutFlags = 0;
+    VkDescriptorPool pool = VK_NULL_HANDLE;
+    std::vector<VkDescriptorSet> sets;
+    DescriptorLayoutCache* layoutCache = nullptr;
+    DescriptorAllocator* allocator = nullptr;
+
+    std::function<void(std::vector<VkDescriptorSetLayoutBinding>&)> setupBindings;
+    std::function<void(std::vector<VkDescriptorPoolSize>& poolSizes)> setupPool;
+    std::function<void(std::vector<VkWriteDescriptorSet>&, VkDescriptorSet, uint32_t)>
+        setupDescriptor;
+};
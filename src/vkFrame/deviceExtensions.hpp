@@ -0,0 +1,135 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+/*
+ * Optional device extensions and features, enabled by the renderer only when the physical device
+ * supports them. Code that benefits from one checks its flag and falls back otherwise.
+ */
+struct DeviceExtensions {
+    bool memoryBudget = false;
+    bool hostImageCopy = false;
+    bool textureCompressionBC = false;
+    bool descriptorIndexing = false;
+    bool pushDescriptor = false;
+    bool bufferDeviceAddress = false;
+    bool multiDrawIndirect = false;
+    bool drawIndirectCount = false;
+    bool drawIndirectFirstInstance = false;
+    bool extendedDynamicState = false;
+    bool extendedDynamicState2 = false;
+    bool shaderObject = false;
+    bool dynamicRendering = false;
+
+    PFN_vkCmdPushDescriptorSetKHR cmdPushDescriptorSet = nullptr;
+
+#ifdef VK_EXT_host_image_copy
+    PFN_vkCopyMemoryToImageEXT copyMemoryToImage = nullptr;
+    PFN_vkTransitionImageLayoutEXT transitionImageLayout = nullptr;
+#endif
+
+#ifdef VK_KHR_dynamic_rendering
+    PFN_vkCmdBeginRenderingKHR cmdBeginRendering = nullptr;
+    PFN_vkCmdEndRenderingKHR cmdEndRendering = nullptr;
+#endif
+
+    // Shader objects provide the extended dynamic state commands as well.
+#ifdef VK_EXT_extended_dynamic_state
+    PFN_vkCmdSetViewportWithCountEXT cmdSetViewportWithCount = nullptr;
+    PFN_vkCmdSetScissorWithCountEXT cmdSetScissorWithCount = nullptr;
+    PFN_vkCmdSetCullModeEXT cmdSetCullMode = nullptr;
+    PFN_vkCmdSetFrontFaceEXT cmdSetFrontFace = nullptr;
+    PFN_vkCmdSetPrimitiveTopologyEXT cmdSetPrimitiveTopology = nullptr;
+    PFN_vkCmdSetDepthTestEnableEXT cmdSetDepthTestEnable = nullptr;
+    PFN_vkCmdSetDepthWriteEnableEXT cmdSetDepthWriteEnable = nullptr;
+    PFN_vkCmdSetDepthCompareOpEXT cmdSetDepthCompareOp = nullptr;
+    PFN_vkCmdSetDepthBoundsTestEnableEXT cmdSetDepthBoundsTestEnable = nullptr;
+    PFN_vkCmdSetStencilTestEnableEXT cmdSetStencilTestEnable = nullptr;
+#endif
+
+#ifdef VK_EXT_extended_dynamic_state2
+    PFN_vkCmdSetRasterizerDiscardEnableEXT cmdSetRasterizerDiscardEnable = nullptr;
+    PFN_vkCmdSetDepthBiasEnableEXT cmdSetDepthBiasEnable = nullptr;
+    PFN_vkCmdSetPrimitiveRestartEnableEXT cmdSetPrimitiveRestartEnable = nullptr;
+#endif
+
+#ifdef VK_EXT_shader_object
+    PFN_vkCreateShadersEXT createShaders = nullptr;
+    PFN_vkDestroyShaderEXT destroyShader = nullptr;
+    PFN_vkCmdBindShadersEXT cmdBindShaders = nullptr;
+    PFN_vkCmdSetPolygonModeEXT cmdSetPolygonMode = nullptr;
+    PFN_vkCmdSetRasterizationSamplesEXT cmdSetRasterizationSamples = nullptr;
+    PFN_vkCmdSetSampleMaskEXT cmdSetSampleMask = nullptr;
+    PFN_vkCmdSetAlphaToCoverageEnableEXT cmdSetAlphaToCoverageEnable = nullptr;
+    PFN_vkCmdSetVertexInputEXT cmdSetVertexInput = nullptr;
+    PFN_vkCmdSetColorBlendEnableEXT cmdSetColorBlendEnable = nullptr;
+    PFN_vkCmdSetColorBlendEquationEXT cmdSetColorBlendEquation = nullptr;
+    PFN_vkCmdSetColorWriteMaskEXT cmdSetColorWriteMask = nullptr;
+#endif
+
+    void loadFunctions(VkDevice device) {
+        if (pushDescriptor) {
+            loadFunction(device, "vkCmdPushDescriptorSetKHR", cmdPushDescriptorSet);
+        }
+
+#ifdef VK_EXT_host_image_copy
+        if (hostImageCopy) {
+            loadFunction(device, "vkCopyMemoryToImageEXT", copyMemoryToImage);
+            loadFunction(device, "vkTransitionImageLayoutEXT", transitionImageLayout);
+        }
+#endif
+
+#ifdef VK_KHR_dynamic_rendering
+        if (dynamicRendering) {
+            loadFunction(device, "vkCmdBeginRenderingKHR", cmdBeginRendering);
+            loadFunction(device, "vkCmdEndRenderingKHR", cmdEndRendering);
+        }
+#endif
+
+#ifdef VK_EXT_extended_dynamic_state
+        if (extendedDynamicState || shaderObject) {
+            loadFunction(device, "vkCmdSetViewportWithCountEXT", cmdSetViewportWithCount);
+            loadFunction(device, "vkCmdSetScissorWithCountEXT", cmdSetScissorWithCount);
+            loadFunction(device, "vkCmdSetCullModeEXT", cmdSetCullMode);
+            loadFunction(device, "vkCmdSetFrontFaceEXT", cmdSetFrontFace);
+            loadFunction(device, "vkCmdSetPrimitiveTopologyEXT", cmdSetPrimitiveTopology);
+            loadFunction(device, "vkCmdSetDepthTestEnableEXT", cmdSetDepthTestEnable);
+            loadFunction(device, "vkCmdSetDepthWriteEnableEXT", cmdSetDepthWriteEnable);
+            loadFunction(device, "vkCmdSetDepthCompareOpEXT", cmdSetDepthCompareOp);
+            loadFunction(device, "vkCmdSetDepthBoundsTestEnableEXT", cmdSetDepthBoundsTestEnable);
+            loadFunction(device, "vkCmdSetStencilTestEnableEXT", cmdSetStencilTestEnable);
+        }
+#endif
+
+#ifdef VK_EXT_extended_dynamic_state2
+        if (extendedDynamicState2 || shaderObject) {
+            loadFunction(device, "vkCmdSetRasterizerDiscardEnableEXT",
+                         cmdSetRasterizerDiscardEnable);
+            loadFunction(device, "vkCmdSetDepthBiasEnableEXT", cmdSetDepthBiasEnable);
+            loadFunction(device, "vkCmdSetPrimitiveRestartEnableEXT",
+                         cmdSetPrimitiveRestartEnable);
+        }
+#endif
+
+#ifdef VK_EXT_shader_object
+        if (shaderObject) {
+            loadFunction(device, "vkCreateShadersEXT", createShaders);
+            loadFunction(device, "vkDestroyShaderEXT", destroyShader);
+            loadFunction(device, "vkCmdBindShadersEXT", cmdBindShaders);
+            loadFunction(device, "vkCmdSetPolygonModeEXT", cmdSetPolygonMode);
+            loadFunction(device, "vkCmdSetRasterizationSamplesEXT", cmdSetRasterizationSamples);
+            loadFunction(device, "vkCmdSetSampleMaskEXT", cmdSetSampleMask);
+            loadFunction(device, "vkCmdSetAlphaToCoverageEnableEXT", cmdSetAlphaToCoverageEnable);
+            loadFunction(device, "vkCmdSetVertexInputEXT", cmdSetVertexInput);
+            loadFunction(device, "vkCmdSetColorBlendEnableEXT", cmdSetColorBlendEnable);
+            loadFunction(device, "vkCmdSetColorBlendEquationEXT", cmdSetColorBlendEquation);
+            loadFunction(device, "vkCmdSetColorWriteMaskEXT", cmdSetColorWriteMask);
+        }
+#endif
+    }
+
+  private:
+    template <typename T> static void loadFunction(VkDevice device, const char* name, T& function) {
+        function = reinterpret_cast<T>(vkGetDeviceProcAddr(device, name));
+    }
+};
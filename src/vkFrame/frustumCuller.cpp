@@ -0,0 +1,160 @@
+#include "frustumCuller.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+void FrustumCuller::create(VkPhysicalDevice physicalDevice, VkDevice device,
+                           VmaAllocator allocator, const std::string& computeShader,
+                           uint32_t maxInstances, uint32_t maxFramesInFlight) {
+    buffers.create(physicalDevice, allocator, maxInstances, 1, maxFramesInFlight);
+
+    pipeline.createDescriptorSetLayout(
+        device, [&](std::vector<VkDescriptorSetLayoutBinding>& bindings) {
+            for (uint32_t i = 0; i < 3; i++) {
+                VkDescriptorSetLayoutBinding binding{};
+                binding.binding = i;
+                binding.descriptorCount = 1;
+                binding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                binding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+                bindings.push_back(binding);
+            }
+        });
+    pipeline.createDescriptorPool(
+        maxFramesInFlight, device, [=](std::vector<VkDescriptorPoolSize>& poolSizes) {
+            VkDescriptorPoolSize poolSize{};
+            poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            poolSize.descriptorCount = 3 * maxFramesInFlight;
+            poolSizes.push_back(poolSize);
+        });
+    pipeline.createDescriptorSets(
+        maxFramesInFlight, device,
+        [this, device](std::vector<VkWriteDescriptorSet>& descriptorWrites,
+                       VkDescriptorSet descriptorSet, uint32_t i) {
+            std::array<VkDescriptorBufferInfo, 3> bufferInfos{};
+            bufferInfos[0].buffer = buffers.getBoundsBuffer();
+            bufferInfos[0].offset = 0;
+            bufferInfos[0].range = VK_WHOLE_SIZE;
+            bufferInfos[1].buffer = buffers.getVisibleInstanceBuffer();
+            bufferInfos[1].offset = getVisibleInstanceOffset(i);
+            bufferInfos[1].range = buffers.getVisibleInstanceRange();
+            bufferInfos[2].buffer = buffers.getDrawCommandBuffer();
+            bufferInfos[2].offset = getDrawCommandOffset(i);
+            bufferInfos[2].range = sizeof(VkDrawIndexedIndirectCommand);
+
+            descriptorWrites.resize(bufferInfos.size());
+
+            for (uint32_t binding = 0; binding < bufferInfos.size(); binding++) {
+                descriptorWrites[binding].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                descriptorWrites[binding].dstSet = descriptorSet;
+                descriptorWrites[binding].dstBinding = binding;
+                descriptorWrites[binding].dstArrayElement = 0;
+                descriptorWrites[binding].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                descriptorWrites[binding].descriptorCount = 1;
+                descriptorWrites[binding].pBufferInfo = &bufferInfos[binding];
+            }
+
+            vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()),
+                                   descriptorWrites.data(), 0, nullptr);
+        });
+    pipeline.addPushConstantRange<PushConstants>();
+    pipeline.create(computeShader, device, 64);
+}
+
+void FrustumCuller::updateBounds(const std::vector<glm::vec4>& spheres, VmaAllocator allocator,
+                                 Commands& commands, VkQueue graphicsQueue, VkDevice device) {
+    buffers.updateBounds(spheres, allocator, commands, graphicsQueue, device);
+}
+
+void FrustumCuller::cull(VkCommandBuffer commandBuffer, uint32_t currentFrame,
+                         const glm::mat4& viewProjection,
+                         const VkDrawIndexedIndirectCommand& drawCommand) {
+    VkDrawIndexedIndirectCommand resetCommand = drawCommand;
+    resetCommand.instanceCount = 0;
+    resetCommand.firstInstance = 0;
+
+    vkCmdUpdateBuffer(commandBuffer, buffers.getDrawCommandBuffer(),
+                      getDrawCommandOffset(currentFrame), sizeof(VkDrawIndexedIndirectCommand),
+                      &resetCommand);
+
+    // The previous use of this frame's buffers finished behind its fence, so only the reset
+    // has to be ordered before the shader's atomics.
+    BarrierBatch barriers;
+    barriers.bufferBarrier(buffers.getDrawCommandBuffer(), VK_PIPELINE_STAGE_TRANSFER_BIT,
+                           VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                           VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+                           getDrawCommandOffset(currentFrame), buffers.getDrawCommandRange());
+    barriers.flush(commandBuffer);
+
+    PushConstants pushConstants{};
+    std::array<glm::vec4, 6> planes = getFrustumPlanes(viewProjection);
+    std::copy(planes.begin(), planes.end(), pushConstants.planes);
+    pushConstants.instanceCount = buffers.getInstanceCount();
+
+    pipeline.bind(commandBuffer, currentFrame);
+    pipeline.pushConstants(commandBuffer, pushConstants);
+    pipeline.dispatchThreads(commandBuffer, buffers.getInstanceCount());
+
+    ComputePipeline::addWriteBarrier(barriers, buffers.getDrawCommandBuffer(),
+                                     VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+                                     VK_ACCESS_INDIRECT_COMMAND_READ_BIT,
+                                     getDrawCommandOffset(currentFrame),
+                                     buffers.getDrawCommandRange());
+    ComputePipeline::addWriteBarrier(barriers, buffers.getVisibleInstanceBuffer(),
+                                     VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+                                     VK_ACCESS_SHADER_READ_BIT,
+                                     getVisibleInstanceOffset(currentFrame),
+                                     buffers.getVisibleInstanceRange());
+    barriers.flush(commandBuffer);
+}
+
+void FrustumCuller::draw(VkCommandBuffer commandBuffer, uint32_t currentFrame) {
+    vkCmdDrawIndexedIndirect(commandBuffer, buffers.getDrawCommandBuffer(),
+                             getDrawCommandOffset(currentFrame), 1,
+                             sizeof(VkDrawIndexedIndirectCommand));
+}
+
+void FrustumCuller::destroy(VkDevice device, VmaAllocator allocator) {
+    pipeline.cleanup(device);
+    buffers.destroy(allocator);
+}
+
+const VkBuffer& FrustumCuller::getVisibleInstanceBuffer() {
+    return buffers.getVisibleInstanceBuffer();
+}
+
+VkDeviceSize FrustumCuller::getVisibleInstanceOffset(uint32_t currentFrame) {
+    return buffers.getVisibleInstanceOffset(currentFrame);
+}
+
+VkDeviceSize FrustumCuller::getVisibleInstanceRange() { return buffers.getVisibleInstanceRange(); }
+
+const VkBuffer& FrustumCuller::getDrawCommandBuffer() { return buffers.getDrawCommandBuffer(); }
+
+VkDeviceSize FrustumCuller::getDrawCommandOffset(uint32_t currentFrame) {
+    return buffers.getDrawCommandOffset(currentFrame);
+}
+
+std::array<glm::vec4, 6> FrustumCuller::getFrustumPlanes(const glm::mat4& viewProjection) {
+    glm::vec4 rows[4];
+
+    for (int32_t i = 0; i < 4; i++) {
+        rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i],
+                            viewProjection[3][i]);
+    }
+
+    std::array<glm::vec4, 6> planes = {
+        rows[3] + rows[0], // Left
+        rows[3] - rows[0], // Right
+        rows[3] + rows[1], // Bottom
+        rows[3] - rows[1], // Top
+        rows[2],           // Near
+        rows[3] - rows[2], // Far
+    };
+
+    // Normalized so the sphere radius can be compared against the plane distance directly.
+    for (glm::vec4& plane : planes) {
+        plane /= glm::length(glm::vec3(plane));
+    }
+
+    return planes;
+}
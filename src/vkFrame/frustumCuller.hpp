@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vk_mem_alloc.h>
+#include <vulkan/vulkan.h>
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cinttypes>
+#include <string>
+#include <vector>
+
+#include "buffer.hpp"
+#include "commands.hpp"
+#include "computePipeline.hpp"
+#include "cullingCommon.hpp"
+
+/*
+ * Culls the instances of one instanced draw against the camera frustum on the GPU. Each frame,
+ * cull() compacts the indices of the visible instances into a buffer and writes their count
+ * into an indirect draw command, which draw() then consumes. The vertex shader looks up
+ * visibleInstances[gl_InstanceIndex] to find the instance it is drawing, and reads that
+ * instance's data from a storage buffer instead of a per-instance vertex binding.
+ */
+class FrustumCuller {
+  public:
+    void create(VkPhysicalDevice physicalDevice, VkDevice device, VmaAllocator allocator,
+                const std::string& computeShader, uint32_t maxInstances,
+                uint32_t maxFramesInFlight);
+    // Bounding spheres of the instances, center in xyz and radius in w.
+    void updateBounds(const std::vector<glm::vec4>& spheres, VmaAllocator allocator,
+                      Commands& commands, VkQueue graphicsQueue, VkDevice device);
+    // Must be recorded outside of a render pass.
+    void cull(VkCommandBuffer commandBuffer, uint32_t currentFrame,
+              const glm::mat4& viewProjection, const VkDrawIndexedIndirectCommand& drawCommand);
+    void draw(VkCommandBuffer commandBuffer, uint32_t currentFrame);
+    void destroy(VkDevice device, VmaAllocator allocator);
+
+    const VkBuffer& getVisibleInstanceBuffer();
+    VkDeviceSize getVisibleInstanceOffset(uint32_t currentFrame);
+    VkDeviceSize getVisibleInstanceRange();
+    const VkBuffer& getDrawCommandBuffer();
+    VkDeviceSize getDrawCommandOffset(uint32_t currentFrame);
+
+    // Expects a projection with a depth range of zero to one.
+    static std::array<glm::vec4, 6> getFrustumPlanes(const glm::mat4& viewProjection);
+
+  private:
+    struct PushConstants {
+        glm::vec4 planes[6];
+        uint32_t instanceCount;
+        uint32_t padding[3];
+    };
+
+    ComputePipeline pipeline;
+    CullingBuffers buffers;
+};
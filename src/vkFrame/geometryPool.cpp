@@ -0,0 +1,303 @@
+#include "geometryPool.hpp"
+
+#include <cstring>
+
+void GeometryPool::create(VmaAllocator allocator, uint32_t vertexStride, VkIndexType indexType,
+                          uint32_t maxVertices, uint32_t maxIndices, uint32_t maxFramesInFlight,
+                          VkBufferUsageFlags extraUsage) {
+    if (indexType != VK_INDEX_TYPE_UINT16 && indexType != VK_INDEX_TYPE_UINT32) {
+        throw std::invalid_argument("Geometry pool indices should be 16 or 32 bit!");
+    }
+
+    this->vertexStride = vertexStride;
+    this->indexType = indexType;
+    this->maxVertices = maxVertices;
+    this->maxIndices = maxIndices;
+    this->extraUsage = extraUsage;
+    removedEntries.resize(maxFramesInFlight);
+
+    createBuffers(allocator, vertexBuffer, indexBuffer);
+
+    // The virtual blocks count in vertices and indices rather than bytes.
+    VmaVirtualBlockCreateInfo blockInfo{};
+    blockInfo.size = maxVertices;
+
+    if (vmaCreateVirtualBlock(&blockInfo, &vertexBlock) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create geometry pool vertex block!");
+    }
+
+    blockInfo.size = maxIndices;
+
+    if (vmaCreateVirtualBlock(&blockInfo, &indexBlock) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create geometry pool index block!");
+    }
+}
+
+uint32_t GeometryPool::add(VmaAllocator allocator, Commands& commands, VkQueue graphicsQueue,
+                           VkDevice device, const void* vertices, uint32_t vertexCount,
+                           const void* indices, uint32_t indexCount) {
+    if (vertexCount == 0 || indexCount == 0) {
+        throw std::invalid_argument("Can't add empty geometry to the pool!");
+    }
+
+    Entry entry{};
+    entry.range.vertexCount = vertexCount;
+    entry.range.indexCount = indexCount;
+
+    VmaVirtualAllocationCreateInfo allocCreateInfo{};
+    VkDeviceSize offset;
+
+    allocCreateInfo.size = vertexCount;
+
+    if (vmaVirtualAllocate(vertexBlock, &allocCreateInfo, &entry.vertexAllocation, &offset) !=
+        VK_SUCCESS) {
+        throw std::runtime_error("Geometry pool is out of vertex space!");
+    }
+
+    entry.range.firstVertex = static_cast<uint32_t>(offset);
+    allocCreateInfo.size = indexCount;
+
+    if (vmaVirtualAllocate(indexBlock, &allocCreateInfo, &entry.indexAllocation, &offset) !=
+        VK_SUCCESS) {
+        vmaVirtualFree(vertexBlock, entry.vertexAllocation);
+        throw std::runtime_error("Geometry pool is out of index space!");
+    }
+
+    entry.range.firstIndex = static_cast<uint32_t>(offset);
+    entry.alive = true;
+
+    VkDeviceSize vertexByteSize = static_cast<VkDeviceSize>(vertexCount) * vertexStride;
+    VkDeviceSize indexByteSize = static_cast<VkDeviceSize>(indexCount) * getIndexSize();
+
+    Buffer stagingBuffer(allocator, vertexByteSize + indexByteSize,
+                         VK_BUFFER_USAGE_TRANSFER_SRC_BIT, true);
+    uint8_t* staging = static_cast<uint8_t*>(stagingBuffer.getMappedData());
+    memcpy(staging, vertices, vertexByteSize);
+    memcpy(staging + vertexByteSize, indices, indexByteSize);
+
+    VkCommandBuffer commandBuffer = commands.beginSingleTime(graphicsQueue, device);
+
+    VkBufferCopy vertexRegion{};
+    vertexRegion.srcOffset = 0;
+    vertexRegion.dstOffset = static_cast<VkDeviceSize>(entry.range.firstVertex) * vertexStride;
+    vertexRegion.size = vertexByteSize;
+    vkCmdCopyBuffer(commandBuffer, stagingBuffer.getBuffer(), vertexBuffer.getBuffer(), 1,
+                    &vertexRegion);
+
+    VkBufferCopy indexRegion{};
+    indexRegion.srcOffset = vertexByteSize;
+    indexRegion.dstOffset = static_cast<VkDeviceSize>(entry.range.firstIndex) * getIndexSize();
+    indexRegion.size = indexByteSize;
+    vkCmdCopyBuffer(commandBuffer, stagingBuffer.getBuffer(), indexBuffer.getBuffer(), 1,
+                    &indexRegion);
+
+    commands.endSingleTime(commandBuffer, graphicsQueue, device);
+    stagingBuffer.destroy(allocator);
+
+    usedVertices += vertexCount;
+    usedIndices += indexCount;
+
+    uint32_t geometry;
+
+    if (!freeEntries.empty()) {
+        geometry = freeEntries.back();
+        freeEntries.pop_back();
+        entries[geometry] = entry;
+    } else {
+        geometry = static_cast<uint32_t>(entries.size());
+        entries.push_back(entry);
+    }
+
+    return geometry;
+}
+
+void GeometryPool::beginFrame(uint32_t currentFrame) {
+    this->currentFrame = currentFrame;
+
+    // The frame's fence covers every frame submitted before it as well.
+    freeRemoved(removedEntries[currentFrame]);
+}
+
+void GeometryPool::remove(uint32_t geometry) {
+    Entry& entry = getEntry(geometry);
+
+    // Frames in flight may still draw the ranges, so they are freed once this frame retires.
+    removedEntries[currentFrame].push_back(entry);
+
+    entry = Entry{};
+    freeEntries.push_back(geometry);
+}
+
+void GeometryPool::defragment(VmaAllocator allocator, Commands& commands, VkQueue graphicsQueue,
+                              VkDevice device) {
+    Buffer newVertexBuffer;
+    Buffer newIndexBuffer;
+    createBuffers(allocator, newVertexBuffer, newIndexBuffer);
+
+    // Reallocating every live range from empty blocks packs them at the front of the buffers.
+    // Nothing reads the removed ranges past the wait for the device below.
+    vmaClearVirtualBlock(vertexBlock);
+    vmaClearVirtualBlock(indexBlock);
+
+    for (std::vector<Entry>& removed : removedEntries) {
+        for (const Entry& entry : removed) {
+            usedVertices -= entry.range.vertexCount;
+            usedIndices -= entry.range.indexCount;
+        }
+
+        removed.clear();
+    }
+
+    std::vector<VkBufferCopy> vertexRegions;
+    std::vector<VkBufferCopy> indexRegions;
+
+    for (Entry& entry : entries) {
+        if (!entry.alive) {
+            continue;
+        }
+
+        VmaVirtualAllocationCreateInfo allocCreateInfo{};
+        VkDeviceSize offset;
+
+        allocCreateInfo.size = entry.range.vertexCount;
+
+        if (vmaVirtualAllocate(vertexBlock, &allocCreateInfo, &entry.vertexAllocation, &offset) !=
+            VK_SUCCESS) {
+            newVertexBuffer.destroy(allocator);
+            newIndexBuffer.destroy(allocator);
+            throw std::runtime_error("Failed to reallocate geometry pool vertices!");
+        }
+
+        VkBufferCopy vertexRegion{};
+        vertexRegion.srcOffset = static_cast<VkDeviceSize>(entry.range.firstVertex) * vertexStride;
+        vertexRegion.dstOffset = offset * vertexStride;
+        vertexRegion.size = static_cast<VkDeviceSize>(entry.range.vertexCount) * vertexStride;
+        vertexRegions.push_back(vertexRegion);
+        entry.range.firstVertex = static_cast<uint32_t>(offset);
+
+        allocCreateInfo.size = entry.range.indexCount;
+
+        if (vmaVirtualAllocate(indexBlock, &allocCreateInfo, &entry.indexAllocation, &offset) !=
+            VK_SUCCESS) {
+            newVertexBuffer.destroy(allocator);
+            newIndexBuffer.destroy(allocator);
+            throw std::runtime_error("Failed to reallocate geometry pool indices!");
+        }
+
+        VkBufferCopy indexRegion{};
+        indexRegion.srcOffset = static_cast<VkDeviceSize>(entry.range.firstIndex) * getIndexSize();
+        indexRegion.dstOffset = offset * getIndexSize();
+        indexRegion.size = static_cast<VkDeviceSize>(entry.range.indexCount) * getIndexSize();
+        indexRegions.push_back(indexRegion);
+        entry.range.firstIndex = static_cast<uint32_t>(offset);
+    }
+
+    // The old buffers may still be read by frames in flight.
+    vkDeviceWaitIdle(device);
+
+    if (!vertexRegions.empty()) {
+        VkCommandBuffer commandBuffer = commands.beginSingleTime(graphicsQueue, device);
+        vkCmdCopyBuffer(commandBuffer, vertexBuffer.getBuffer(), newVertexBuffer.getBuffer(),
+                        static_cast<uint32_t>(vertexRegions.size()), vertexRegions.data());
+        vkCmdCopyBuffer(commandBuffer, indexBuffer.getBuffer(), newIndexBuffer.getBuffer(),
+                        static_cast<uint32_t>(indexRegions.size()), indexRegions.data());
+        commands.endSingleTime(commandBuffer, graphicsQueue, device);
+    }
+
+    vertexBuffer.destroy(allocator);
+    indexBuffer.destroy(allocator);
+    vertexBuffer = newVertexBuffer;
+    indexBuffer = newIndexBuffer;
+}
+
+void GeometryPool::bind(VkCommandBuffer commandBuffer, StateTracker* stateTracker) {
+    VkDeviceSize offsets[] = {0};
+
+    if (stateTracker != nullptr) {
+        stateTracker->bindVertexBuffers(commandBuffer, 0, 1, &vertexBuffer.getBuffer(), offsets);
+        stateTracker->bindIndexBuffer(commandBuffer, indexBuffer.getBuffer(), 0, indexType);
+        return;
+    }
+
+    vkCmdBindVertexBuffers(commandBuffer, 0, 1, &vertexBuffer.getBuffer(), offsets);
+    vkCmdBindIndexBuffer(commandBuffer, indexBuffer.getBuffer(), 0, indexType);
+}
+
+void GeometryPool::destroy(VmaAllocator allocator) {
+    vmaClearVirtualBlock(vertexBlock);
+    vmaClearVirtualBlock(indexBlock);
+    vmaDestroyVirtualBlock(vertexBlock);
+    vmaDestroyVirtualBlock(indexBlock);
+
+    vertexBuffer.destroy(allocator);
+    indexBuffer.destroy(allocator);
+
+    entries.clear();
+    freeEntries.clear();
+    removedEntries.clear();
+    usedVertices = 0;
+    usedIndices = 0;
+}
+
+const GeometryRange& GeometryPool::getRange(uint32_t geometry) {
+    return getEntry(geometry).range;
+}
+
+VkDrawIndexedIndirectCommand GeometryPool::getDrawCommand(uint32_t geometry,
+                                                          uint32_t instanceCount,
+                                                          uint32_t firstInstance) {
+    const GeometryRange& range = getRange(geometry);
+
+    VkDrawIndexedIndirectCommand command{};
+    command.indexCount = range.indexCount;
+    command.instanceCount = instanceCount;
+    command.firstIndex = range.firstIndex;
+    command.vertexOffset = static_cast<int32_t>(range.firstVertex);
+    command.firstInstance = firstInstance;
+
+    return command;
+}
+
+VkIndexType GeometryPool::getIndexType() { return indexType; }
+
+uint32_t GeometryPool::getIndexSize() { return indexType == VK_INDEX_TYPE_UINT16 ? 2 : 4; }
+
+Buffer& GeometryPool::getVertexBuffer() { return vertexBuffer; }
+
+Buffer& GeometryPool::getIndexBuffer() { return indexBuffer; }
+
+uint32_t GeometryPool::getUsedVertices() { return usedVertices; }
+
+uint32_t GeometryPool::getUsedIndices() { return usedIndices; }
+
+GeometryPool::Entry& GeometryPool::getEntry(uint32_t geometry) {
+    if (geometry >= entries.size() || !entries[geometry].alive) {
+        throw std::invalid_argument("Geometry isn't in the pool!");
+    }
+
+    return entries[geometry];
+}
+
+void GeometryPool::freeRemoved(std::vector<Entry>& removed) {
+    for (const Entry& entry : removed) {
+        vmaVirtualFree(vertexBlock, entry.vertexAllocation);
+        vmaVirtualFree(indexBlock, entry.indexAllocation);
+
+        usedVertices -= entry.range.vertexCount;
+        usedIndices -= entry.range.indexCount;
+    }
+
+    removed.clear();
+}
+
+void GeometryPool::createBuffers(VmaAllocator allocator, Buffer& newVertexBuffer,
+                                 Buffer& newIndexBuffer) {
+    newVertexBuffer = Buffer(allocator, static_cast<VkDeviceSize>(maxVertices) * vertexStride,
+                             VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+                                 VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | extraUsage,
+                             false);
+    newIndexBuffer = Buffer(allocator, static_cast<VkDeviceSize>(maxIndices) * getIndexSize(),
+                            VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+                                VK_BUFFER_USAGE_INDEX_BUFFER_BIT | extraUsage,
+                            false);
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <vk_mem_alloc.h>
+#include <vulkan/vulkan.h>
+
+#include <cinttypes>
+#include <stdexcept>
+#include <vector>
+
+#include "buffer.hpp"
+#include "commands.hpp"
+#include "stateTracker.hpp"
+
+struct GeometryRange {
+    uint32_t firstVertex = 0;
+    uint32_t vertexCount = 0;
+    uint32_t firstIndex = 0;
+    uint32_t indexCount = 0;
+};
+
+/*
+ * Suballocates the vertex and index ranges of many meshes from one vertex buffer and one index
+ * buffer, so a whole scene binds its geometry once and draws select meshes through firstIndex and
+ * vertexOffset. Ranges are placed by a TLSF allocator and handed out as stable handles, which
+ * stay valid when defragment() moves the ranges to close the gaps left by removed meshes. The
+ * ranges of a removed mesh are only reused once the frame that removed it has retired.
+ */
+class GeometryPool {
+  public:
+    void create(VmaAllocator allocator, uint32_t vertexStride, VkIndexType indexType,
+                uint32_t maxVertices, uint32_t maxIndices, uint32_t maxFramesInFlight,
+                VkBufferUsageFlags extraUsage = 0);
+    // Frees the ranges removed while the frame was last recorded, so has to follow the wait on
+    // the frame's fence.
+    void beginFrame(uint32_t currentFrame);
+
+    template <typename V, typename I>
+    uint32_t add(VmaAllocator allocator, Commands& commands, VkQueue graphicsQueue,
+                 VkDevice device, const std::vector<V>& vertices, const std::vector<I>& indices) {
+        if (sizeof(V) != vertexStride || sizeof(I) != getIndexSize()) {
+            throw std::invalid_argument("Geometry doesn't match the pool's vertex or index type!");
+        }
+
+        return add(allocator, commands, graphicsQueue, device, vertices.data(),
+                   static_cast<uint32_t>(vertices.size()), indices.data(),
+                   static_cast<uint32_t>(indices.size()));
+    }
+
+    uint32_t add(VmaAllocator allocator, Commands& commands, VkQueue graphicsQueue,
+                 VkDevice device, const void* vertices, uint32_t vertexCount, const void* indices,
+                 uint32_t indexCount);
+    void remove(uint32_t geometry);
+    void defragment(VmaAllocator allocator, Commands& commands, VkQueue graphicsQueue,
+                    VkDevice device);
+    void bind(VkCommandBuffer commandBuffer, StateTracker* stateTracker = nullptr);
+    void destroy(VmaAllocator allocator);
+
+    const GeometryRange& getRange(uint32_t geometry);
+    VkDrawIndexedIndirectCommand getDrawCommand(uint32_t geometry, uint32_t instanceCount = 1,
+                                                uint32_t firstInstance = 0);
+    VkIndexType getIndexType();
+    uint32_t getIndexSize();
+    Buffer& getVertexBuffer();
+    Buffer& getIndexBuffer();
+    uint32_t getUsedVertices();
+    uint32_t getUsedIndices();
+
+  private:
+    struct Entry {
+        GeometryRange range;
+        VmaVirtualAllocation vertexAllocation = VK_NULL_HANDLE;
+        VmaVirtualAllocation indexAllocation = VK_NULL_HANDLE;
+        bool alive = false;
+    };
+
+    Entry& getEntry(uint32_t geometry);
+    void freeRemoved(std::vector<Entry>& removed);
+    void createBuffers(VmaAllocator allocator, Buffer& newVertexBuffer, Buffer& newIndexBuffer);
+
+    Buffer vertexBuffer;
+    Buffer indexBuffer;
+    VmaVirtualBlock vertexBlock = VK_NULL_HANDLE;
+    VmaVirtualBlock indexBlock = VK_NULL_HANDLE;
+    VkBufferUsageFlags extraUsage = 0;
+    VkIndexType indexType = VK_INDEX_TYPE_UINT32;
+    uint32_t vertexStride = 0;
+    uint32_t maxVertices = 0;
+    uint32_t maxIndices = 0;
+    uint32_t usedVertices = 0;
+    uint32_t usedIndices = 0;
+    std::vector<Entry> entries;
+    std::vector<uint32_t> freeEntries;
+    // Entries removed while recording each frame in flight, whose ranges may still be read.
+    std::vector<std::vector<Entry>> removedEntries;
+    uint32_t currentFrame = 0;
+};
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cinttypes>
+#include <cstddef>
+
+// FNV-1a, used to key the caches on plain creation state.
+inline uint64_t hashBytes(const void* data, size_t byteSize,
+                          uint64_t hash = 14695981039346656037ull) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+
+    for (size_t i = 0; i < byteSize; i++) {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+
+    return hash;
+}
@@ -0,0 +1,203 @@
+#include "hiZPyramid.hpp"
+
+#include <algorithm>
+#include <array>
+
+#include "barriers.hpp"
+
+static uint32_t previousPowerOfTwo(uint32_t value) {
+    uint32_t result = 1;
+
+    while (result * 2 <= value) {
+        result *= 2;
+    }
+
+    return result;
+}
+
+void HiZPyramid::create(VkDevice device, VmaAllocator allocator, const std::string& computeShader,
+                        RenderPass& renderPass, VkExtent2D extent) {
+    this->renderPass = &renderPass;
+
+    VkSamplerCreateInfo samplerInfo{};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_NEAREST;
+    samplerInfo.minFilter = VK_FILTER_NEAREST;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.minLod = 0.0f;
+    samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+
+    if (vkCreateSampler(device, &samplerInfo, nullptr, &sampler) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create depth pyramid sampler!");
+    }
+
+    createImage(device, allocator, extent);
+
+    pipeline.createDescriptorSetLayout(
+        device, [](std::vector<VkDescriptorSetLayoutBinding>& bindings) {
+            VkDescriptorSetLayoutBinding srcBinding{};
+            srcBinding.binding = 0;
+            srcBinding.descriptorCount = 1;
+            srcBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            srcBinding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+            bindings.push_back(srcBinding);
+
+            VkDescriptorSetLayoutBinding dstBinding{};
+            dstBinding.binding = 1;
+            dstBinding.descriptorCount = 1;
+            dstBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+            dstBinding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+            bindings.push_back(dstBinding);
+        });
+    // One set per level, each reading the level above it and the first reading the depth.
+    pipeline.createDescriptorPool(
+        image.getMipmapLevels(), device, [this](std::vector<VkDescriptorPoolSize>& poolSizes) {
+            VkDescriptorPoolSize srcPoolSize{};
+            srcPoolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            srcPoolSize.descriptorCount = image.getMipmapLevels();
+            poolSizes.push_back(srcPoolSize);
+
+            VkDescriptorPoolSize dstPoolSize{};
+            dstPoolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+            dstPoolSize.descriptorCount = image.getMipmapLevels();
+            poolSizes.push_back(dstPoolSize);
+        });
+    pipeline.createDescriptorSets(
+        image.getMipmapLevels(), device,
+        [this, device](std::vector<VkWriteDescriptorSet>& descriptorWrites,
+                       VkDescriptorSet descriptorSet, uint32_t level) {
+            std::array<VkDescriptorImageInfo, 2> imageInfos{};
+            imageInfos[0].sampler = sampler;
+
+            if (level == 0) {
+                imageInfos[0].imageView = this->renderPass->getDepthImageView();
+                imageInfos[0].imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+            } else {
+                imageInfos[0].imageView = levelViews[level - 1];
+                imageInfos[0].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+            }
+
+            imageInfos[1].imageView = levelViews[level];
+            imageInfos[1].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+            descriptorWrites.resize(imageInfos.size());
+
+            for (uint32_t binding = 0; binding < imageInfos.size(); binding++) {
+                descriptorWrites[binding].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                descriptorWrites[binding].dstSet = descriptorSet;
+                descriptorWrites[binding].dstBinding = binding;
+                descriptorWrites[binding].dstArrayElement = 0;
+                descriptorWrites[binding].descriptorType =
+                    binding == 0 ? VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER
+                                 : VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+                descriptorWrites[binding].descriptorCount = 1;
+                descriptorWrites[binding].pImageInfo = &imageInfos[binding];
+            }
+
+            vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()),
+                                   descriptorWrites.data(), 0, nullptr);
+        });
+    pipeline.addPushConstantRange<PushConstants>();
+    pipeline.create(computeShader, device, 8, 8);
+}
+
+void HiZPyramid::recreate(VkDevice device, VmaAllocator allocator, RenderPass& renderPass,
+                          VkExtent2D extent) {
+    this->renderPass = &renderPass;
+
+    destroyImage(device, allocator);
+    createImage(device, allocator, extent);
+    pipeline.recreate(device, image.getMipmapLevels());
+}
+
+void HiZPyramid::build(VkCommandBuffer commandBuffer, RenderPass& renderPass) {
+    Image& depthImage = renderPass.getDepthImage();
+
+    // The render pass moved the depth image to its final layout without the tracker seeing it.
+    depthImage.setSubresourceAccess(
+        getLayoutAccess(VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL));
+
+    BarrierBatch barriers;
+    barriers.transition(depthImage,
+                        {VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT});
+    barriers.transition(image, {VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                VK_ACCESS_SHADER_WRITE_BIT});
+    barriers.flush(commandBuffer);
+
+    PushConstants pushConstants{};
+    pushConstants.srcWidth = static_cast<int32_t>(depthExtent.width);
+    pushConstants.srcHeight = static_cast<int32_t>(depthExtent.height);
+
+    for (uint32_t level = 0; level < image.getMipmapLevels(); level++) {
+        pushConstants.dstWidth = static_cast<int32_t>(std::max(image.getWidth() >> level, 1u));
+        pushConstants.dstHeight = static_cast<int32_t>(std::max(image.getHeight() >> level, 1u));
+
+        pipeline.bind(commandBuffer, level);
+        pipeline.pushConstants(commandBuffer, pushConstants);
+        pipeline.dispatchThreads(commandBuffer, pushConstants.dstWidth, pushConstants.dstHeight);
+
+        // The next level reads this one, and the culling pass reads all of them.
+        barriers.transition(image,
+                            {VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_ACCESS_SHADER_READ_BIT},
+                            level, 1);
+        barriers.flush(commandBuffer);
+
+        pushConstants.srcWidth = pushConstants.dstWidth;
+        pushConstants.srcHeight = pushConstants.dstHeight;
+    }
+
+    barriers.transition(depthImage, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+    barriers.flush(commandBuffer);
+}
+
+void HiZPyramid::destroy(VkDevice device, VmaAllocator allocator) {
+    pipeline.cleanup(device);
+    destroyImage(device, allocator);
+    vkDestroySampler(device, sampler, nullptr);
+}
+
+const VkImageView& HiZPyramid::getView() { return view; }
+
+VkSampler HiZPyramid::getSampler() { return sampler; }
+
+uint32_t HiZPyramid::getWidth() { return image.getWidth(); }
+
+uint32_t HiZPyramid::getHeight() { return image.getHeight(); }
+
+uint32_t HiZPyramid::getMipmapLevels() { return image.getMipmapLevels(); }
+
+void HiZPyramid::createImage(VkDevice device, VmaAllocator allocator, VkExtent2D extent) {
+    depthExtent = extent;
+
+    uint32_t width = previousPowerOfTwo(extent.width);
+    uint32_t height = previousPowerOfTwo(extent.height);
+    uint32_t levels = Image::calcMipmapLevels(width, height);
+
+    image = Image(allocator, width, height, VK_FORMAT_R32_SFLOAT, VK_IMAGE_TILING_OPTIMAL,
+                  VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                  VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, levels);
+    view = image.createView(VK_IMAGE_ASPECT_COLOR_BIT, device, VK_IMAGE_VIEW_TYPE_2D,
+                            VK_FORMAT_R32_SFLOAT, 0, levels);
+
+    levelViews.resize(levels);
+
+    for (uint32_t level = 0; level < levels; level++) {
+        levelViews[level] = image.createView(VK_IMAGE_ASPECT_COLOR_BIT, device,
+                                             VK_IMAGE_VIEW_TYPE_2D, VK_FORMAT_R32_SFLOAT, level, 1);
+    }
+}
+
+void HiZPyramid::destroyImage(VkDevice device, VmaAllocator allocator) {
+    for (VkImageView levelView : levelViews) {
+        vkDestroyImageView(device, levelView, nullptr);
+    }
+
+    levelViews.clear();
+    vkDestroyImageView(device, view, nullptr);
+    image.destroy(allocator);
+}
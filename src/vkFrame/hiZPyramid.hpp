@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vk_mem_alloc.h>
+#include <vulkan/vulkan.h>
+
+#include <cinttypes>
+#include <string>
+#include <vector>
+
+#include "computePipeline.hpp"
+#include "image.hpp"
+#include "renderPass.hpp"
+
+/*
+ * A mip chain of the farthest depth under every texel, reduced from the depth attachment of a
+ * render pass created with stored depth. Level 0 is the largest power of two that fits in the
+ * depth attachment, so every level halves the previous one exactly. The whole chain is left in
+ * VK_IMAGE_LAYOUT_GENERAL for compute shaders to sample with texelFetch.
+ */
+class HiZPyramid {
+  public:
+    void create(VkDevice device, VmaAllocator allocator, const std::string& computeShader,
+                RenderPass& renderPass, VkExtent2D extent);
+    // Has to follow every recreation of the render pass, which replaces its depth image.
+    void recreate(VkDevice device, VmaAllocator allocator, RenderPass& renderPass,
+                  VkExtent2D extent);
+    // Must be recorded outside of a render pass, after the pass that wrote the depth. Leaves the
+    // depth image in VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL so the pass can resume.
+    void build(VkCommandBuffer commandBuffer, RenderPass& renderPass);
+    void destroy(VkDevice device, VmaAllocator allocator);
+
+    const VkImageView& getView();
+    VkSampler getSampler();
+    uint32_t getWidth();
+    uint32_t getHeight();
+    uint32_t getMipmapLevels();
+
+  private:
+    struct PushConstants {
+        int32_t srcWidth;
+        int32_t srcHeight;
+        int32_t dstWidth;
+        int32_t dstHeight;
+    };
+
+    void createImage(VkDevice device, VmaAllocator allocator, VkExtent2D extent);
+    void destroyImage(VkDevice device, VmaAllocator allocator);
+
+    ComputePipeline pipeline;
+    Image image;
+    VkImageView view = VK_NULL_HANDLE;
+    std::vector<VkImageView> levelViews;
+    VkSampler sampler = VK_NULL_HANDLE;
+    RenderPass* renderPass = nullptr;
+    VkExtent2D depthExtent{};
+};
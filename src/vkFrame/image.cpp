@@ -1,4 +1,9 @@
 #include "image.hpp"
+#include "barriers.hpp"
+#include "bindlessTable.hpp"
+#include "imageViewCache.hpp"
+#include "mipmaps.hpp"
+#include "stagingRing.hpp"
 
 Image::Image() {}
 
@@ -9,13 +14,16 @@ Image::Image(VkImage image, VmaAllocation allocation, VkFormat format)
 
 Image::Image(VmaAllocator allocator, uint32_t width, uint32_t height, VkFormat format,
              VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties,
-             uint32_t mipmapLevels, uint32_t layers, VkSampleCountFlagBits samples)
-    : format(format) {
+             uint32_t mipmapLevels, uint32_t layers, VkSampleCountFlagBits samples,
+             VkImageCreateFlags flags)
+    : format(format), usage(usage), createFlags(flags) {
 
     layerCount = layers;
+    viewType = layers == 1 ? VK_IMAGE_VIEW_TYPE_2D : VK_IMAGE_VIEW_TYPE_2D_ARRAY;
 
     VkImageCreateInfo imageInfo{};
     imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.flags = flags;
     imageInfo.imageType = VK_IMAGE_TYPE_2D;
     imageInfo.extent.width = width;
     imageInfo.extent.height = height;
@@ -43,34 +51,21 @@ Image::Image(VmaAllocator allocator, uint32_t width, uint32_t height, VkFormat f
     this->mipmapLevels = mipmapLevels;
     this->image = image;
     this->allocation = allocation;
+    subresourceAccesses.assign(mipmapLevels * layerCount, ImageAccess{});
 }
 
 void Image::generateMipmaps(Commands& commands, VkQueue graphicsQueue, VkDevice device) {
     VkCommandBuffer commandBuffer = commands.beginSingleTime(graphicsQueue, device);
-
-    VkImageMemoryBarrier barrier = {};
-    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-    barrier.image = image;
-    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    barrier.subresourceRange.baseArrayLayer = 0;
-    barrier.subresourceRange.layerCount = layerCount;
-    barrier.subresourceRange.levelCount = 1;
+    BarrierBatch barriers;
 
     int32_t mipmapWidth = width;
     int32_t mipmapHeight = height;
 
     for (uint32_t i = 1; i < mipmapLevels; i++) {
-        barrier.subresourceRange.baseMipLevel = i - 1;
-        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-
-        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
-                             VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1,
-                             &barrier);
+        // The source transition for this level shares a barrier with the final transition of
+        // the level before it.
+        barriers.transition(*this, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, i - 1, 1);
+        barriers.flush(commandBuffer);
 
         VkImageBlit blit{};
         blit.srcOffsets[0] = {0, 0, 0};
@@ -90,14 +85,7 @@ void Image::generateMipmaps(Commands& commands, VkQueue graphicsQueue, VkDevice
         vkCmdBlitImage(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, image,
                        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
 
-        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-        barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
-                             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1,
-                             &barrier);
+        barriers.transition(*this, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, i - 1, 1);
 
         if (mipmapWidth > 1) {
             mipmapWidth /= 2;
@@ -108,15 +96,8 @@ void Image::generateMipmaps(Commands& commands, VkQueue graphicsQueue, VkDevice
         }
     }
 
-    barrier.subresourceRange.baseMipLevel = mipmapLevels - 1;
-    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
-                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1,
-                         &barrier);
+    barriers.transition(*this, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, mipmapLevels - 1, 1);
+    barriers.flush(commandBuffer);
 
     commands.endSingleTime(commandBuffer, graphicsQueue, device);
 }
@@ -141,54 +122,281 @@ Buffer Image::loadImage(const std::string& image, VmaAllocator allocator, int32_
 }
 
 Image Image::createTexture(const std::string& image, VmaAllocator allocator, Commands& commands,
-                           VkQueue graphicsQueue, VkDevice device, bool enableMipmaps) {
+                           VkQueue graphicsQueue, VkDevice device, bool enableMipmaps,
+                           MipmapGenerator* mipmapGenerator, const DeviceExtensions* extensions) {
+    if (extensions && extensions->hostImageCopy) {
+        return createTextureHost(image, allocator, device, *extensions, enableMipmaps, 0, 0, 1);
+    }
+
     int32_t texWidth, texHeight;
     Buffer stagingBuffer = loadImage(image, allocator, texWidth, texHeight);
-    uint32_t mipMapLevels = enableMipmaps ? calcMipmapLevels(texWidth, texHeight) : 1;
 
-    Image textureImage =
-        Image(allocator, texWidth, texHeight, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL,
-              VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT |
-                  VK_IMAGE_USAGE_SAMPLED_BIT,
-              VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, mipMapLevels);
-
-    textureImage.transitionImageLayout(commands, VK_IMAGE_LAYOUT_UNDEFINED,
-                                       VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, graphicsQueue, device);
-    textureImage.copyFromBuffer(stagingBuffer, commands, graphicsQueue, device);
+    Image textureImage = fromBuffer(stagingBuffer, allocator, commands, graphicsQueue, device,
+                                    enableMipmaps, texWidth, texHeight, 1, 0, 0, mipmapGenerator);
 
     stagingBuffer.destroy(allocator);
 
-    textureImage.generateMipmaps(commands, graphicsQueue, device);
-
     return textureImage;
 }
 
 Image Image::createTextureArray(const std::string& image, VmaAllocator allocator,
                                 Commands& commands, VkQueue graphicsQueue, VkDevice device,
                                 bool enableMipmaps, uint32_t width, uint32_t height,
-                                uint32_t layers) {
+                                uint32_t layers, MipmapGenerator* mipmapGenerator,
+                                const DeviceExtensions* extensions) {
+    if (extensions && extensions->hostImageCopy) {
+        return createTextureHost(image, allocator, device, *extensions, enableMipmaps, width,
+                                 height, layers);
+    }
+
     int32_t texWidth, texHeight;
     Buffer stagingBuffer = loadImage(image, allocator, texWidth, texHeight);
+
+    Image textureImage =
+        fromBuffer(stagingBuffer, allocator, commands, graphicsQueue, device, enableMipmaps, width,
+                   height, layers, texWidth, texHeight, mipmapGenerator);
+
+    stagingBuffer.destroy(allocator);
+
+    return textureImage;
+}
+
+Image Image::createCompressedTexture(const std::string& image, VmaAllocator allocator,
+                                     Commands& commands, VkQueue graphicsQueue, VkDevice device,
+                                     const DeviceExtensions& extensions, bool enableMipmaps,
+                                     BlockFormat blockFormat, CompressionQuality quality) {
+    if (!extensions.textureCompressionBC) {
+        return createTexture(image, allocator, commands, graphicsQueue, device, enableMipmaps,
+                             nullptr, &extensions);
+    }
+
+    int32_t texWidth, texHeight, texChannels;
+    stbi_uc* pixels = stbi_load(image.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+
+    if (!pixels) {
+        throw std::runtime_error("Failed to load texture image!");
+    }
+
+    uint32_t width = texWidth;
+    uint32_t height = texHeight;
     uint32_t mipMapLevels = enableMipmaps ? calcMipmapLevels(width, height) : 1;
 
+    std::vector<VkDeviceSize> levelOffsets;
+    std::vector<uint8_t> mipChain = MipmapGenerator::downsampleCpu(
+        pixels, width, height, 1, mipMapLevels, true, false, levelOffsets);
+
+    std::vector<VkDeviceSize> compressedOffsets;
+    VkDeviceSize compressedByteSize = 0;
+
+    for (uint32_t i = 0; i < mipMapLevels; i++) {
+        compressedOffsets.push_back(compressedByteSize);
+        compressedByteSize += BlockCompressor::getCompressedSize(
+            std::max(width >> i, 1u), std::max(height >> i, 1u), blockFormat);
+    }
+
+    // Blocks are encoded straight into the mapped staging memory.
+    Buffer stagingBuffer(allocator, compressedByteSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, true);
+    uint8_t* stagingData = static_cast<uint8_t*>(stagingBuffer.getMappedData());
+
+    for (uint32_t i = 0; i < mipMapLevels; i++) {
+        const uint8_t* levelPixels = i == 0 ? pixels : mipChain.data() + levelOffsets[i - 1];
+        BlockCompressor::compress(levelPixels, std::max(width >> i, 1u),
+                                  std::max(height >> i, 1u), blockFormat, quality,
+                                  stagingData + compressedOffsets[i]);
+    }
+
+    stbi_image_free(pixels);
+
     Image textureImage =
-        Image(allocator, width, height, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL,
-              VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT |
-                  VK_IMAGE_USAGE_SAMPLED_BIT,
-              VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, mipMapLevels, layers);
+        Image(allocator, width, height, BlockCompressor::getFormat(blockFormat, true),
+              VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+              VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, mipMapLevels);
 
-    textureImage.transitionImageLayout(commands, VK_IMAGE_LAYOUT_UNDEFINED,
-                                       VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, graphicsQueue, device);
-    textureImage.copyFromBuffer(stagingBuffer, commands, graphicsQueue, device, texWidth,
-                                texHeight);
+    VkCommandBuffer commandBuffer = commands.beginSingleTime(graphicsQueue, device);
+
+    BarrierBatch barriers;
+    barriers.transition(textureImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+    barriers.flush(commandBuffer);
+
+    std::vector<VkBufferImageCopy> regions;
+
+    for (uint32_t i = 0; i < mipMapLevels; i++) {
+        VkBufferImageCopy region{};
+        region.bufferOffset = compressedOffsets[i];
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel = i;
+        region.imageSubresource.baseArrayLayer = 0;
+        region.imageSubresource.layerCount = 1;
+        region.imageExtent = {std::max(width >> i, 1u), std::max(height >> i, 1u), 1};
+        regions.push_back(region);
+    }
+
+    vkCmdCopyBufferToImage(commandBuffer, stagingBuffer.getBuffer(), textureImage.image,
+                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           static_cast<uint32_t>(regions.size()), regions.data());
+
+    barriers.transition(textureImage, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    barriers.flush(commandBuffer);
+
+    commands.endSingleTime(commandBuffer, graphicsQueue, device);
 
     stagingBuffer.destroy(allocator);
 
-    textureImage.generateMipmaps(commands, graphicsQueue, device);
+    return textureImage;
+}
+
+Image Image::fromBuffer(Buffer& stagingBuffer, VmaAllocator allocator, Commands& commands,
+                        VkQueue graphicsQueue, VkDevice device, bool enableMipmaps,
+                        uint32_t width, uint32_t height, uint32_t layers, uint32_t fullWidth,
+                        uint32_t fullHeight, MipmapGenerator* mipmapGenerator) {
+    uint32_t mipMapLevels = enableMipmaps ? calcMipmapLevels(width, height) : 1;
+    VkFormat format = VK_FORMAT_R8G8B8A8_SRGB;
+    VkImageUsageFlags usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT |
+                              VK_IMAGE_USAGE_SAMPLED_BIT;
+    VkImageCreateFlags flags = 0;
+
+    if (mipmapGenerator && mipMapLevels > 1) {
+        usage |= mipmapGenerator->getRequiredUsage(format);
+        flags |= mipmapGenerator->getRequiredFlags(format);
+    }
+
+    Image textureImage = Image(allocator, width, height, format, VK_IMAGE_TILING_OPTIMAL, usage,
+                               VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, mipMapLevels, layers,
+                               VK_SAMPLE_COUNT_1_BIT, flags);
+
+    textureImage.transitionImageLayout(commands, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                       graphicsQueue, device);
+    textureImage.copyFromBuffer(stagingBuffer, commands, graphicsQueue, device, fullWidth,
+                                fullHeight);
+
+    if (mipmapGenerator) {
+        mipmapGenerator->generate(textureImage, allocator, commands, graphicsQueue, device);
+    } else {
+        textureImage.generateMipmaps(commands, graphicsQueue, device);
+    }
 
     return textureImage;
 }
 
+Image Image::createTextureHost(const std::string& image, VmaAllocator allocator, VkDevice device,
+                               const DeviceExtensions& extensions, bool enableMipmaps,
+                               uint32_t width, uint32_t height, uint32_t layers) {
+    int32_t texWidth, texHeight, texChannels;
+    stbi_uc* pixels = stbi_load(image.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+
+    if (!pixels) {
+        throw std::runtime_error("Failed to load texture image!");
+    }
+
+    if (width == 0) {
+        width = texWidth;
+        height = texHeight;
+    }
+
+    Image textureImage = fromPixels(pixels, allocator, device, extensions, enableMipmaps, width,
+                                    height, layers, texWidth, texHeight);
+
+    stbi_image_free(pixels);
+
+    return textureImage;
+}
+
+Image Image::fromPixels(const uint8_t* pixels, VmaAllocator allocator, VkDevice device,
+                        const DeviceExtensions& extensions, bool enableMipmaps, uint32_t width,
+                        uint32_t height, uint32_t layers, uint32_t fullWidth,
+                        uint32_t fullHeight) {
+#ifdef VK_EXT_host_image_copy
+    if (fullWidth == 0) {
+        fullWidth = width;
+    }
+
+    if (fullHeight == 0) {
+        fullHeight = height;
+    }
+
+    uint32_t mipMapLevels = enableMipmaps ? calcMipmapLevels(width, height) : 1;
+    VkFormat format = VK_FORMAT_R8G8B8A8_SRGB;
+    VkImageUsageFlags usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT |
+                              VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT;
+
+    Image textureImage = Image(allocator, width, height, format, VK_IMAGE_TILING_OPTIMAL, usage,
+                               VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, mipMapLevels, layers);
+
+    // Layers packed into a sheet are gathered so that each one follows the one before it.
+    const uint8_t* levelPixels = pixels;
+    std::vector<uint8_t> gatheredPixels;
+    size_t rowByteSize = static_cast<size_t>(width) * 4;
+
+    if (fullWidth != width) {
+        uint32_t texPerRow = fullWidth / width;
+        gatheredPixels.resize(rowByteSize * height * layers);
+
+        for (uint32_t layer = 0; layer < layers; layer++) {
+            uint32_t xLayer = layer % texPerRow;
+            uint32_t yLayer = layer / texPerRow;
+
+            for (uint32_t row = 0; row < height; row++) {
+                memcpy(gatheredPixels.data() + (layer * height + row) * rowByteSize,
+                       pixels + ((yLayer * height + row) * fullWidth + xLayer * width) * 4,
+                       rowByteSize);
+            }
+        }
+
+        levelPixels = gatheredPixels.data();
+    }
+
+    // Without a command buffer there is nothing to blit with, so the mip chain is built here.
+    std::vector<VkDeviceSize> levelOffsets;
+    std::vector<uint8_t> mipChain = MipmapGenerator::downsampleCpu(
+        levelPixels, width, height, layers, mipMapLevels, true, false, levelOffsets);
+
+    VkHostImageLayoutTransitionInfoEXT transition{};
+    transition.sType = VK_STRUCTURE_TYPE_HOST_IMAGE_LAYOUT_TRANSITION_INFO_EXT;
+    transition.image = textureImage.image;
+    transition.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    transition.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    transition.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    transition.subresourceRange.baseMipLevel = 0;
+    transition.subresourceRange.levelCount = mipMapLevels;
+    transition.subresourceRange.baseArrayLayer = 0;
+    transition.subresourceRange.layerCount = layers;
+
+    if (extensions.transitionImageLayout(device, 1, &transition) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to transition image layout on the host!");
+    }
+
+    std::vector<VkMemoryToImageCopyEXT> regions(mipMapLevels);
+
+    for (uint32_t i = 0; i < mipMapLevels; i++) {
+        regions[i].sType = VK_STRUCTURE_TYPE_MEMORY_TO_IMAGE_COPY_EXT;
+        regions[i].pHostPointer = i == 0 ? levelPixels : mipChain.data() + levelOffsets[i - 1];
+        regions[i].imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        regions[i].imageSubresource.mipLevel = i;
+        regions[i].imageSubresource.baseArrayLayer = 0;
+        regions[i].imageSubresource.layerCount = layers;
+        regions[i].imageOffset = {0, 0, 0};
+        regions[i].imageExtent = {std::max(width >> i, 1u), std::max(height >> i, 1u), 1};
+    }
+
+    VkCopyMemoryToImageInfoEXT copyInfo{};
+    copyInfo.sType = VK_STRUCTURE_TYPE_COPY_MEMORY_TO_IMAGE_INFO_EXT;
+    copyInfo.dstImage = textureImage.image;
+    copyInfo.dstImageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    copyInfo.regionCount = static_cast<uint32_t>(regions.size());
+    copyInfo.pRegions = regions.data();
+
+    if (extensions.copyMemoryToImage(device, &copyInfo) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to copy texture image from the host!");
+    }
+
+    textureImage.setSubresourceAccess(getLayoutAccess(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL));
+
+    return textureImage;
+#else
+    throw std::runtime_error("Host image copies are not supported by these Vulkan headers!");
+#endif
+}
+
 VkImageView Image::createTextureView(VkDevice device) {
     return createView(VK_IMAGE_ASPECT_COLOR_BIT, device);
 }
@@ -198,6 +406,44 @@ VkSampler Image::createTextureSampler(VkPhysicalDevice physicalDevice, VkDevice
     VkPhysicalDeviceProperties properties{};
     vkGetPhysicalDeviceProperties(physicalDevice, &properties);
 
+    VkSamplerCreateInfo samplerInfo =
+        getTextureSamplerInfo(properties.limits.maxSamplerAnisotropy, minFilter, magFilter);
+
+    VkSampler textureSampler;
+
+    if (vkCreateSampler(device, &samplerInfo, nullptr, &textureSampler) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create texture sampler!");
+    }
+
+    return textureSampler;
+}
+
+VkSampler Image::getTextureSampler(SamplerCache& samplerCache, VkDevice device,
+                                   VkFilter minFilter, VkFilter magFilter) {
+    return samplerCache.get(
+        device, getTextureSamplerInfo(samplerCache.getLimits().maxSamplerAnisotropy, minFilter,
+                                      magFilter));
+}
+
+VkImageView Image::getTextureView(ImageViewCache& imageViewCache, VkDevice device) {
+    return imageViewCache.get(device, *this, VK_IMAGE_ASPECT_COLOR_BIT);
+}
+
+uint32_t Image::registerBindless(BindlessTextureTable& bindlessTable,
+                                 ImageViewCache& imageViewCache, VkDevice device) {
+    if (this->bindlessTable) {
+        return bindlessIndex;
+    }
+
+    bindlessView = getTextureView(imageViewCache, device);
+    bindlessIndex = bindlessTable.addImage(device, bindlessView);
+    this->bindlessTable = &bindlessTable;
+
+    return bindlessIndex;
+}
+
+VkSamplerCreateInfo Image::getTextureSamplerInfo(float maxAnisotropy, VkFilter minFilter,
+                                                 VkFilter magFilter) {
     VkSamplerCreateInfo samplerInfo{};
     samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
     samplerInfo.magFilter = magFilter;
@@ -206,7 +452,7 @@ VkSampler Image::createTextureSampler(VkPhysicalDevice physicalDevice, VkDevice
     samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
     samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
     samplerInfo.anisotropyEnable = VK_TRUE;
-    samplerInfo.maxAnisotropy = properties.limits.maxSamplerAnisotropy;
+    samplerInfo.maxAnisotropy = maxAnisotropy;
     samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
     samplerInfo.unnormalizedCoordinates = VK_FALSE;
     samplerInfo.compareEnable = VK_FALSE;
@@ -214,83 +460,75 @@ VkSampler Image::createTextureSampler(VkPhysicalDevice physicalDevice, VkDevice
     samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
     samplerInfo.maxLod = static_cast<float>(mipmapLevels);
 
-    VkSampler textureSampler;
+    return samplerInfo;
+}
 
-    if (vkCreateSampler(device, &samplerInfo, nullptr, &textureSampler) != VK_SUCCESS) {
-        throw std::runtime_error("Failed to create texture sampler!");
+VkImageView Image::createView(VkImageAspectFlags aspectFlags, VkDevice device) {
+    return createView(aspectFlags, device, viewType, format, 0, mipmapLevels);
+}
+
+VkImageView Image::createView(VkImageAspectFlags aspectFlags, VkDevice device,
+                              VkImageViewType viewType, VkFormat viewFormat,
+                              uint32_t baseMipLevel, uint32_t levelCount) {
+    VkImageViewCreateInfo viewInfo =
+        getViewInfo(aspectFlags, viewType, viewFormat, baseMipLevel, levelCount);
+
+    VkImageViewUsageCreateInfo usageInfo{};
+    usageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_USAGE_CREATE_INFO;
+    usageInfo.usage = getViewUsage(viewFormat);
+
+    if (usageInfo.usage != 0) {
+        viewInfo.pNext = &usageInfo;
     }
 
-    return textureSampler;
+    VkImageView imageView;
+    if (vkCreateImageView(device, &viewInfo, nullptr, &imageView) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create texture image view!");
+    }
+
+    return imageView;
 }
 
-VkImageView Image::createView(VkImageAspectFlags aspectFlags, VkDevice device) {
+VkImageViewCreateInfo Image::getViewInfo(VkImageAspectFlags aspectFlags) {
+    return getViewInfo(aspectFlags, viewType, format, 0, mipmapLevels);
+}
+
+VkImageViewCreateInfo Image::getViewInfo(VkImageAspectFlags aspectFlags, VkImageViewType viewType,
+                                         VkFormat viewFormat, uint32_t baseMipLevel,
+                                         uint32_t levelCount) {
     VkImageViewCreateInfo viewInfo{};
     viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
     viewInfo.image = image;
-    viewInfo.viewType = layerCount == 1 ? VK_IMAGE_VIEW_TYPE_2D : VK_IMAGE_VIEW_TYPE_2D_ARRAY;
-    viewInfo.format = format;
+    viewInfo.viewType = viewType;
+    viewInfo.format = viewFormat;
     viewInfo.subresourceRange = {};
     viewInfo.subresourceRange.aspectMask = aspectFlags;
-    viewInfo.subresourceRange.baseMipLevel = 0;
-    viewInfo.subresourceRange.levelCount = mipmapLevels;
+    viewInfo.subresourceRange.baseMipLevel = baseMipLevel;
+    viewInfo.subresourceRange.levelCount = levelCount;
     viewInfo.subresourceRange.baseArrayLayer = 0;
     viewInfo.subresourceRange.layerCount = layerCount;
 
-    VkImageView imageView;
-    if (vkCreateImageView(device, &viewInfo, nullptr, &imageView) != VK_SUCCESS) {
-        throw std::runtime_error("Failed to create texture image view!");
+    return viewInfo;
+}
+
+VkImageUsageFlags Image::getViewUsage(VkFormat viewFormat) {
+    // Images stored through views in another format, like the UNORM views of an sRGB image, have
+    // storage usage the image's own format may not support, so views in that format leave it out.
+    if ((createFlags & VK_IMAGE_CREATE_EXTENDED_USAGE_BIT) != 0 &&
+        (usage & VK_IMAGE_USAGE_STORAGE_BIT) != 0 && viewFormat == format) {
+        return usage & ~VK_IMAGE_USAGE_STORAGE_BIT;
     }
 
-    return imageView;
+    return 0;
 }
 
-void Image::transitionImageLayout(Commands& commands, VkImageLayout oldLayout,
-                                  VkImageLayout newLayout, VkQueue graphicsQueue, VkDevice device) {
+void Image::transitionImageLayout(Commands& commands, VkImageLayout newLayout,
+                                  VkQueue graphicsQueue, VkDevice device) {
     VkCommandBuffer commandBuffer = commands.beginSingleTime(graphicsQueue, device);
 
-    VkImageMemoryBarrier barrier{};
-    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-    barrier.oldLayout = oldLayout;
-    barrier.newLayout = newLayout;
-    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier.image = image;
-    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    barrier.subresourceRange.baseMipLevel = 0;
-    barrier.subresourceRange.levelCount = mipmapLevels;
-    barrier.subresourceRange.baseArrayLayer = 0;
-    barrier.subresourceRange.layerCount = layerCount;
-
-    VkPipelineStageFlags sourceStage;
-    VkPipelineStageFlags destinationStage;
-
-    if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED &&
-        newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) {
-        barrier.srcAccessMask = 0;
-        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-
-        sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-        destinationStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-    } else if (oldLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL &&
-               newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
-        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-        sourceStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-        destinationStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-    } else if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED &&
-               newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
-        barrier.srcAccessMask = VK_ACCESS_HOST_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
-        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-        sourceStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
-        destinationStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
-    } else {
-        throw std::invalid_argument("Unsupported layout transition!");
-    }
-
-    vkCmdPipelineBarrier(commandBuffer, sourceStage, destinationStage, 0, 0, nullptr, 0, nullptr, 1,
-                         &barrier);
+    BarrierBatch barriers;
+    barriers.transition(*this, newLayout);
+    barriers.flush(commandBuffer);
 
     commands.endSingleTime(commandBuffer, graphicsQueue, device);
 }
@@ -328,13 +566,166 @@ void Image::copyFromBuffer(Buffer& src, Commands& commands, VkQueue graphicsQueu
     }
 
     vkCmdCopyBufferToImage(commandBuffer, src.getBuffer(), image,
-                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(regions.size()), regions.data());
+                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           static_cast<uint32_t>(regions.size()), regions.data());
 
     commands.endSingleTime(commandBuffer, graphicsQueue, device);
 }
 
+void Image::updateRegion(StagingRing& stagingRing, VkCommandBuffer commandBuffer,
+                         const void* pixels, uint32_t x, uint32_t y, uint32_t regionWidth,
+                         uint32_t regionHeight, uint32_t layer, uint32_t mipLevel,
+                         bool regenerateMipmaps) {
+    uint32_t levelWidth = std::max(width >> mipLevel, 1u);
+    uint32_t levelHeight = std::max(height >> mipLevel, 1u);
+
+    if (mipLevel >= mipmapLevels || layer >= layerCount || x + regionWidth > levelWidth ||
+        y + regionHeight > levelHeight) {
+        throw std::invalid_argument("Updated region is outside of the image!");
+    }
+
+    VkDeviceSize bufferOffset = stagingRing.push(
+        pixels, static_cast<VkDeviceSize>(regionWidth) * regionHeight * 4);
+
+    uint32_t lastLevel = regenerateMipmaps ? mipmapLevels - 1 : mipLevel;
+
+    BarrierBatch barriers;
+    barriers.transition(*this, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mipLevel,
+                        lastLevel - mipLevel + 1, layer, 1);
+    barriers.flush(commandBuffer);
+
+    VkBufferImageCopy region{};
+    region.bufferOffset = bufferOffset;
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel = mipLevel;
+    region.imageSubresource.baseArrayLayer = layer;
+    region.imageSubresource.layerCount = 1;
+    region.imageOffset = {static_cast<int32_t>(x), static_cast<int32_t>(y), 0};
+    region.imageExtent = {regionWidth, regionHeight, 1};
+
+    vkCmdCopyBufferToImage(commandBuffer, stagingRing.getBuffer(), image,
+                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+    // Only the texels covering the updated region are downsampled into each following level.
+    uint32_t x0 = x;
+    uint32_t y0 = y;
+    uint32_t x1 = x + regionWidth;
+    uint32_t y1 = y + regionHeight;
+
+    for (uint32_t i = mipLevel + 1; i <= lastLevel; i++) {
+        uint32_t srcWidth = std::max(width >> (i - 1), 1u);
+        uint32_t srcHeight = std::max(height >> (i - 1), 1u);
+        uint32_t dstWidth = std::max(width >> i, 1u);
+        uint32_t dstHeight = std::max(height >> i, 1u);
+
+        x0 /= 2;
+        y0 /= 2;
+        x1 = std::min((x1 + 1) / 2, dstWidth);
+        y1 = std::min((y1 + 1) / 2, dstHeight);
+
+        barriers.transition(*this, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, i - 1, 1, layer, 1);
+        barriers.flush(commandBuffer);
+
+        VkImageBlit blit{};
+        blit.srcOffsets[0] = {static_cast<int32_t>(x0 * 2), static_cast<int32_t>(y0 * 2), 0};
+        blit.srcOffsets[1] = {static_cast<int32_t>(std::min(x1 * 2, srcWidth)),
+                              static_cast<int32_t>(std::min(y1 * 2, srcHeight)), 1};
+        blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        blit.srcSubresource.mipLevel = i - 1;
+        blit.srcSubresource.baseArrayLayer = layer;
+        blit.srcSubresource.layerCount = 1;
+        blit.dstOffsets[0] = {static_cast<int32_t>(x0), static_cast<int32_t>(y0), 0};
+        blit.dstOffsets[1] = {static_cast<int32_t>(x1), static_cast<int32_t>(y1), 1};
+        blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        blit.dstSubresource.mipLevel = i;
+        blit.dstSubresource.baseArrayLayer = layer;
+        blit.dstSubresource.layerCount = 1;
+
+        vkCmdBlitImage(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, image,
+                       VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
+
+        barriers.transition(*this, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, i - 1, 1, layer, 1);
+    }
+
+    barriers.transition(*this, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, lastLevel, 1, layer, 1);
+    barriers.flush(commandBuffer);
+}
+
 uint32_t Image::calcMipmapLevels(int32_t texWidth, int32_t texHeight) {
     return static_cast<uint32_t>(std::floor(std::log2(std::max(texWidth, texHeight)))) + 1;
 }
 
-void Image::destroy(VmaAllocator allocator) { vmaDestroyImage(allocator, image, allocation); }
\ No newline at end of file
+void Image::destroy(VmaAllocator allocator) { vmaDestroyImage(allocator, image, allocation); }
+
+void Image::destroy(VmaAllocator allocator, ImageViewCache& imageViewCache, VkDevice device) {
+    if (bindlessTable) {
+        bindlessTable->releaseImage(bindlessView);
+        bindlessTable = nullptr;
+    }
+
+    imageViewCache.releaseImage(device, image);
+    destroy(allocator);
+}
+
+const VkImage& Image::getImage() { return image; }
+
+VkFormat Image::getFormat() { return format; }
+
+VkImageUsageFlags Image::getUsage() { return usage; }
+
+uint32_t Image::getWidth() { return width; }
+
+uint32_t Image::getHeight() { return height; }
+
+uint32_t Image::getMipmapLevels() { return mipmapLevels; }
+
+uint32_t Image::getLayerCount() { return layerCount; }
+
+VkImageAspectFlags Image::getAspectMask() {
+    switch (format) {
+    case VK_FORMAT_D16_UNORM:
+    case VK_FORMAT_D32_SFLOAT:
+    case VK_FORMAT_X8_D24_UNORM_PACK32:
+        return VK_IMAGE_ASPECT_DEPTH_BIT;
+    case VK_FORMAT_D16_UNORM_S8_UINT:
+    case VK_FORMAT_D24_UNORM_S8_UINT:
+    case VK_FORMAT_D32_SFLOAT_S8_UINT:
+        return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+    case VK_FORMAT_S8_UINT:
+        return VK_IMAGE_ASPECT_STENCIL_BIT;
+    default:
+        return VK_IMAGE_ASPECT_COLOR_BIT;
+    }
+}
+
+uint32_t Image::getBindlessIndex() {
+    if (!bindlessTable) {
+        throw std::runtime_error("Image isn't registered in a bindless table!");
+    }
+
+    return bindlessIndex;
+}
+
+void Image::setViewType(VkImageViewType viewType) { this->viewType = viewType; }
+
+const ImageAccess& Image::getSubresourceAccess(uint32_t mipLevel, uint32_t layer) {
+    return subresourceAccesses[mipLevel * layerCount + layer];
+}
+
+void Image::setSubresourceAccess(const ImageAccess& access, uint32_t baseMipLevel,
+                                 uint32_t levelCount, uint32_t baseArrayLayer,
+                                 uint32_t layerCount) {
+    if (levelCount == VK_REMAINING_MIP_LEVELS) {
+        levelCount = mipmapLevels - baseMipLevel;
+    }
+
+    if (layerCount == VK_REMAINING_ARRAY_LAYERS) {
+        layerCount = this->layerCount - baseArrayLayer;
+    }
+
+    for (uint32_t mipLevel = baseMipLevel; mipLevel < baseMipLevel + levelCount; mipLevel++) {
+        for (uint32_t layer = baseArrayLayer; layer < baseArrayLayer + layerCount; layer++) {
+            subresourceAccesses[mipLevel * this->layerCount + layer] = access;
+        }
+    }
+}
\ No newline at end of file
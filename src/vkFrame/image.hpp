@@ -7,16 +7,49 @@
 
 #include "../../deps/stb_image.h"
 
+#include "blockCompressor.hpp"
 #include "buffer.hpp"
+#include "deviceExtensions.hpp"
+#include "samplerCache.hpp"
+
+class BindlessTextureTable;
+class ImageViewCache;
+class MipmapGenerator;
+class StagingRing;
+
+struct ImageAccess {
+    VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+    VkPipelineStageFlags stageMask = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+    VkAccessFlags accessMask = 0;
+};
 
 class Image {
   public:
     static Image createTexture(const std::string& image, VmaAllocator allocator, Commands& commands,
-                               VkQueue graphicsQueue, VkDevice device, bool enableMipmaps);
+                               VkQueue graphicsQueue, VkDevice device, bool enableMipmaps,
+                               MipmapGenerator* mipmapGenerator = nullptr,
+                               const DeviceExtensions* extensions = nullptr);
     static Image createTextureArray(const std::string& image, VmaAllocator allocator,
                                     Commands& commands, VkQueue graphicsQueue, VkDevice device,
                                     bool enableMipmaps, uint32_t width, uint32_t height,
-                                    uint32_t layers);
+                                    uint32_t layers, MipmapGenerator* mipmapGenerator = nullptr,
+                                    const DeviceExtensions* extensions = nullptr);
+    static Image createCompressedTexture(const std::string& image, VmaAllocator allocator,
+                                         Commands& commands, VkQueue graphicsQueue,
+                                         VkDevice device, const DeviceExtensions& extensions,
+                                         bool enableMipmaps,
+                                         BlockFormat blockFormat = BlockFormat::BC1,
+                                         CompressionQuality quality = CompressionQuality::Fast);
+    static Image fromBuffer(Buffer& stagingBuffer, VmaAllocator allocator, Commands& commands,
+                            VkQueue graphicsQueue, VkDevice device, bool enableMipmaps,
+                            uint32_t width, uint32_t height, uint32_t layers,
+                            uint32_t fullWidth = 0, uint32_t fullHeight = 0,
+                            MipmapGenerator* mipmapGenerator = nullptr);
+    static Image fromPixels(const uint8_t* pixels, VmaAllocator allocator, VkDevice device,
+                            const DeviceExtensions& extensions, bool enableMipmaps, uint32_t width,
+                            uint32_t height, uint32_t layers, uint32_t fullWidth = 0,
+                            uint32_t fullHeight = 0);
+    static uint32_t calcMipmapLevels(int32_t texWidth, int32_t texHeight);
 
     Image();
     Image(VkImage image, VkFormat format);
@@ -24,29 +57,82 @@ class Image {
     Image(VmaAllocator allocator, uint32_t width, uint32_t height, VkFormat format,
           VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties,
           uint32_t mipmapLevels = 1, uint32_t layers = 1,
-          VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT);
+          VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT, VkImageCreateFlags flags = 0);
     VkImageView createTextureView(VkDevice device);
     VkSampler createTextureSampler(VkPhysicalDevice physicalDevice, VkDevice device,
                                    VkFilter minFilter = VK_FILTER_LINEAR,
                                    VkFilter magFilter = VK_FILTER_LINEAR);
+    VkSampler getTextureSampler(SamplerCache& samplerCache, VkDevice device,
+                                VkFilter minFilter = VK_FILTER_LINEAR,
+                                VkFilter magFilter = VK_FILTER_LINEAR);
+    VkImageView getTextureView(ImageViewCache& imageViewCache, VkDevice device);
+    // Adds the image's texture view to the table. The index stays the same until the image is
+    // destroyed through the view cache, which releases it again.
+    uint32_t registerBindless(BindlessTextureTable& bindlessTable, ImageViewCache& imageViewCache,
+                              VkDevice device);
+    VkSamplerCreateInfo getTextureSamplerInfo(float maxAnisotropy,
+                                              VkFilter minFilter = VK_FILTER_LINEAR,
+                                              VkFilter magFilter = VK_FILTER_LINEAR);
     VkImageView createView(VkImageAspectFlags aspectFlags, VkDevice device);
-    void transitionImageLayout(Commands& commands, VkImageLayout oldLayout, VkImageLayout newLayout,
-                               VkQueue graphicsQueue, VkDevice device);
+    VkImageView createView(VkImageAspectFlags aspectFlags, VkDevice device,
+                           VkImageViewType viewType, VkFormat viewFormat, uint32_t baseMipLevel,
+                           uint32_t levelCount);
+    VkImageViewCreateInfo getViewInfo(VkImageAspectFlags aspectFlags);
+    VkImageViewCreateInfo getViewInfo(VkImageAspectFlags aspectFlags, VkImageViewType viewType,
+                                      VkFormat viewFormat, uint32_t baseMipLevel,
+                                      uint32_t levelCount);
+    // The usage views in viewFormat have to be restricted to, or 0 when they can have all of it.
+    VkImageUsageFlags getViewUsage(VkFormat viewFormat);
+    void transitionImageLayout(Commands& commands, VkImageLayout newLayout, VkQueue graphicsQueue,
+                               VkDevice device);
     void copyFromBuffer(Buffer& src, Commands& commands, VkQueue graphicsQueue, VkDevice device,
                         uint32_t fullWidth = 0, uint32_t fullHeight = 0);
     void generateMipmaps(Commands& commands, VkQueue graphicsQueue, VkDevice device);
+    void updateRegion(StagingRing& stagingRing, VkCommandBuffer commandBuffer, const void* pixels,
+                      uint32_t x, uint32_t y, uint32_t regionWidth, uint32_t regionHeight,
+                      uint32_t layer = 0, uint32_t mipLevel = 0, bool regenerateMipmaps = false);
     void destroy(VmaAllocator allocator);
+    // Also destroys the views the cache holds of the image.
+    void destroy(VmaAllocator allocator, ImageViewCache& imageViewCache, VkDevice device);
+
+    const VkImage& getImage();
+    VkFormat getFormat();
+    VkImageUsageFlags getUsage();
+    uint32_t getWidth();
+    uint32_t getHeight();
+    uint32_t getMipmapLevels();
+    uint32_t getLayerCount();
+    VkImageAspectFlags getAspectMask();
+    uint32_t getBindlessIndex();
+    // The type of the views createView and getViewInfo make when none is given.
+    void setViewType(VkImageViewType viewType);
+    const ImageAccess& getSubresourceAccess(uint32_t mipLevel, uint32_t layer);
+    void setSubresourceAccess(const ImageAccess& access, uint32_t baseMipLevel = 0,
+                              uint32_t levelCount = VK_REMAINING_MIP_LEVELS,
+                              uint32_t baseArrayLayer = 0,
+                              uint32_t layerCount = VK_REMAINING_ARRAY_LAYERS);
 
   private:
     VkImage image;
     VmaAllocation allocation;
     VkFormat format = VK_FORMAT_R32G32B32_SFLOAT;
+    VkImageUsageFlags usage = 0;
+    VkImageCreateFlags createFlags = 0;
     uint32_t layerCount = 1;
+    VkImageViewType viewType = VK_IMAGE_VIEW_TYPE_2D;
     uint32_t width = 0;
     uint32_t height = 0;
     uint32_t mipmapLevels = 1;
+    BindlessTextureTable* bindlessTable = nullptr;
+    VkImageView bindlessView = VK_NULL_HANDLE;
+    uint32_t bindlessIndex = 0;
+    // Last known state of every subresource, indexed by mipLevel * layerCount + layer.
+    std::vector<ImageAccess> subresourceAccesses = std::vector<ImageAccess>(1);
 
     static Buffer loadImage(const std::string& image, VmaAllocator allocator, int32_t& width,
                             int32_t& height);
-    static uint32_t calcMipmapLevels(int32_t texWidth, int32_t texHeight);
+    static Image createTextureHost(const std::string& image, VmaAllocator allocator,
+                                   VkDevice device, const DeviceExtensions& extensions,
+                                   bool enableMipmaps, uint32_t width, uint32_t height,
+                                   uint32_t layers);
 };
\ No newline at end of file
@@ -0,0 +1,123 @@
+#include "imageViewCache.hpp"
+
+#include <cstring>
+
+VkImageView ImageViewCache::get(VkDevice device, const VkImageViewCreateInfo& viewInfo) {
+    const VkImageViewUsageCreateInfo* usageInfo =
+        static_cast<const VkImageViewUsageCreateInfo*>(viewInfo.pNext);
+    bool onlyUsage = usageInfo == nullptr ||
+                     (usageInfo->sType == VK_STRUCTURE_TYPE_IMAGE_VIEW_USAGE_CREATE_INFO &&
+                      usageInfo->pNext == nullptr);
+
+    if (!onlyUsage || viewInfo.flags != 0) {
+        throw std::invalid_argument("Cached image views can't have flags or extension structures!");
+    }
+
+    Key key = makeKey(viewInfo);
+    auto it = imageViews.find(key);
+
+    if (it != imageViews.end()) {
+        it->second.refCount++;
+        return it->second.imageView;
+    }
+
+    VkImageView imageView;
+
+    if (vkCreateImageView(device, &viewInfo, nullptr, &imageView) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create texture image view!");
+    }
+
+    imageViews[key] = Entry{imageView, 1};
+    imageViewKeys[imageView] = key;
+
+    return imageView;
+}
+
+VkImageView ImageViewCache::get(VkDevice device, Image& image, VkImageAspectFlags aspectFlags) {
+    VkImageViewCreateInfo viewInfo = image.getViewInfo(aspectFlags);
+
+    VkImageViewUsageCreateInfo usageInfo{};
+    usageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_USAGE_CREATE_INFO;
+    usageInfo.usage = image.getViewUsage(viewInfo.format);
+
+    if (usageInfo.usage != 0) {
+        viewInfo.pNext = &usageInfo;
+    }
+
+    return get(device, viewInfo);
+}
+
+void ImageViewCache::release(VkDevice device, VkImageView imageView) {
+    auto keyIt = imageViewKeys.find(imageView);
+
+    if (keyIt == imageViewKeys.end()) {
+        return;
+    }
+
+    auto it = imageViews.find(keyIt->second);
+
+    if (--it->second.refCount == 0) {
+        vkDestroyImageView(device, imageView, nullptr);
+        imageViews.erase(it);
+        imageViewKeys.erase(keyIt);
+    }
+}
+
+void ImageViewCache::releaseImage(VkDevice device, VkImage image) {
+    // Only the image handle at the start of the key has to match.
+    VkImageViewCreateInfo viewInfo{};
+    viewInfo.image = image;
+    Key imageKey = makeKey(viewInfo);
+
+    for (auto it = imageViews.begin(); it != imageViews.end();) {
+        if (it->first[0] != imageKey[0] || it->first[1] != imageKey[1]) {
+            ++it;
+            continue;
+        }
+
+        vkDestroyImageView(device, it->second.imageView, nullptr);
+        imageViewKeys.erase(it->second.imageView);
+        it = imageViews.erase(it);
+    }
+}
+
+void ImageViewCache::destroy(VkDevice device) {
+    for (auto& [key, entry] : imageViews) {
+        vkDestroyImageView(device, entry.imageView, nullptr);
+    }
+
+    imageViews.clear();
+    imageViewKeys.clear();
+}
+
+size_t ImageViewCache::getImageViewCount() { return imageViews.size(); }
+
+ImageViewCache::Key ImageViewCache::makeKey(const VkImageViewCreateInfo& viewInfo) {
+    uint64_t imageHandle = 0;
+    memcpy(&imageHandle, &viewInfo.image, sizeof(VkImage));
+
+    Key key{};
+    key[0] = static_cast<uint32_t>(imageHandle);
+    key[1] = static_cast<uint32_t>(imageHandle >> 32);
+    key[2] = viewInfo.viewType;
+    key[3] = viewInfo.format;
+    key[4] = viewInfo.components.r;
+    key[5] = viewInfo.components.g;
+    key[6] = viewInfo.components.b;
+    key[7] = viewInfo.components.a;
+    key[8] = viewInfo.subresourceRange.aspectMask;
+    key[9] = viewInfo.subresourceRange.baseMipLevel;
+    key[10] = viewInfo.subresourceRange.levelCount;
+    key[11] = viewInfo.subresourceRange.baseArrayLayer;
+    key[12] = viewInfo.subresourceRange.layerCount;
+
+    if (viewInfo.pNext != nullptr) {
+        key[13] = static_cast<const VkImageViewUsageCreateInfo*>(viewInfo.pNext)->usage;
+    }
+
+    return key;
+}
+
+size_t ImageViewCache::KeyHash::operator()(const Key& key) const {
+    return static_cast<size_t>(hashBytes(key.data(), sizeof(Key)));
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <cinttypes>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "hash.hpp"
+#include "image.hpp"
+
+/*
+ * Deduplicates image views by image, view type, format, subresource range and usage, reference
+ * counting them so that every user of the same view shares one VkImageView. The only extension
+ * structure a view may have is a VkImageViewUsageCreateInfo.
+ */
+class ImageViewCache {
+  public:
+    VkImageView get(VkDevice device, const VkImageViewCreateInfo& viewInfo);
+    VkImageView get(VkDevice device, Image& image, VkImageAspectFlags aspectFlags);
+    void release(VkDevice device, VkImageView imageView);
+    // Destroys every view of the image regardless of its references. Has to be called before the
+    // image is destroyed, as a new image may be created with the same handle.
+    void releaseImage(VkDevice device, VkImage image);
+    void destroy(VkDevice device);
+
+    size_t getImageViewCount();
+
+  private:
+    using Key = std::array<uint32_t, 14>;
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+
+    struct Entry {
+        VkImageView imageView;
+        uint32_t refCount;
+    };
+
+    static Key makeKey(const VkImageViewCreateInfo& viewInfo);
+
+    std::unordered_map<Key, Entry, KeyHash> imageViews;
+    std::unordered_map<VkImageView, Key> imageViewKeys;
+};
@@ -0,0 +1,76 @@
+#include "indirectDrawBuffer.hpp"
+
+#include <cstring>
+
+const uint32_t drawCommandStride = sizeof(VkDrawIndexedIndirectCommand);
+
+void IndirectDrawBuffer::create(VmaAllocator allocator, const DeviceExtensions& extensions,
+                                uint32_t maxDraws, uint32_t maxFramesInFlight) {
+    this->maxDraws = maxDraws;
+    firstInstanceSupported = extensions.drawIndirectFirstInstance;
+    buffer = Buffer(allocator,
+                    static_cast<VkDeviceSize>(drawCommandStride) * maxDraws * maxFramesInFlight,
+                    VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                    true);
+}
+
+void IndirectDrawBuffer::beginFrame(uint32_t currentFrame) {
+    frameOffset = static_cast<VkDeviceSize>(drawCommandStride) * maxDraws * currentFrame;
+    drawCountInFrame = 0;
+}
+
+uint32_t IndirectDrawBuffer::add(const VkDrawIndexedIndirectCommand& command) {
+    if (drawCountInFrame >= maxDraws) {
+        throw std::runtime_error("Indirect draw buffer is out of space for this frame!");
+    }
+
+    if (command.firstInstance != 0 && !firstInstanceSupported) {
+        throw std::invalid_argument("Indirect draws with a first instance aren't supported!");
+    }
+
+    uint8_t* dst = static_cast<uint8_t*>(buffer.getMappedData()) + frameOffset +
+                   static_cast<VkDeviceSize>(drawCommandStride) * drawCountInFrame;
+    memcpy(dst, &command, sizeof(VkDrawIndexedIndirectCommand));
+
+    return drawCountInFrame++;
+}
+
+void IndirectDrawBuffer::draw(VkCommandBuffer commandBuffer, const DeviceExtensions& extensions) {
+    if (drawCountInFrame == 0) {
+        return;
+    }
+
+    if (extensions.multiDrawIndirect) {
+        vkCmdDrawIndexedIndirect(commandBuffer, buffer.getBuffer(), frameOffset, drawCountInFrame,
+                                 drawCommandStride);
+        return;
+    }
+
+    // Without multiDrawIndirect each call may only read a single command.
+    for (uint32_t i = 0; i < drawCountInFrame; i++) {
+        vkCmdDrawIndexedIndirect(commandBuffer, buffer.getBuffer(),
+                                 frameOffset + static_cast<VkDeviceSize>(drawCommandStride) * i, 1,
+                                 drawCommandStride);
+    }
+}
+
+void IndirectDrawBuffer::drawCount(VkCommandBuffer commandBuffer,
+                                   const DeviceExtensions& extensions, VkBuffer countBuffer,
+                                   VkDeviceSize countOffset) {
+    if (!extensions.drawIndirectCount) {
+        throw std::runtime_error("Indirect draw counts aren't supported!");
+    }
+
+    vkCmdDrawIndexedIndirectCount(commandBuffer, buffer.getBuffer(), frameOffset, countBuffer,
+                                  countOffset, maxDraws, drawCommandStride);
+}
+
+void IndirectDrawBuffer::destroy(VmaAllocator allocator) { buffer.destroy(allocator); }
+
+const VkBuffer& IndirectDrawBuffer::getBuffer() { return buffer.getBuffer(); }
+
+VkDeviceSize IndirectDrawBuffer::getFrameOffset() { return frameOffset; }
+
+uint32_t IndirectDrawBuffer::getMaxDraws() { return maxDraws; }
+
+uint32_t IndirectDrawBuffer::getDrawCount() { return drawCountInFrame; }
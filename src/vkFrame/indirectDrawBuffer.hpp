@@ -0,0 +1,41 @@
+#pragma once
+
+#include <vk_mem_alloc.h>
+#include <vulkan/vulkan.h>
+
+#include <cinttypes>
+#include <stdexcept>
+
+#include "buffer.hpp"
+#include "deviceExtensions.hpp"
+
+/*
+ * Per-frame lists of indexed draw commands in a persistently mapped buffer. Draws that share
+ * their vertex and index buffers are recorded as one multi-draw-indirect call instead of one
+ * vkCmdDrawIndexed each. The buffer is also a storage buffer, so a compute pass can write the
+ * commands and count itself and the frame can be drawn with drawCount.
+ */
+class IndirectDrawBuffer {
+  public:
+    void create(VmaAllocator allocator, const DeviceExtensions& extensions, uint32_t maxDraws,
+                uint32_t maxFramesInFlight);
+    void beginFrame(uint32_t currentFrame);
+    // Commands with a nonzero firstInstance need drawIndirectFirstInstance.
+    uint32_t add(const VkDrawIndexedIndirectCommand& command);
+    void draw(VkCommandBuffer commandBuffer, const DeviceExtensions& extensions);
+    void drawCount(VkCommandBuffer commandBuffer, const DeviceExtensions& extensions,
+                   VkBuffer countBuffer, VkDeviceSize countOffset);
+    void destroy(VmaAllocator allocator);
+
+    const VkBuffer& getBuffer();
+    VkDeviceSize getFrameOffset();
+    uint32_t getMaxDraws();
+    uint32_t getDrawCount();
+
+  private:
+    Buffer buffer;
+    uint32_t maxDraws = 0;
+    uint32_t drawCountInFrame = 0;
+    bool firstInstanceSupported = false;
+    VkDeviceSize frameOffset = 0;
+};
@@ -0,0 +1,230 @@
+#include "materialSystem.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+void MaterialSystem::create(VkPhysicalDevice physicalDevice, VmaAllocator allocator,
+                            DescriptorLayoutCache& layoutCache,
+                            DescriptorAllocator& descriptorAllocator, uint32_t maxMaterials,
+                            uint32_t maxParameterSize) {
+    if (maxMaterials == 0 || maxMaterials > MaxMaterials) {
+        throw std::invalid_argument("Material count is out of range!");
+    }
+
+    this->layoutCache = &layoutCache;
+    this->descriptorAllocator = &descriptorAllocator;
+    this->maxMaterials = maxMaterials;
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+    // Each slot is the offset of its material's uniform buffer descriptor.
+    parameterSlotSize = Buffer::alignSize(std::max(maxParameterSize, 1u),
+                                          properties.limits.minUniformBufferOffsetAlignment);
+    parameterBuffer = Buffer(allocator, parameterSlotSize * maxMaterials,
+                             VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, true);
+}
+
+VkDescriptorSetLayout MaterialSystem::getSetLayout(VkDevice device, uint32_t textureCount) {
+    std::vector<VkDescriptorSetLayoutBinding> bindings(textureCount + 1);
+
+    bindings[0].binding = 0;
+    bindings[0].descriptorCount = 1;
+    bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    bindings[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    for (uint32_t i = 1; i <= textureCount; i++) {
+        bindings[i].binding = i;
+        bindings[i].descriptorCount = 1;
+        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        bindings[i].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    }
+
+    return layoutCache->get(device, bindings);
+}
+
+uint16_t MaterialSystem::add(VkDevice device, Pipeline& pipeline,
+                             const std::vector<MaterialTexture>& textures,
+                             const void* parameters, uint32_t parameterSize) {
+    if (parameterSize > parameterSlotSize) {
+        throw std::invalid_argument("Material parameters are larger than a parameter slot!");
+    }
+
+    // Materials are bound at SetIndex, so set 0 has to be the pipeline's own descriptor set.
+    if (!pipeline.getDescriptorSetsEnabled()) {
+        throw std::invalid_argument("Material pipelines need their own descriptor set 0!");
+    }
+
+    uint32_t set = acquireSet(device, textures, parameters, parameterSize);
+
+    Key key;
+    appendKey(key, &pipeline);
+    appendKey(key, set);
+
+    auto it = materialIds.find(key);
+
+    if (it != materialIds.end()) {
+        materials[it->second].refCount++;
+        // The material already holds a reference to the set.
+        sets[set].refCount--;
+        return it->second;
+    }
+
+    uint16_t id;
+
+    if (!freeMaterialIds.empty()) {
+        id = freeMaterialIds.back();
+        freeMaterialIds.pop_back();
+    } else if (materials.size() < maxMaterials) {
+        id = static_cast<uint16_t>(materials.size());
+        materials.push_back({});
+    } else {
+        if (--sets[set].refCount == 0) {
+            freeSets[sets[set].layout].push_back(set);
+            setIds.erase(sets[set].key);
+        }
+
+        throw std::runtime_error("Material system is full!");
+    }
+
+    materials[id] = Material{&pipeline, set, 1, key};
+    materialIds[key] = id;
+    materialCount++;
+
+    return id;
+}
+
+void MaterialSystem::release(uint16_t material) {
+    Material& entry = getMaterial(material);
+
+    if (--entry.refCount > 0) {
+        return;
+    }
+
+    // Every material holds one reference to its set, however often it was added.
+    MaterialSet& set = sets[entry.set];
+
+    if (--set.refCount == 0) {
+        freeSets[set.layout].push_back(entry.set);
+        setIds.erase(set.key);
+    }
+
+    materialIds.erase(entry.key);
+    freeMaterialIds.push_back(material);
+    entry = {};
+    materialCount--;
+}
+
+void MaterialSystem::bind(VkCommandBuffer commandBuffer, uint16_t material,
+                          StateTracker* stateTracker) {
+    Material& entry = getMaterial(material);
+    VkDescriptorSet descriptorSet = sets[entry.set].descriptorSet;
+    VkPipelineLayout pipelineLayout = entry.pipeline->getLayout();
+
+    if (stateTracker != nullptr) {
+        stateTracker->bindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                         pipelineLayout, SetIndex, 1, &descriptorSet);
+        return;
+    }
+
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout,
+                            SetIndex, 1, &descriptorSet, 0, nullptr);
+}
+
+void MaterialSystem::destroy(VmaAllocator allocator) {
+    // The sets belong to the descriptor allocator and the layouts to the layout cache.
+    parameterBuffer.destroy(allocator);
+    sets.clear();
+    setIds.clear();
+    freeSets.clear();
+    materials.clear();
+    materialIds.clear();
+    freeMaterialIds.clear();
+    materialCount = 0;
+}
+
+Pipeline& MaterialSystem::getPipeline(uint16_t material) { return *getMaterial(material).pipeline; }
+
+VkDescriptorSet MaterialSystem::getSet(uint16_t material) {
+    return sets[getMaterial(material).set].descriptorSet;
+}
+
+uint32_t MaterialSystem::getMaterialCount() { return materialCount; }
+
+uint32_t MaterialSystem::getSetCount() { return static_cast<uint32_t>(setIds.size()); }
+
+size_t MaterialSystem::KeyHash::operator()(const Key& key) const {
+    return static_cast<size_t>(hashBytes(key.data(), key.size()));
+}
+
+uint32_t MaterialSystem::acquireSet(VkDevice device, const std::vector<MaterialTexture>& textures,
+                                    const void* parameters, uint32_t parameterSize) {
+    VkDescriptorSetLayout layout = getSetLayout(device, static_cast<uint32_t>(textures.size()));
+
+    Key key;
+    appendKey(key, layout);
+
+    for (const MaterialTexture& texture : textures) {
+        appendKey(key, texture.imageView);
+        appendKey(key, texture.sampler);
+    }
+
+    const uint8_t* parameterBytes = static_cast<const uint8_t*>(parameters);
+    key.insert(key.end(), parameterBytes, parameterBytes + parameterSize);
+
+    auto it = setIds.find(key);
+
+    if (it != setIds.end()) {
+        sets[it->second].refCount++;
+        return it->second;
+    }
+
+    uint32_t set;
+    std::vector<uint32_t>& freeLayoutSets = freeSets[layout];
+
+    // A released set of the same layout is rewritten in place, anything else needs a new one.
+    if (!freeLayoutSets.empty()) {
+        set = freeLayoutSets.back();
+        freeLayoutSets.pop_back();
+    } else if (sets.size() < maxMaterials) {
+        set = static_cast<uint32_t>(sets.size());
+        sets.push_back({descriptorAllocator->allocate(device, layout), layout, 0, {}});
+    } else {
+        throw std::runtime_error("Material system is out of descriptor sets!");
+    }
+
+    VkDeviceSize slotOffset = parameterSlotSize * set;
+    uint8_t* slot = static_cast<uint8_t*>(parameterBuffer.getMappedData()) + slotOffset;
+    memset(slot, 0, parameterSlotSize);
+
+    if (parameterSize > 0) {
+        memcpy(slot, parameters, parameterSize);
+    }
+
+    std::vector<DescriptorData> data(textures.size() + 1);
+    data[0].buffer.buffer = parameterBuffer.getBuffer();
+    data[0].buffer.offset = slotOffset;
+    data[0].buffer.range = parameterSlotSize;
+
+    for (size_t i = 0; i < textures.size(); i++) {
+        data[i + 1].image.sampler = textures[i].sampler;
+        data[i + 1].image.imageView = textures[i].imageView;
+        data[i + 1].image.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    }
+
+    layoutCache->update(device, sets[set].descriptorSet, layout, data);
+
+    sets[set].refCount = 1;
+    sets[set].key = key;
+    setIds[key] = set;
+
+    return set;
+}
+
+MaterialSystem::Material& MaterialSystem::getMaterial(uint16_t material) {
+    if (material >= materials.size() || materials[material].refCount == 0) {
+        throw std::invalid_argument("Unknown material!");
+    }
+
+    return materials[material];
+}
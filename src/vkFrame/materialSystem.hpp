@@ -0,0 +1,108 @@
+#pragma once
+
+#include <vk_mem_alloc.h>
+#include <vulkan/vulkan.h>
+
+#include <cinttypes>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include "buffer.hpp"
+#include "descriptorAllocator.hpp"
+#include "descriptorLayoutCache.hpp"
+#include "hash.hpp"
+#include "pipeline.hpp"
+#include "stateTracker.hpp"
+
+struct MaterialTexture {
+    VkImageView imageView;
+    VkSampler sampler;
+};
+
+/*
+ * Materials pair a pipeline with a descriptor set of parameters and textures, bound as set 1:
+ *
+ *     layout(set = 1, binding = 0) uniform Material { ... } material;
+ *     layout(set = 1, binding = 1 + i) uniform sampler2D textures[i];
+ *
+ * Identical materials share one ID, and materials of different pipelines with the same
+ * parameters and textures share one descriptor set. The pipeline needs its own descriptor set
+ * layout as set 0 and has to add the layout from getSetLayout() as its first extra set layout.
+ * Materials are immutable, and a released ID or set is reused by the next new material, so
+ * release only once no frame in flight uses it.
+ */
+class MaterialSystem {
+  public:
+    static const uint32_t SetIndex = 1;
+    static const uint16_t MaxMaterials = UINT16_MAX;
+
+    void create(VkPhysicalDevice physicalDevice, VmaAllocator allocator,
+                DescriptorLayoutCache& layoutCache, DescriptorAllocator& descriptorAllocator,
+                uint32_t maxMaterials, uint32_t maxParameterSize = 256);
+    VkDescriptorSetLayout getSetLayout(VkDevice device, uint32_t textureCount);
+
+    uint16_t add(VkDevice device, Pipeline& pipeline, const std::vector<MaterialTexture>& textures,
+                 const void* parameters = nullptr, uint32_t parameterSize = 0);
+    template <typename T>
+    uint16_t add(VkDevice device, Pipeline& pipeline, const std::vector<MaterialTexture>& textures,
+                 const T& parameters) {
+        return add(device, pipeline, textures, &parameters, static_cast<uint32_t>(sizeof(T)));
+    }
+    void release(uint16_t material);
+    // Binds the material's set, its pipeline has to be bound already.
+    void bind(VkCommandBuffer commandBuffer, uint16_t material,
+              StateTracker* stateTracker = nullptr);
+    void destroy(VmaAllocator allocator);
+
+    Pipeline& getPipeline(uint16_t material);
+    VkDescriptorSet getSet(uint16_t material);
+    uint32_t getMaterialCount();
+    uint32_t getSetCount();
+
+  private:
+    using Key = std::vector<uint8_t>;
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+
+    struct MaterialSet {
+        VkDescriptorSet descriptorSet;
+        VkDescriptorSetLayout layout;
+        uint32_t refCount;
+        Key key;
+    };
+
+    struct Material {
+        Pipeline* pipeline;
+        uint32_t set;
+        uint32_t refCount;
+        Key key;
+    };
+
+    uint32_t acquireSet(VkDevice device, const std::vector<MaterialTexture>& textures,
+                        const void* parameters, uint32_t parameterSize);
+    Material& getMaterial(uint16_t material);
+
+    template <typename T> static void appendKey(Key& key, const T& value) {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+        key.insert(key.end(), bytes, bytes + sizeof(T));
+    }
+
+    DescriptorLayoutCache* layoutCache = nullptr;
+    DescriptorAllocator* descriptorAllocator = nullptr;
+    // One parameter slot per set, indexed like the sets.
+    Buffer parameterBuffer;
+    VkDeviceSize parameterSlotSize = 0;
+    uint32_t maxMaterials = 0;
+
+    std::vector<MaterialSet> sets;
+    std::unordered_map<Key, uint32_t, KeyHash> setIds;
+    std::unordered_map<VkDescriptorSetLayout, std::vector<uint32_t>> freeSets;
+
+    std::vector<Material> materials;
+    std::unordered_map<Key, uint16_t, KeyHash> materialIds;
+    std::vector<uint16_t> freeMaterialIds;
+    uint32_t materialCount = 0;
+};
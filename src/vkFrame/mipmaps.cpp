@@ -0,0 +1,487 @@
+#include "mipmaps.hpp"
+#include "barriers.hpp"
+#include "pipeline.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_IX86)
+#include <xmmintrin.h>
+#define MIPMAPS_USE_SSE
+#endif
+
+struct SrgbTables {
+    float toLinear[256];
+    uint8_t toSrgb[4096];
+};
+
+static const SrgbTables& getSrgbTables() {
+    static const SrgbTables tables = [] {
+        SrgbTables result;
+
+        for (uint32_t i = 0; i < 256; i++) {
+            float c = i / 255.0f;
+            result.toLinear[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+
+        for (uint32_t i = 0; i < 4096; i++) {
+            float c = i / 4095.0f;
+            float srgb = c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+            result.toSrgb[i] = static_cast<uint8_t>(std::clamp(srgb, 0.0f, 1.0f) * 255.0f + 0.5f);
+        }
+
+        return result;
+    }();
+
+    return tables;
+}
+
+static void downsampleLevel(const float* src, uint32_t srcWidth, uint32_t srcHeight, float* dst,
+                            uint32_t dstWidth, uint32_t dstHeight) {
+    for (uint32_t y = 0; y < dstHeight; y++) {
+        const float* row0 = src + std::min(y * 2, srcHeight - 1) * srcWidth * 4;
+        const float* row1 = src + std::min(y * 2 + 1, srcHeight - 1) * srcWidth * 4;
+        float* dstRow = dst + y * dstWidth * 4;
+
+        for (uint32_t x = 0; x < dstWidth; x++) {
+            uint32_t x0 = std::min(x * 2, srcWidth - 1) * 4;
+            uint32_t x1 = std::min(x * 2 + 1, srcWidth - 1) * 4;
+
+#ifdef MIPMAPS_USE_SSE
+            __m128 sum = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(row0 + x0), _mm_loadu_ps(row0 + x1)),
+                                    _mm_add_ps(_mm_loadu_ps(row1 + x0), _mm_loadu_ps(row1 + x1)));
+            _mm_storeu_ps(dstRow + x * 4, _mm_mul_ps(sum, _mm_set1_ps(0.25f)));
+#else
+            for (uint32_t c = 0; c < 4; c++) {
+                dstRow[x * 4 + c] =
+                    0.25f * (row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c]);
+            }
+#endif
+        }
+    }
+}
+
+static void encodeLevel(const float* src, size_t pixelCount, uint8_t* dst, bool srgb,
+                        bool alphaAware) {
+    const SrgbTables& tables = getSrgbTables();
+
+    for (size_t i = 0; i < pixelCount; i++) {
+        float alpha = src[i * 4 + 3];
+        float scale = alphaAware && alpha > 0.0f ? 1.0f / alpha : 1.0f;
+
+        for (uint32_t c = 0; c < 3; c++) {
+            float value = std::clamp(src[i * 4 + c] * scale, 0.0f, 1.0f);
+            dst[i * 4 + c] = srgb ? tables.toSrgb[static_cast<uint32_t>(value * 4095.0f + 0.5f)]
+                                  : static_cast<uint8_t>(value * 255.0f + 0.5f);
+        }
+
+        dst[i * 4 + 3] = static_cast<uint8_t>(std::clamp(alpha, 0.0f, 1.0f) * 255.0f + 0.5f);
+    }
+}
+
+void MipmapGenerator::create(VkPhysicalDevice physicalDevice, VkDevice device,
+                             const std::string& computeShader, bool alphaAware) {
+    this->physicalDevice = physicalDevice;
+    this->alphaAware = alphaAware;
+
+    std::array<VkDescriptorSetLayoutBinding, 2> bindings{};
+
+    for (uint32_t i = 0; i < bindings.size(); i++) {
+        bindings[i].binding = i;
+        bindings[i].descriptorCount = 1;
+        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &descriptorSetLayout) !=
+        VK_SUCCESS) {
+        throw std::runtime_error("Failed to create mipmap descriptor set layout!");
+    }
+
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(PushConstants);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) !=
+        VK_SUCCESS) {
+        throw std::runtime_error("Failed to create mipmap pipeline layout!");
+    }
+
+    VkShaderModule shaderModule =
+        Pipeline::createShaderModule(Pipeline::readFile(computeShader), device);
+
+    VkComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module = shaderModule;
+    pipelineInfo.stage.pName = "main";
+    pipelineInfo.layout = pipelineLayout;
+
+    if (vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr,
+                                 &computePipeline) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create mipmap compute pipeline!");
+    }
+
+    vkDestroyShaderModule(device, shaderModule, nullptr);
+}
+
+MipmapPath MipmapGenerator::choosePath(Image& image) {
+    VkFormat format = image.getFormat();
+
+    if (supportsCompute(format) && (image.getUsage() & VK_IMAGE_USAGE_STORAGE_BIT)) {
+        return MipmapPath::Compute;
+    }
+
+    // Blitting can't weight colors by their alpha, so alpha aware filtering falls back to the CPU.
+    if (supportsBlit(format) && !alphaAware) {
+        return MipmapPath::Blit;
+    }
+
+    return MipmapPath::Cpu;
+}
+
+void MipmapGenerator::generate(Image& image, VmaAllocator allocator, Commands& commands,
+                               VkQueue graphicsQueue, VkDevice device) {
+    if (image.getMipmapLevels() == 1) {
+        image.generateMipmaps(commands, graphicsQueue, device);
+        return;
+    }
+
+    switch (choosePath(image)) {
+    case MipmapPath::Compute:
+        generateCompute(image, commands, graphicsQueue, device);
+        break;
+    case MipmapPath::Blit:
+        image.generateMipmaps(commands, graphicsQueue, device);
+        break;
+    case MipmapPath::Cpu:
+        generateCpu(image, allocator, commands, graphicsQueue, device);
+        break;
+    }
+}
+
+void MipmapGenerator::generateCompute(Image& image, Commands& commands, VkQueue graphicsQueue,
+                                      VkDevice device) {
+    uint32_t levels = image.getMipmapLevels();
+    uint32_t layers = image.getLayerCount();
+    VkFormat storageFormat = getStorageFormat(image.getFormat());
+
+    std::vector<VkImageView> levelViews(levels);
+    for (uint32_t i = 0; i < levels; i++) {
+        levelViews[i] = image.createView(VK_IMAGE_ASPECT_COLOR_BIT, device,
+                                         VK_IMAGE_VIEW_TYPE_2D_ARRAY, storageFormat, i, 1);
+    }
+
+    VkDescriptorPoolSize poolSize{};
+    poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    poolSize.descriptorCount = (levels - 1) * 2;
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    poolInfo.maxSets = levels - 1;
+
+    VkDescriptorPool descriptorPool;
+    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create mipmap descriptor pool!");
+    }
+
+    std::vector<VkDescriptorSetLayout> layouts(levels - 1, descriptorSetLayout);
+    std::vector<VkDescriptorSet> descriptorSets(levels - 1);
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = descriptorPool;
+    allocInfo.descriptorSetCount = levels - 1;
+    allocInfo.pSetLayouts = layouts.data();
+
+    if (vkAllocateDescriptorSets(device, &allocInfo, descriptorSets.data()) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate mipmap descriptor sets!");
+    }
+
+    for (uint32_t i = 1; i < levels; i++) {
+        std::array<VkDescriptorImageInfo, 2> imageInfos{};
+        imageInfos[0].imageView = levelViews[i - 1];
+        imageInfos[0].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+        imageInfos[1].imageView = levelViews[i];
+        imageInfos[1].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+        std::array<VkWriteDescriptorSet, 2> descriptorWrites{};
+        for (uint32_t j = 0; j < descriptorWrites.size(); j++) {
+            descriptorWrites[j].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            descriptorWrites[j].dstSet = descriptorSets[i - 1];
+            descriptorWrites[j].dstBinding = j;
+            descriptorWrites[j].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+            descriptorWrites[j].descriptorCount = 1;
+            descriptorWrites[j].pImageInfo = &imageInfos[j];
+        }
+
+        vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()),
+                               descriptorWrites.data(), 0, nullptr);
+    }
+
+    VkCommandBuffer commandBuffer = commands.beginSingleTime(graphicsQueue, device);
+
+    BarrierBatch barriers;
+    barriers.transition(image, VK_IMAGE_LAYOUT_GENERAL);
+    barriers.flush(commandBuffer);
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, computePipeline);
+
+    PushConstants pushConstants{};
+    pushConstants.srgb = isSrgb(image.getFormat()) ? 1 : 0;
+    pushConstants.alphaAware = alphaAware ? 1 : 0;
+
+    int32_t mipmapWidth = image.getWidth();
+    int32_t mipmapHeight = image.getHeight();
+
+    for (uint32_t i = 1; i < levels; i++) {
+        pushConstants.srcWidth = mipmapWidth;
+        pushConstants.srcHeight = mipmapHeight;
+        pushConstants.dstWidth = mipmapWidth > 1 ? mipmapWidth / 2 : 1;
+        pushConstants.dstHeight = mipmapHeight > 1 ? mipmapHeight / 2 : 1;
+
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0,
+                                1, &descriptorSets[i - 1], 0, nullptr);
+        vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0,
+                           sizeof(PushConstants), &pushConstants);
+        vkCmdDispatch(commandBuffer, (pushConstants.dstWidth + 7) / 8,
+                      (pushConstants.dstHeight + 7) / 8, layers);
+
+        barriers.transition(image, VK_IMAGE_LAYOUT_GENERAL, i, 1);
+        barriers.flush(commandBuffer);
+
+        mipmapWidth = pushConstants.dstWidth;
+        mipmapHeight = pushConstants.dstHeight;
+    }
+
+    barriers.transition(image, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    barriers.flush(commandBuffer);
+
+    commands.endSingleTime(commandBuffer, graphicsQueue, device);
+
+    vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+
+    for (VkImageView levelView : levelViews) {
+        vkDestroyImageView(device, levelView, nullptr);
+    }
+}
+
+void MipmapGenerator::generateCpu(Image& image, VmaAllocator allocator, Commands& commands,
+                                  VkQueue graphicsQueue, VkDevice device) {
+    VkFormat format = image.getFormat();
+
+    if (getStorageFormat(format) == VK_FORMAT_UNDEFINED) {
+        throw std::runtime_error("Unsupported format for CPU mipmap generation!");
+    }
+
+    uint32_t width = image.getWidth();
+    uint32_t height = image.getHeight();
+    uint32_t levels = image.getMipmapLevels();
+    uint32_t layers = image.getLayerCount();
+    VkDeviceSize layerByteSize = static_cast<VkDeviceSize>(width) * height * 4;
+
+    // Read level 0 back, since the pixels it was filled from may not be laid out contiguously.
+    Buffer readbackBuffer(allocator, layerByteSize * layers, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                          true, true);
+
+    VkCommandBuffer commandBuffer = commands.beginSingleTime(graphicsQueue, device);
+
+    BarrierBatch barriers;
+    barriers.transition(image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, 0, 1);
+    barriers.flush(commandBuffer);
+
+    VkBufferImageCopy readbackRegion{};
+    readbackRegion.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    readbackRegion.imageSubresource.mipLevel = 0;
+    readbackRegion.imageSubresource.baseArrayLayer = 0;
+    readbackRegion.imageSubresource.layerCount = layers;
+    readbackRegion.imageExtent = {width, height, 1};
+
+    vkCmdCopyImageToBuffer(commandBuffer, image.getImage(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                           readbackBuffer.getBuffer(), 1, &readbackRegion);
+
+    // The copy has to be made visible to the host, and the memory may not be host coherent.
+    barriers.bufferBarrier(readbackBuffer.getBuffer(), VK_PIPELINE_STAGE_TRANSFER_BIT,
+                           VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+                           VK_ACCESS_HOST_READ_BIT);
+    barriers.flush(commandBuffer);
+
+    commands.endSingleTime(commandBuffer, graphicsQueue, device);
+
+    std::vector<uint8_t> pixels(layerByteSize * layers);
+    readbackBuffer.invalidate(allocator);
+    memcpy(pixels.data(), readbackBuffer.getMappedData(), pixels.size());
+    readbackBuffer.destroy(allocator);
+
+    std::vector<VkDeviceSize> levelOffsets;
+    std::vector<uint8_t> mipChain = downsampleCpu(pixels.data(), width, height, layers, levels,
+                                                  isSrgb(format), alphaAware, levelOffsets);
+
+    Buffer stagingBuffer(allocator, mipChain.size(), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, true);
+    stagingBuffer.setData(mipChain.data());
+
+    std::vector<VkBufferImageCopy> regions;
+    uint32_t mipmapWidth = width;
+    uint32_t mipmapHeight = height;
+
+    for (uint32_t i = 1; i < levels; i++) {
+        mipmapWidth = std::max(mipmapWidth / 2, 1u);
+        mipmapHeight = std::max(mipmapHeight / 2, 1u);
+
+        VkBufferImageCopy region{};
+        region.bufferOffset = levelOffsets[i - 1];
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel = i;
+        region.imageSubresource.baseArrayLayer = 0;
+        region.imageSubresource.layerCount = layers;
+        region.imageExtent = {mipmapWidth, mipmapHeight, 1};
+        regions.push_back(region);
+    }
+
+    commandBuffer = commands.beginSingleTime(graphicsQueue, device);
+
+    vkCmdCopyBufferToImage(commandBuffer, stagingBuffer.getBuffer(), image.getImage(),
+                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           static_cast<uint32_t>(regions.size()), regions.data());
+
+    barriers.transition(image, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    barriers.flush(commandBuffer);
+
+    commands.endSingleTime(commandBuffer, graphicsQueue, device);
+
+    stagingBuffer.destroy(allocator);
+}
+
+std::vector<uint8_t> MipmapGenerator::downsampleCpu(const uint8_t* pixels, uint32_t width,
+                                                    uint32_t height, uint32_t layers,
+                                                    uint32_t levels, bool srgb, bool alphaAware,
+                                                    std::vector<VkDeviceSize>& levelOffsets) {
+    const SrgbTables& tables = getSrgbTables();
+    size_t pixelCount = static_cast<size_t>(width) * height;
+
+    // Filter in linear space, premultiplied by alpha if requested, so that every level is built
+    // from the full precision level before it rather than from a requantized one.
+    std::vector<float> srcLevel(pixelCount * layers * 4);
+    for (size_t i = 0; i < pixelCount * layers; i++) {
+        float alpha = pixels[i * 4 + 3] / 255.0f;
+        float scale = alphaAware ? alpha : 1.0f;
+
+        for (uint32_t c = 0; c < 3; c++) {
+            uint8_t value = pixels[i * 4 + c];
+            srcLevel[i * 4 + c] = (srgb ? tables.toLinear[value] : value / 255.0f) * scale;
+        }
+
+        srcLevel[i * 4 + 3] = alpha;
+    }
+
+    std::vector<uint8_t> mipChain;
+    std::vector<float> dstLevel;
+    levelOffsets.clear();
+
+    uint32_t srcWidth = width;
+    uint32_t srcHeight = height;
+
+    for (uint32_t i = 1; i < levels; i++) {
+        uint32_t dstWidth = std::max(srcWidth / 2, 1u);
+        uint32_t dstHeight = std::max(srcHeight / 2, 1u);
+        size_t srcLayerSize = static_cast<size_t>(srcWidth) * srcHeight * 4;
+        size_t dstLayerSize = static_cast<size_t>(dstWidth) * dstHeight * 4;
+
+        dstLevel.resize(dstLayerSize * layers);
+        for (uint32_t layer = 0; layer < layers; layer++) {
+            downsampleLevel(srcLevel.data() + srcLayerSize * layer, srcWidth, srcHeight,
+                            dstLevel.data() + dstLayerSize * layer, dstWidth, dstHeight);
+        }
+
+        levelOffsets.push_back(mipChain.size());
+        mipChain.resize(mipChain.size() + dstLayerSize * layers);
+        encodeLevel(dstLevel.data(), dstLayerSize / 4 * layers,
+                    mipChain.data() + levelOffsets.back(), srgb, alphaAware);
+
+        std::swap(srcLevel, dstLevel);
+        srcWidth = dstWidth;
+        srcHeight = dstHeight;
+    }
+
+    return mipChain;
+}
+
+VkImageUsageFlags MipmapGenerator::getRequiredUsage(VkFormat format) {
+    return supportsCompute(format) ? VK_IMAGE_USAGE_STORAGE_BIT : 0;
+}
+
+VkImageCreateFlags MipmapGenerator::getRequiredFlags(VkFormat format) {
+    // sRGB formats can't be used as storage images, so they are written through a UNORM view.
+    return supportsCompute(format) && getStorageFormat(format) != format
+               ? VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT | VK_IMAGE_CREATE_EXTENDED_USAGE_BIT
+               : 0;
+}
+
+bool MipmapGenerator::supportsCompute(VkFormat format) {
+    if (computePipeline == VK_NULL_HANDLE) {
+        return false;
+    }
+
+    VkFormat storageFormat = getStorageFormat(format);
+
+    if (storageFormat != VK_FORMAT_R8G8B8A8_UNORM) {
+        return false;
+    }
+
+    VkFormatProperties props;
+    vkGetPhysicalDeviceFormatProperties(physicalDevice, storageFormat, &props);
+
+    return props.optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT;
+}
+
+bool MipmapGenerator::supportsBlit(VkFormat format) {
+    VkFormatProperties props;
+    vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &props);
+
+    VkFormatFeatureFlags required = VK_FORMAT_FEATURE_BLIT_SRC_BIT |
+                                    VK_FORMAT_FEATURE_BLIT_DST_BIT |
+                                    VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+
+    return (props.optimalTilingFeatures & required) == required;
+}
+
+bool MipmapGenerator::isSrgb(VkFormat format) {
+    return format == VK_FORMAT_R8G8B8A8_SRGB || format == VK_FORMAT_B8G8R8A8_SRGB;
+}
+
+VkFormat MipmapGenerator::getStorageFormat(VkFormat format) {
+    switch (format) {
+    case VK_FORMAT_R8G8B8A8_UNORM:
+    case VK_FORMAT_R8G8B8A8_SRGB:
+        return VK_FORMAT_R8G8B8A8_UNORM;
+    case VK_FORMAT_B8G8R8A8_UNORM:
+    case VK_FORMAT_B8G8R8A8_SRGB:
+        return VK_FORMAT_B8G8R8A8_UNORM;
+    default:
+        return VK_FORMAT_UNDEFINED;
+    }
+}
+
+void MipmapGenerator::destroy(VkDevice device) {
+    vkDestroyPipeline(device, computePipeline, nullptr);
+    vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+    vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <vk_mem_alloc.h>
+#include <vulkan/vulkan.h>
+
+#include <cinttypes>
+#include <string>
+#include <vector>
+
+#include "buffer.hpp"
+#include "commands.hpp"
+#include "image.hpp"
+
+enum class MipmapPath {
+    Compute,
+    Blit,
+    Cpu,
+};
+
+/*
+ * Generates mipmap chains with a downsampling compute shader, falling back to vkCmdBlitImage
+ * and then to the CPU depending on what the image's format supports. Expects every level of the
+ * image to be in VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL with level 0 filled, and leaves every level
+ * in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL.
+ */
+class MipmapGenerator {
+  public:
+    void create(VkPhysicalDevice physicalDevice, VkDevice device, const std::string& computeShader,
+                bool alphaAware = false);
+    void generate(Image& image, VmaAllocator allocator, Commands& commands, VkQueue graphicsQueue,
+                  VkDevice device);
+    MipmapPath choosePath(Image& image);
+    VkImageUsageFlags getRequiredUsage(VkFormat format);
+    VkImageCreateFlags getRequiredFlags(VkFormat format);
+    void destroy(VkDevice device);
+
+    static std::vector<uint8_t> downsampleCpu(const uint8_t* pixels, uint32_t width,
+                                              uint32_t height, uint32_t layers, uint32_t levels,
+                                              bool srgb, bool alphaAware,
+                                              std::vector<VkDeviceSize>& levelOffsets);
+    static bool isSrgb(VkFormat format);
+
+  private:
+    struct PushConstants {
+        int32_t srcWidth;
+        int32_t srcHeight;
+        int32_t dstWidth;
+        int32_t dstHeight;
+        uint32_t srgb;
+        uint32_t alphaAware;
+    };
+
+    void generateCompute(Image& image, Commands& commands, VkQueue graphicsQueue, VkDevice device);
+    void generateCpu(Image& image, VmaAllocator allocator, Commands& commands,
+                     VkQueue graphicsQueue, VkDevice device);
+    bool supportsCompute(VkFormat format);
+    bool supportsBlit(VkFormat format);
+
+    static VkFormat getStorageFormat(VkFormat format);
+
+    VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+    VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
+    VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+    VkPipeline computePipeline = VK_NULL_HANDLE;
+    bool alphaAware = false;
+};
@@ -1,7 +1,13 @@
 #pragma once
 
+#include <algorithm>
 #include <cinttypes>
 
+#include "deviceExtensions.hpp"
+#include "geometryPool.hpp"
+#include "indirectDrawBuffer.hpp"
+#include "stateTracker.hpp"
+
 template <typename V, typename I, typename D> class Model {
   public:
     static Model<V, I, D> fromVerticesAndIndices(const std::vector<V>& vertices,
@@ -20,6 +26,23 @@ template <typename V, typename I, typename D> class Model {
         return model;
     }
 
+    // The model's geometry is suballocated from the pool, which must be bound with
+    // GeometryPool::bind before drawing it.
+    static Model<V, I, D> fromGeometryPool(GeometryPool& geometryPool,
+                                           const std::vector<V>& vertices,
+                                           const std::vector<I>& indices,
+                                           const size_t maxInstances, VmaAllocator allocator,
+                                           Commands& commands, VkQueue graphicsQueue,
+                                           VkDevice device) {
+        Model model = create(maxInstances, allocator, commands, graphicsQueue, device);
+        model.size = indices.size();
+        model.geometryPool = &geometryPool;
+        model.geometry =
+            geometryPool.add(allocator, commands, graphicsQueue, device, vertices, indices);
+
+        return model;
+    }
+
     static Model<V, I, D> create(const size_t maxInstances, VmaAllocator allocator, Commands& commands,
           VkQueue graphicsQueue, VkDevice device) {
         Model model;
@@ -34,23 +57,88 @@ template <typename V, typename I, typename D> class Model {
         return model;
     };
 
-    void draw(VkCommandBuffer commandBuffer) {
-        if (vertexBuffer.getSize() == 0 || instanceBuffer.getSize() == 0 || indexBuffer.getSize() == 0)
+    void draw(VkCommandBuffer commandBuffer, StateTracker* stateTracker = nullptr) {
+        if (!isDrawable())
             return;
 
-        if (instanceCount < 1)
+        bindBuffers(commandBuffer, stateTracker);
+
+        VkDrawIndexedIndirectCommand command = getDrawCommand();
+        vkCmdDrawIndexed(commandBuffer, command.indexCount, command.instanceCount,
+                         command.firstIndex, command.vertexOffset, command.firstInstance);
+    }
+
+    // Binds the model's buffers and draws every command recorded in the indirect buffer this
+    // frame, which must all index into this model's buffers, in one call.
+    void drawIndirect(VkCommandBuffer commandBuffer, IndirectDrawBuffer& indirectDrawBuffer,
+                      const DeviceExtensions& extensions, StateTracker* stateTracker = nullptr) {
+        if (!isDrawable())
             return;
 
+        bindBuffers(commandBuffer, stateTracker);
+        indirectDrawBuffer.draw(commandBuffer, extensions);
+    }
+
+    // A draw of instanceCount instances starting at firstInstance, defaults to all instances.
+    VkDrawIndexedIndirectCommand getDrawCommand(uint32_t firstInstance = 0,
+                                                uint32_t instanceCount = UINT32_MAX) {
+        uint32_t availableInstances = 0;
+
+        if (firstInstance < this->instanceCount)
+            availableInstances = static_cast<uint32_t>(this->instanceCount) - firstInstance;
+
+        if (geometryPool != nullptr) {
+            return geometryPool->getDrawCommand(
+                geometry, std::min(instanceCount, availableInstances), firstInstance);
+        }
+
+        VkDrawIndexedIndirectCommand command{};
+        command.indexCount = static_cast<uint32_t>(size);
+        command.instanceCount = std::min(instanceCount, availableInstances);
+        command.firstIndex = 0;
+        command.vertexOffset = 0;
+        command.firstInstance = firstInstance;
+
+        return command;
+    }
+
+    // Pooled models only bind their instances, the pool's geometry stays bound across models.
+    void bindBuffers(VkCommandBuffer commandBuffer, StateTracker* stateTracker = nullptr) {
+        VkDeviceSize offsets[] = {0, 0};
+
+        if (geometryPool != nullptr) {
+            if (stateTracker != nullptr) {
+                stateTracker->bindVertexBuffers(commandBuffer, 1, 1, &instanceBuffer.getBuffer(),
+                                                offsets);
+            } else {
+                vkCmdBindVertexBuffers(commandBuffer, 1, 1, &instanceBuffer.getBuffer(), offsets);
+            }
+
+            return;
+        }
+
         VkIndexType indexType = VK_INDEX_TYPE_UINT16;
 
         if (sizeof(I) == 4)
             indexType = VK_INDEX_TYPE_UINT32;
 
-        VkDeviceSize offsets[] = {0};
-        vkCmdBindVertexBuffers(commandBuffer, 0, 1, &vertexBuffer.getBuffer(), offsets);
-        vkCmdBindVertexBuffers(commandBuffer, 1, 1, &instanceBuffer.getBuffer(), offsets);
+        VkBuffer vertexBuffers[] = {vertexBuffer.getBuffer(), instanceBuffer.getBuffer()};
+
+        if (stateTracker != nullptr) {
+            stateTracker->bindVertexBuffers(commandBuffer, 0, 2, vertexBuffers, offsets);
+            stateTracker->bindIndexBuffer(commandBuffer, indexBuffer.getBuffer(), 0, indexType);
+            return;
+        }
+
+        vkCmdBindVertexBuffers(commandBuffer, 0, 2, vertexBuffers, offsets);
         vkCmdBindIndexBuffer(commandBuffer, indexBuffer.getBuffer(), 0, indexType);
-        vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(size), static_cast<uint32_t>(instanceCount), 0, 0, 0);
+    }
+
+    bool isDrawable() {
+        bool hasGeometry = geometryPool != nullptr ||
+                           (vertexBuffer.getSize() != 0 && indexBuffer.getSize() != 0);
+
+        return hasGeometry && instanceBuffer.getSize() != 0 && instanceCount > 0;
     }
 
     void update(const std::vector<V>& vertices, const std::vector<I>& indices,
@@ -60,6 +148,13 @@ template <typename V, typename I, typename D> class Model {
 
         vkDeviceWaitIdle(device);
 
+        if (geometryPool != nullptr) {
+            geometryPool->remove(geometry);
+            geometry =
+                geometryPool->add(allocator, commands, graphicsQueue, device, vertices, indices);
+            return;
+        }
+
         indexBuffer.destroy(allocator);
         vertexBuffer.destroy(allocator);
 
@@ -75,6 +170,11 @@ template <typename V, typename I, typename D> class Model {
     }
 
     void destroy(VmaAllocator allocator) {
+        if (geometryPool != nullptr) {
+            geometryPool->remove(geometry);
+            geometryPool = nullptr;
+        }
+
         vertexBuffer.destroy(allocator);
         indexBuffer.destroy(allocator);
         instanceStagingBuffer.destroy(allocator);
@@ -86,6 +186,8 @@ template <typename V, typename I, typename D> class Model {
     Buffer indexBuffer;
     Buffer instanceBuffer;
     Buffer instanceStagingBuffer;
+    GeometryPool* geometryPool = nullptr;
+    uint32_t geometry = 0;
     size_t size = 0;
     size_t instanceCount = 0;
 };
\ No newline at end of file
@@ -0,0 +1,208 @@
+#include "occlusionCuller.hpp"
+
+#include <array>
+#include <cstring>
+
+void OcclusionCuller::create(VkPhysicalDevice physicalDevice, VkDevice device,
+                             VmaAllocator allocator, const DeviceExtensions& extensions,
+                             const std::string& cullShader, const std::string& pyramidShader,
+                             RenderPass& renderPass, VkExtent2D extent, uint32_t maxInstances,
+                             uint32_t maxFramesInFlight) {
+    // The late draw starts where the early one ends in the shared list of visible instances.
+    if (!extensions.drawIndirectFirstInstance) {
+        throw std::runtime_error("Occlusion culling requires drawIndirectFirstInstance!");
+    }
+
+    buffers.create(physicalDevice, allocator, maxInstances, 2, maxFramesInFlight);
+    visibilityBuffer = Buffer(allocator, sizeof(uint32_t) * maxInstances,
+                              VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                              false);
+
+    pyramid.create(device, allocator, pyramidShader, renderPass, extent);
+
+    pipeline.createDescriptorSetLayout(
+        device, [](std::vector<VkDescriptorSetLayoutBinding>& bindings) {
+            for (uint32_t i = 0; i < 5; i++) {
+                VkDescriptorSetLayoutBinding binding{};
+                binding.binding = i;
+                binding.descriptorCount = 1;
+                binding.descriptorType = i < 4 ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
+                                               : VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+                binding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+                bindings.push_back(binding);
+            }
+        });
+    pipeline.createDescriptorPool(
+        maxFramesInFlight, device, [=](std::vector<VkDescriptorPoolSize>& poolSizes) {
+            VkDescriptorPoolSize bufferPoolSize{};
+            bufferPoolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            bufferPoolSize.descriptorCount = 4 * maxFramesInFlight;
+            poolSizes.push_back(bufferPoolSize);
+
+            VkDescriptorPoolSize pyramidPoolSize{};
+            pyramidPoolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            pyramidPoolSize.descriptorCount = maxFramesInFlight;
+            poolSizes.push_back(pyramidPoolSize);
+        });
+    pipeline.createDescriptorSets(
+        maxFramesInFlight, device,
+        [this, device](std::vector<VkWriteDescriptorSet>& descriptorWrites,
+                       VkDescriptorSet descriptorSet, uint32_t i) {
+            std::array<VkDescriptorBufferInfo, 4> bufferInfos{};
+            bufferInfos[0].buffer = buffers.getBoundsBuffer();
+            bufferInfos[0].offset = 0;
+            bufferInfos[0].range = VK_WHOLE_SIZE;
+            bufferInfos[1].buffer = visibilityBuffer.getBuffer();
+            bufferInfos[1].offset = 0;
+            bufferInfos[1].range = VK_WHOLE_SIZE;
+            bufferInfos[2].buffer = buffers.getVisibleInstanceBuffer();
+            bufferInfos[2].offset = getVisibleInstanceOffset(i);
+            bufferInfos[2].range = buffers.getVisibleInstanceRange();
+            bufferInfos[3].buffer = buffers.getDrawCommandBuffer();
+            bufferInfos[3].offset = getDrawCommandOffset(i, OcclusionPhase::Early);
+            bufferInfos[3].range = sizeof(VkDrawIndexedIndirectCommand) * 2;
+
+            VkDescriptorImageInfo pyramidInfo{};
+            pyramidInfo.sampler = pyramid.getSampler();
+            pyramidInfo.imageView = pyramid.getView();
+            pyramidInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+            descriptorWrites.resize(bufferInfos.size() + 1);
+
+            for (uint32_t binding = 0; binding < descriptorWrites.size(); binding++) {
+                descriptorWrites[binding].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                descriptorWrites[binding].dstSet = descriptorSet;
+                descriptorWrites[binding].dstBinding = binding;
+                descriptorWrites[binding].dstArrayElement = 0;
+                descriptorWrites[binding].descriptorCount = 1;
+
+                if (binding < bufferInfos.size()) {
+                    descriptorWrites[binding].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                    descriptorWrites[binding].pBufferInfo = &bufferInfos[binding];
+                } else {
+                    descriptorWrites[binding].descriptorType =
+                        VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+                    descriptorWrites[binding].pImageInfo = &pyramidInfo;
+                }
+            }
+
+            vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()),
+                                   descriptorWrites.data(), 0, nullptr);
+        });
+    pipeline.addPushConstantRange<PushConstants>();
+    pipeline.create(cullShader, device, 64);
+}
+
+void OcclusionCuller::recreate(VkDevice device, VmaAllocator allocator, RenderPass& renderPass,
+                               VkExtent2D extent, uint32_t maxFramesInFlight) {
+    pyramid.recreate(device, allocator, renderPass, extent);
+    pipeline.recreate(device, maxFramesInFlight);
+}
+
+void OcclusionCuller::updateBounds(const std::vector<glm::vec4>& spheres, VmaAllocator allocator,
+                                   Commands& commands, VkQueue graphicsQueue, VkDevice device) {
+    buffers.updateBounds(spheres, allocator, commands, graphicsQueue, device,
+                         [this](VkCommandBuffer commandBuffer) {
+                             vkCmdFillBuffer(commandBuffer, visibilityBuffer.getBuffer(), 0,
+                                             VK_WHOLE_SIZE, 0);
+                         });
+}
+
+void OcclusionCuller::cullEarly(VkCommandBuffer commandBuffer, uint32_t currentFrame,
+                                const glm::mat4& viewProjection,
+                                const VkDrawIndexedIndirectCommand& drawCommand) {
+    std::array<VkDrawIndexedIndirectCommand, 2> resetCommands = {drawCommand, drawCommand};
+
+    for (VkDrawIndexedIndirectCommand& resetCommand : resetCommands) {
+        resetCommand.instanceCount = 0;
+        resetCommand.firstInstance = 0;
+    }
+
+    vkCmdUpdateBuffer(commandBuffer, buffers.getDrawCommandBuffer(),
+                      getDrawCommandOffset(currentFrame, OcclusionPhase::Early),
+                      sizeof(resetCommands), resetCommands.data());
+
+    // The flags were last written by the late phase of the previous frame, which isn't
+    // necessarily behind this frame's fence.
+    BarrierBatch barriers;
+    barriers.bufferBarrier(buffers.getDrawCommandBuffer(), VK_PIPELINE_STAGE_TRANSFER_BIT,
+                           VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                           VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+                           getDrawCommandOffset(currentFrame, OcclusionPhase::Early),
+                           buffers.getDrawCommandRange());
+    barriers.bufferBarrier(visibilityBuffer.getBuffer(), VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                           VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                           VK_ACCESS_SHADER_READ_BIT);
+    barriers.flush(commandBuffer);
+
+    dispatch(commandBuffer, currentFrame, viewProjection, OcclusionPhase::Early);
+}
+
+void OcclusionCuller::cullLate(VkCommandBuffer commandBuffer, uint32_t currentFrame,
+                               const glm::mat4& viewProjection, RenderPass& renderPass) {
+    pyramid.build(commandBuffer, renderPass);
+    dispatch(commandBuffer, currentFrame, viewProjection, OcclusionPhase::Late);
+}
+
+void OcclusionCuller::dispatch(VkCommandBuffer commandBuffer, uint32_t currentFrame,
+                               const glm::mat4& viewProjection, OcclusionPhase phase) {
+    PushConstants pushConstants{};
+    pushConstants.viewProjection = viewProjection;
+    pushConstants.pyramidSize = glm::vec2(pyramid.getWidth(), pyramid.getHeight());
+    pushConstants.instanceCount = buffers.getInstanceCount();
+    pushConstants.phase = static_cast<uint32_t>(phase);
+
+    pipeline.bind(commandBuffer, currentFrame);
+    pipeline.pushConstants(commandBuffer, pushConstants);
+    pipeline.dispatchThreads(commandBuffer, buffers.getInstanceCount());
+
+    // The late phase reads the early draw's count, and overwrites the flags the early phase read.
+    BarrierBatch barriers;
+    ComputePipeline::addWriteBarrier(
+        barriers, buffers.getDrawCommandBuffer(),
+        VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT |
+            VK_ACCESS_SHADER_WRITE_BIT,
+        getDrawCommandOffset(currentFrame, OcclusionPhase::Early), buffers.getDrawCommandRange());
+    ComputePipeline::addWriteBarrier(
+        barriers, buffers.getVisibleInstanceBuffer(),
+        VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+        getVisibleInstanceOffset(currentFrame), buffers.getVisibleInstanceRange());
+    barriers.flush(commandBuffer);
+}
+
+void OcclusionCuller::draw(VkCommandBuffer commandBuffer, uint32_t currentFrame,
+                           OcclusionPhase phase) {
+    vkCmdDrawIndexedIndirect(commandBuffer, buffers.getDrawCommandBuffer(),
+                             getDrawCommandOffset(currentFrame, phase), 1,
+                             sizeof(VkDrawIndexedIndirectCommand));
+}
+
+void OcclusionCuller::destroy(VkDevice device, VmaAllocator allocator) {
+    pipeline.cleanup(device);
+    pyramid.destroy(device, allocator);
+    buffers.destroy(allocator);
+    visibilityBuffer.destroy(allocator);
+}
+
+const VkBuffer& OcclusionCuller::getVisibleInstanceBuffer() {
+    return buffers.getVisibleInstanceBuffer();
+}
+
+VkDeviceSize OcclusionCuller::getVisibleInstanceOffset(uint32_t currentFrame) {
+    return buffers.getVisibleInstanceOffset(currentFrame);
+}
+
+VkDeviceSize OcclusionCuller::getVisibleInstanceRange() {
+    return buffers.getVisibleInstanceRange();
+}
+
+const VkBuffer& OcclusionCuller::getDrawCommandBuffer() { return buffers.getDrawCommandBuffer(); }
+
+VkDeviceSize OcclusionCuller::getDrawCommandOffset(uint32_t currentFrame, OcclusionPhase phase) {
+    return buffers.getDrawCommandOffset(currentFrame) +
+           sizeof(VkDrawIndexedIndirectCommand) * static_cast<uint32_t>(phase);
+}
+
+HiZPyramid& OcclusionCuller::getPyramid() { return pyramid; }
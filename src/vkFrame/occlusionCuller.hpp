@@ -0,0 +1,83 @@
+#pragma once
+
+#include <vk_mem_alloc.h>
+#include <vulkan/vulkan.h>
+
+#include <glm/glm.hpp>
+
+#include <cinttypes>
+#include <string>
+#include <vector>
+
+#include "buffer.hpp"
+#include "commands.hpp"
+#include "computePipeline.hpp"
+#include "cullingCommon.hpp"
+#include "deviceExtensions.hpp"
+#include "hiZPyramid.hpp"
+#include "renderPass.hpp"
+
+enum class OcclusionPhase {
+    Early,
+    Late,
+};
+
+/*
+ * Culls the instances of one instanced draw against the frustum and a depth pyramid in two
+ * phases, so instances that become visible are drawn in the frame they appear in:
+ *
+ *     cullEarly(), begin the render pass, draw(Early), end it,
+ *     cullLate(), resume the render pass, draw(Late), end it.
+ *
+ * The early phase draws whatever was visible last frame. Its depth is reduced into the pyramid,
+ * against which the late phase tests every instance, draws the ones the early phase missed and
+ * remembers which were visible for the next frame. The render pass has to be created with
+ * stored depth. As with FrustumCuller, the vertex shader looks up
+ * visibleInstances[gl_InstanceIndex] and reads the instance's data from a storage buffer.
+ */
+class OcclusionCuller {
+  public:
+    void create(VkPhysicalDevice physicalDevice, VkDevice device, VmaAllocator allocator,
+                const DeviceExtensions& extensions, const std::string& cullShader,
+                const std::string& pyramidShader, RenderPass& renderPass, VkExtent2D extent,
+                uint32_t maxInstances, uint32_t maxFramesInFlight);
+    // Has to follow every recreation of the render pass.
+    void recreate(VkDevice device, VmaAllocator allocator, RenderPass& renderPass,
+                  VkExtent2D extent, uint32_t maxFramesInFlight);
+    // Bounding spheres of the instances, center in xyz and radius in w. Forgets which instances
+    // were visible, so the next frame draws everything in its late phase.
+    void updateBounds(const std::vector<glm::vec4>& spheres, VmaAllocator allocator,
+                      Commands& commands, VkQueue graphicsQueue, VkDevice device);
+    // Both must be recorded outside of a render pass.
+    void cullEarly(VkCommandBuffer commandBuffer, uint32_t currentFrame,
+                   const glm::mat4& viewProjection,
+                   const VkDrawIndexedIndirectCommand& drawCommand);
+    void cullLate(VkCommandBuffer commandBuffer, uint32_t currentFrame,
+                  const glm::mat4& viewProjection, RenderPass& renderPass);
+    void draw(VkCommandBuffer commandBuffer, uint32_t currentFrame, OcclusionPhase phase);
+    void destroy(VkDevice device, VmaAllocator allocator);
+
+    const VkBuffer& getVisibleInstanceBuffer();
+    VkDeviceSize getVisibleInstanceOffset(uint32_t currentFrame);
+    VkDeviceSize getVisibleInstanceRange();
+    const VkBuffer& getDrawCommandBuffer();
+    VkDeviceSize getDrawCommandOffset(uint32_t currentFrame, OcclusionPhase phase);
+    HiZPyramid& getPyramid();
+
+  private:
+    struct PushConstants {
+        glm::mat4 viewProjection;
+        glm::vec2 pyramidSize;
+        uint32_t instanceCount;
+        uint32_t phase;
+    };
+
+    void dispatch(VkCommandBuffer commandBuffer, uint32_t currentFrame,
+                  const glm::mat4& viewProjection, OcclusionPhase phase);
+
+    ComputePipeline pipeline;
+    HiZPyramid pyramid;
+    CullingBuffers buffers;
+    // One flag per instance, written by the late phase and read by the next early phase.
+    Buffer visibilityBuffer;
+};
@@ -1,71 +1,299 @@
 #include "pipeline.hpp"
 
+#include <chrono>
+
 void Pipeline::createDescriptorSetLayout(
     VkDevice device,
-    std::function<void(std::vector<VkDescriptorSetLayoutBinding>&)> setupBindings) {
-    this->setupBindings = setupBindings;
+    std::function<void(std::vector<VkDescriptorSetLayoutBinding>&)> setupBindings,
+    DescriptorLayoutCache* layoutCache) {
+    descriptors.createLayout(device, setupBindings, layoutCache);
+}
 
-    std::vector<VkDescriptorSetLayoutBinding> bindings;
-    setupBindings(bindings);
+void Pipeline::createPushDescriptorSetLayout(
+    VkDevice device, const DeviceExtensions& extensions,
+    std::function<void(std::vector<VkDescriptorSetLayoutBinding>&)> setupBindings) {
+    if (!extensions.pushDescriptor) {
+        throw std::runtime_error("Push descriptors aren't supported!");
+    }
 
-    VkDescriptorSetLayoutCreateInfo layoutInfo{};
-    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
-    layoutInfo.pBindings = bindings.data();
+    cmdPushDescriptorSet = extensions.cmdPushDescriptorSet;
 
-    if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &descriptorSetLayout) !=
-        VK_SUCCESS) {
-        throw std::runtime_error("Failed to create descriptor set layout!");
-    }
+    descriptors.createLayout(device, setupBindings, nullptr,
+                             VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR);
 }
 
 void Pipeline::createDescriptorPool(
     const uint32_t maxFramesInFlight, VkDevice device,
     std::function<void(std::vector<VkDescriptorPoolSize>& poolSizes)> setupPool) {
-    this->setupPool = setupPool;
-
-    std::vector<VkDescriptorPoolSize> poolSizes;
-    setupPool(poolSizes);
-
-    VkDescriptorPoolCreateInfo poolInfo{};
-    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
-    poolInfo.pPoolSizes = poolSizes.data();
-    poolInfo.maxSets = static_cast<uint32_t>(maxFramesInFlight);
-
-    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
-        throw std::runtime_error("Failed to create descriptor pool!");
-    }
+    descriptors.createPool(maxFramesInFlight, device, setupPool);
 }
 
 void Pipeline::createDescriptorSets(
     const uint32_t maxFramesInFlight, VkDevice device,
     std::function<void(std::vector<VkWriteDescriptorSet>&, VkDescriptorSet, uint32_t)>
         setupDescriptor) {
-    this->setupDescriptor = setupDescriptor;
+    descriptors.createSets(maxFramesInFlight, device, setupDescriptor);
+}
+
+void Pipeline::createDescriptorSets(
+    const uint32_t maxFramesInFlight, VkDevice device, DescriptorAllocator& allocator,
+    std::function<void(std::vector<VkWriteDescriptorSet>&, VkDescriptorSet, uint32_t)>
+        setupDescriptor) {
+    descriptors.createSets(maxFramesInFlight, device, allocator, setupDescriptor);
+}
 
-    std::vector<VkDescriptorSetLayout> layouts(maxFramesInFlight, descriptorSetLayout);
-    VkDescriptorSetAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-    allocInfo.descriptorPool = descriptorPool;
-    allocInfo.descriptorSetCount = static_cast<uint32_t>(maxFramesInFlight);
-    allocInfo.pSetLayouts = layouts.data();
+void Pipeline::addSetLayout(VkDescriptorSetLayout setLayout) {
+    extraSetLayouts.push_back(setLayout);
+}
 
-    descriptorSets.resize(maxFramesInFlight);
-    if (vkAllocateDescriptorSets(device, &allocInfo, descriptorSets.data()) != VK_SUCCESS) {
-        throw std::runtime_error("Failed to allocate descriptor sets!");
+void Pipeline::setupPipeline(const std::string& vertShader, const std::string& fragShader,
+                             VkDevice device, bool enableTransparency,
+                             const VkPipelineRasterizationStateCreateInfo& rasterizer) {
+    this->fragShader = fragShader;
+    this->vertShader = vertShader;
+    this->transparencyEnabled = enableTransparency;
+    this->rasterizerState = rasterizer;
+
+    if (pipelineCache != nullptr && !descriptors.isLayoutCached()) {
+        throw std::invalid_argument("Cached pipelines need a cached descriptor set layout!");
     }
 
-    for (uint32_t i = 0; i < maxFramesInFlight; i++) {
-        std::vector<VkWriteDescriptorSet> descriptorWrites;
-        setupDescriptor(descriptorWrites, descriptorSets[i], i);
+    std::vector<VkDescriptorSetLayout> setLayouts = {descriptors.getLayout()};
+    setLayouts.insert(setLayouts.end(), extraSetLayouts.begin(), extraSetLayouts.end());
+
+    if (pipelineCache != nullptr) {
+        pipelineLayout = pipelineCache->getLayout(device, setLayouts, pushConstantRanges);
+    } else {
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
+        pipelineLayoutInfo.pSetLayouts = setLayouts.data();
+        pipelineLayoutInfo.pushConstantRangeCount =
+            static_cast<uint32_t>(pushConstantRanges.size());
+        pipelineLayoutInfo.pPushConstantRanges = pushConstantRanges.data();
+
+        if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) !=
+            VK_SUCCESS) {
+            throw std::runtime_error("Failed to create pipeline layout!");
+        }
     }
 }
 
-void Pipeline::bind(VkCommandBuffer commandBuffer, int32_t currentFrame) {
-    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1,
-                            &descriptorSets[currentFrame], 0, nullptr);
+void Pipeline::setPipelineCache(PipelineCache* pipelineCache) {
+    this->pipelineCache = pipelineCache;
+}
+
+void Pipeline::setSpecialization(VkShaderStageFlagBits stage,
+                                 const SpecializationConstants& constants) {
+    switch (stage) {
+    case VK_SHADER_STAGE_VERTEX_BIT:
+        vertSpecialization = constants;
+        break;
+    case VK_SHADER_STAGE_FRAGMENT_BIT:
+        fragSpecialization = constants;
+        break;
+    default:
+        throw std::invalid_argument("Pipelines only have vertex and fragment shaders!");
+    }
+}
+
+void Pipeline::setShaderObjects(const DeviceExtensions& extensions) {
+    if (extensions.shaderObject) {
+        this->extensions = &extensions;
+        shaderObjectsEnabled = true;
+        dynamicStateEnabled = true;
+        dynamicState2Enabled = true;
+    }
+}
+
+void Pipeline::setExtendedDynamicState(const DeviceExtensions& extensions) {
+    if (extensions.extendedDynamicState || extensions.extendedDynamicState2) {
+        this->extensions = &extensions;
+        dynamicStateEnabled |= extensions.extendedDynamicState;
+        dynamicState2Enabled |= extensions.extendedDynamicState2;
+    }
+}
+
+void Pipeline::setCullMode(VkCommandBuffer commandBuffer, VkCullModeFlags cullMode) {
+    requireDynamicState(dynamicStateEnabled);
+#ifdef VK_EXT_extended_dynamic_state
+    extensions->cmdSetCullMode(commandBuffer, cullMode);
+#endif
+}
+
+void Pipeline::setFrontFace(VkCommandBuffer commandBuffer, VkFrontFace frontFace) {
+    requireDynamicState(dynamicStateEnabled);
+#ifdef VK_EXT_extended_dynamic_state
+    extensions->cmdSetFrontFace(commandBuffer, frontFace);
+#endif
+}
+
+void Pipeline::setPrimitiveTopology(VkCommandBuffer commandBuffer, VkPrimitiveTopology topology) {
+    requireDynamicState(dynamicStateEnabled);
+#ifdef VK_EXT_extended_dynamic_state
+    extensions->cmdSetPrimitiveTopology(commandBuffer, topology);
+#endif
+}
+
+void Pipeline::setDepthTestEnable(VkCommandBuffer commandBuffer, bool enable) {
+    requireDynamicState(dynamicStateEnabled);
+#ifdef VK_EXT_extended_dynamic_state
+    extensions->cmdSetDepthTestEnable(commandBuffer, enable ? VK_TRUE : VK_FALSE);
+#endif
+}
+
+void Pipeline::setDepthWriteEnable(VkCommandBuffer commandBuffer, bool enable) {
+    requireDynamicState(dynamicStateEnabled);
+#ifdef VK_EXT_extended_dynamic_state
+    extensions->cmdSetDepthWriteEnable(commandBuffer, enable ? VK_TRUE : VK_FALSE);
+#endif
+}
+
+void Pipeline::setDepthCompareOp(VkCommandBuffer commandBuffer, VkCompareOp compareOp) {
+    requireDynamicState(dynamicStateEnabled);
+#ifdef VK_EXT_extended_dynamic_state
+    extensions->cmdSetDepthCompareOp(commandBuffer, compareOp);
+#endif
+}
+
+void Pipeline::setRasterizerDiscardEnable(VkCommandBuffer commandBuffer, bool enable) {
+    requireDynamicState(dynamicState2Enabled);
+#ifdef VK_EXT_extended_dynamic_state2
+    extensions->cmdSetRasterizerDiscardEnable(commandBuffer, enable ? VK_TRUE : VK_FALSE);
+#endif
+}
+
+void Pipeline::setDepthBiasEnable(VkCommandBuffer commandBuffer, bool enable) {
+    requireDynamicState(dynamicState2Enabled);
+#ifdef VK_EXT_extended_dynamic_state2
+    extensions->cmdSetDepthBiasEnable(commandBuffer, enable ? VK_TRUE : VK_FALSE);
+#endif
+}
+
+void Pipeline::setPrimitiveRestartEnable(VkCommandBuffer commandBuffer, bool enable) {
+    requireDynamicState(dynamicState2Enabled);
+#ifdef VK_EXT_extended_dynamic_state2
+    extensions->cmdSetPrimitiveRestartEnable(commandBuffer, enable ? VK_TRUE : VK_FALSE);
+#endif
+}
+
+void Pipeline::bind(VkCommandBuffer commandBuffer, int32_t currentFrame,
+                    StateTracker* stateTracker) {
+    if (!isReady()) {
+        if (fallback != nullptr) {
+            fallback->bind(commandBuffer, currentFrame, stateTracker);
+            return;
+        }
+
+        waitReady();
+    }
+
+    if (shaderObjectsEnabled) {
+        bindShaderObjects(commandBuffer, currentFrame, stateTracker);
+        return;
+    }
+
+    if (stateTracker != nullptr) {
+        if (cmdPushDescriptorSet == nullptr) {
+            stateTracker->bindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                             pipelineLayout, 0, 1,
+                                             &descriptors.getSets()[currentFrame]);
+        }
+
+        // Pipelines sharing a VkPipeline still have their own dynamic state, so it is set even
+        // when the bind itself is elided.
+        stateTracker->bindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                   graphicsPipeline);
+        setDefaultDynamicState(commandBuffer);
+        return;
+    }
+
+    if (cmdPushDescriptorSet == nullptr) {
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0,
+                                1, &descriptors.getSets()[currentFrame], 0, nullptr);
+    }
+
     vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
+    setDefaultDynamicState(commandBuffer);
+}
+
+void Pipeline::pushDescriptors(VkCommandBuffer commandBuffer,
+                               const std::vector<VkWriteDescriptorSet>& descriptorWrites,
+                               StateTracker* stateTracker) {
+    if (cmdPushDescriptorSet == nullptr) {
+        throw std::runtime_error("Pipeline wasn't created with a push descriptor set layout!");
+    }
+
+    cmdPushDescriptorSet(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0,
+                         static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data());
+
+    // The pushed set replaces set 0, and its layout may disturb the sets after it.
+    if (stateTracker != nullptr) {
+        stateTracker->invalidateDescriptorSets(VK_PIPELINE_BIND_POINT_GRAPHICS, 0);
+    }
+}
+
+bool Pipeline::isReady() {
+    if (!pendingPipeline.valid()) {
+        return true;
+    }
+
+    if (pendingPipeline.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        return false;
+    }
+
+    graphicsPipeline = pendingPipeline.get();
+    return true;
+}
+
+void Pipeline::waitReady() {
+    if (pendingPipeline.valid()) {
+        graphicsPipeline = pendingPipeline.get();
+    }
+}
+
+VkPipelineLayout Pipeline::getLayout() { return pipelineLayout; }
+
+bool Pipeline::getTransparencyEnabled() { return transparencyEnabled; }
+
+bool Pipeline::getShaderObjectsEnabled() { return shaderObjectsEnabled; }
+
+bool Pipeline::getDynamicStateEnabled() { return dynamicStateEnabled; }
+
+bool Pipeline::getDynamicState2Enabled() { return dynamicState2Enabled; }
+
+bool Pipeline::getDescriptorSetsEnabled() { return descriptors.getLayout() != VK_NULL_HANDLE; }
+
+VkShaderStageFlags Pipeline::getPushConstantStages(uint32_t offset, uint32_t size) {
+    VkShaderStageFlags stageFlags = 0;
+
+    // Every stage named has to have a range containing the whole update, so ranges that only
+    // partly overlap it don't contribute their stages.
+    for (const VkPushConstantRange& range : pushConstantRanges) {
+        if (range.offset <= offset && offset + size <= range.offset + range.size) {
+            stageFlags |= range.stageFlags;
+        }
+    }
+
+    if (stageFlags == 0) {
+        throw std::invalid_argument("Push constants aren't covered by a declared range!");
+    }
+
+    return stageFlags;
+}
+
+VkPipelineRasterizationStateCreateInfo Pipeline::getDefaultRasterizer() {
+    VkPipelineRasterizationStateCreateInfo rasterizer{};
+    rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rasterizer.depthClampEnable = VK_FALSE;
+    rasterizer.rasterizerDiscardEnable = VK_FALSE;
+    rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+    rasterizer.lineWidth = 1.0f;
+    rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
+    rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    rasterizer.depthBiasEnable = VK_FALSE;
+
+    return rasterizer;
 }
 
 VkShaderModule Pipeline::createShaderModule(const std::vector<char>& code, VkDevice device) {
@@ -100,9 +328,340 @@ std::vector<char> Pipeline::readFile(const std::string& filename) {
     return buffer;
 }
 
+void Pipeline::createShaderObjects(
+    VkDevice device, RenderPass& renderPass,
+    const std::vector<VkVertexInputBindingDescription>& bindingDescriptions,
+    const std::vector<VkVertexInputAttributeDescription>& attributeDescriptions) {
+#ifdef VK_EXT_shader_object
+    if (!renderPass.getDynamicRenderingEnabled()) {
+        throw std::invalid_argument("Shader objects need a render pass using dynamic rendering!");
+    }
+
+    shaderObjectRenderPass = &renderPass;
+    vertexBindings.clear();
+    vertexAttributes.clear();
+
+    for (const VkVertexInputBindingDescription& description : bindingDescriptions) {
+        VkVertexInputBindingDescription2EXT binding{};
+        binding.sType = VK_STRUCTURE_TYPE_VERTEX_INPUT_BINDING_DESCRIPTION_2_EXT;
+        binding.binding = description.binding;
+        binding.stride = description.stride;
+        binding.inputRate = description.inputRate;
+        binding.divisor = 1;
+        vertexBindings.push_back(binding);
+    }
+
+    for (const VkVertexInputAttributeDescription& description : attributeDescriptions) {
+        VkVertexInputAttributeDescription2EXT attribute{};
+        attribute.sType = VK_STRUCTURE_TYPE_VERTEX_INPUT_ATTRIBUTE_DESCRIPTION_2_EXT;
+        attribute.location = description.location;
+        attribute.binding = description.binding;
+        attribute.format = description.format;
+        attribute.offset = description.offset;
+        vertexAttributes.push_back(attribute);
+    }
+
+    std::vector<VkDescriptorSetLayout> setLayouts = {descriptors.getLayout()};
+    setLayouts.insert(setLayouts.end(), extraSetLayouts.begin(), extraSetLayouts.end());
+
+    std::vector<char> vertShaderCode = readFile(vertShader);
+    std::vector<char> fragShaderCode = readFile(fragShader);
+
+    VkShaderCreateInfoEXT shaderInfos[2]{};
+
+    for (VkShaderCreateInfoEXT& shaderInfo : shaderInfos) {
+        shaderInfo.sType = VK_STRUCTURE_TYPE_SHADER_CREATE_INFO_EXT;
+        shaderInfo.flags = VK_SHADER_CREATE_LINK_STAGE_BIT_EXT;
+        shaderInfo.codeType = VK_SHADER_CODE_TYPE_SPIRV_EXT;
+        shaderInfo.pName = "main";
+        shaderInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
+        shaderInfo.pSetLayouts = setLayouts.data();
+        shaderInfo.pushConstantRangeCount = static_cast<uint32_t>(pushConstantRanges.size());
+        shaderInfo.pPushConstantRanges = pushConstantRanges.data();
+    }
+
+    shaderInfos[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+    shaderInfos[0].nextStage = VK_SHADER_STAGE_FRAGMENT_BIT;
+    shaderInfos[0].codeSize = vertShaderCode.size();
+    shaderInfos[0].pCode = vertShaderCode.data();
+    shaderInfos[0].pSpecializationInfo = vertSpecialization.getInfo();
+
+    shaderInfos[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+    shaderInfos[1].codeSize = fragShaderCode.size();
+    shaderInfos[1].pCode = fragShaderCode.data();
+    shaderInfos[1].pSpecializationInfo = fragSpecialization.getInfo();
+
+    if (extensions->createShaders(device, 2, shaderInfos, nullptr, shaders) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create shader objects!");
+    }
+#endif
+}
+
+void Pipeline::bindShaderObjects(VkCommandBuffer commandBuffer, int32_t currentFrame,
+                                 StateTracker* stateTracker) {
+#ifdef VK_EXT_shader_object
+    const DeviceExtensions& extensions = *this->extensions;
+
+    if (cmdPushDescriptorSet == nullptr) {
+        if (stateTracker != nullptr) {
+            stateTracker->bindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                             pipelineLayout, 0, 1,
+                                             &descriptors.getSets()[currentFrame]);
+        } else {
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                    pipelineLayout, 0, 1, &descriptors.getSets()[currentFrame], 0,
+                                    nullptr);
+        }
+    }
+
+    VkShaderStageFlagBits stages[] = {VK_SHADER_STAGE_VERTEX_BIT, VK_SHADER_STAGE_FRAGMENT_BIT};
+    extensions.cmdBindShaders(commandBuffer, 2, stages, shaders);
+
+    // The shaders replace whatever pipeline the tracker thinks is bound.
+    if (stateTracker != nullptr) {
+        stateTracker->invalidatePipeline(VK_PIPELINE_BIND_POINT_GRAPHICS);
+    }
+
+    // Everything compilePipeline bakes into a pipeline has to be set, with the same values. Shader
+    // objects have no sample shading, so MSAA only shades once per pixel.
+    extensions.cmdSetViewportWithCount(commandBuffer, 1, &shaderObjectRenderPass->getViewport());
+    extensions.cmdSetScissorWithCount(commandBuffer, 1, &shaderObjectRenderPass->getScissor());
+    extensions.cmdSetVertexInput(commandBuffer, static_cast<uint32_t>(vertexBindings.size()),
+                                 vertexBindings.data(),
+                                 static_cast<uint32_t>(vertexAttributes.size()),
+                                 vertexAttributes.data());
+    extensions.cmdSetPolygonMode(commandBuffer, rasterizerState.polygonMode);
+    setDefaultDynamicState(commandBuffer);
+
+    // Set directly rather than through the tracker, since any static pipeline bound in between
+    // overwrites them without the tracker knowing.
+    vkCmdSetLineWidth(commandBuffer, rasterizerState.lineWidth);
+
+    if (rasterizerState.depthBiasEnable) {
+        vkCmdSetDepthBias(commandBuffer, rasterizerState.depthBiasConstantFactor,
+                          rasterizerState.depthBiasClamp, rasterizerState.depthBiasSlopeFactor);
+    }
+
+    VkSampleCountFlagBits samples = shaderObjectRenderPass->getMsaaEnabled()
+                                        ? shaderObjectRenderPass->getMsaaSamples()
+                                        : VK_SAMPLE_COUNT_1_BIT;
+    VkSampleMask sampleMask = UINT32_MAX;
+    extensions.cmdSetRasterizationSamples(commandBuffer, samples);
+    extensions.cmdSetSampleMask(commandBuffer, samples, &sampleMask);
+    extensions.cmdSetAlphaToCoverageEnable(commandBuffer, VK_FALSE);
+
+    extensions.cmdSetDepthBoundsTestEnable(commandBuffer, VK_FALSE);
+    extensions.cmdSetStencilTestEnable(commandBuffer, VK_FALSE);
+
+    VkBool32 blendEnable = transparencyEnabled ? VK_TRUE : VK_FALSE;
+    VkColorBlendEquationEXT blendEquation{};
+    blendEquation.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+    blendEquation.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    blendEquation.colorBlendOp = VK_BLEND_OP_ADD;
+    blendEquation.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    blendEquation.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+    blendEquation.alphaBlendOp = VK_BLEND_OP_ADD;
+    VkColorComponentFlags colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+                                           VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+
+    extensions.cmdSetColorBlendEnable(commandBuffer, 0, 1, &blendEnable);
+    extensions.cmdSetColorBlendEquation(commandBuffer, 0, 1, &blendEquation);
+    extensions.cmdSetColorWriteMask(commandBuffer, 0, 1, &colorWriteMask);
+#endif
+}
+
+Pipeline::CompileState Pipeline::getCompileState(RenderPass& renderPass) {
+    CompileState state{};
+    state.vertShader = vertShader;
+    state.fragShader = fragShader;
+    state.vertSpecialization = vertSpecialization;
+    state.fragSpecialization = fragSpecialization;
+    state.transparencyEnabled = transparencyEnabled;
+    state.dynamicStateEnabled = dynamicStateEnabled;
+    state.dynamicState2Enabled = dynamicState2Enabled;
+    state.rasterizerState = rasterizerState;
+    state.pipelineLayout = pipelineLayout;
+    state.pipelineCache = pipelineCache;
+
+    state.renderPass = renderPass.getRenderPass();
+    state.msaaEnabled = renderPass.getMsaaEnabled();
+    state.msaaSamples = renderPass.getMsaaSamples();
+    state.depthEnabled = renderPass.getDepthEnabled();
+    state.dynamicRenderingEnabled = renderPass.getDynamicRenderingEnabled();
+    state.colorFormat = renderPass.getColorFormat();
+    state.depthFormat = renderPass.getDepthFormat();
+
+    return state;
+}
+
+void Pipeline::addDynamicStates(std::vector<VkDynamicState>& dynamicStates,
+                                const CompileState& state) {
+#ifdef VK_EXT_extended_dynamic_state
+    if (state.dynamicStateEnabled) {
+        dynamicStates.insert(dynamicStates.end(), {VK_DYNAMIC_STATE_CULL_MODE_EXT,
+                                                   VK_DYNAMIC_STATE_FRONT_FACE_EXT,
+                                                   VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY_EXT,
+                                                   VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE_EXT,
+                                                   VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE_EXT,
+                                                   VK_DYNAMIC_STATE_DEPTH_COMPARE_OP_EXT});
+    }
+#endif
+
+#ifdef VK_EXT_extended_dynamic_state2
+    if (state.dynamicState2Enabled) {
+        dynamicStates.insert(dynamicStates.end(),
+                             {VK_DYNAMIC_STATE_RASTERIZER_DISCARD_ENABLE_EXT,
+                              VK_DYNAMIC_STATE_DEPTH_BIAS_ENABLE_EXT,
+                              VK_DYNAMIC_STATE_PRIMITIVE_RESTART_ENABLE_EXT});
+    }
+#endif
+}
+
+void Pipeline::setDefaultDynamicState(VkCommandBuffer commandBuffer) {
+    if (dynamicStateEnabled) {
+        setCullMode(commandBuffer, rasterizerState.cullMode);
+        setFrontFace(commandBuffer, rasterizerState.frontFace);
+        setPrimitiveTopology(commandBuffer, VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST);
+        setDepthTestEnable(commandBuffer, true);
+        setDepthWriteEnable(commandBuffer, true);
+        setDepthCompareOp(commandBuffer, VK_COMPARE_OP_LESS);
+    }
+
+    if (dynamicState2Enabled) {
+        setRasterizerDiscardEnable(commandBuffer, rasterizerState.rasterizerDiscardEnable);
+        setDepthBiasEnable(commandBuffer, rasterizerState.depthBiasEnable);
+        setPrimitiveRestartEnable(commandBuffer, false);
+    }
+}
+
+void Pipeline::requireDynamicState(bool enabled) {
+    if (!enabled) {
+        throw std::runtime_error("State isn't dynamic in this pipeline!");
+    }
+}
+
+PipelineCache::Key Pipeline::getStateKey(const VkGraphicsPipelineCreateInfo& pipelineInfo,
+                                         const CompileState& state) {
+    PipelineCache::Key key;
+    PipelineCache::appendKey(key, state.vertShader);
+    PipelineCache::appendKey(key, state.fragShader);
+
+    for (uint32_t i = 0; i < pipelineInfo.stageCount; i++) {
+        const VkPipelineShaderStageCreateInfo& stage = pipelineInfo.pStages[i];
+        PipelineCache::appendKey(key, stage.stage);
+        PipelineCache::appendKey(key, std::string(stage.pName));
+
+        if (stage.pSpecializationInfo == nullptr) {
+            PipelineCache::appendKey(key, nullptr, 0);
+            continue;
+        }
+
+        const VkSpecializationInfo& info = *stage.pSpecializationInfo;
+        PipelineCache::appendKey(key, info.pMapEntries,
+                                 info.mapEntryCount * sizeof(VkSpecializationMapEntry));
+        PipelineCache::appendKey(key, info.pData, info.dataSize);
+    }
+
+    const VkPipelineVertexInputStateCreateInfo& vertexInput = *pipelineInfo.pVertexInputState;
+    PipelineCache::appendKey(key, vertexInput.pVertexBindingDescriptions,
+                             vertexInput.vertexBindingDescriptionCount *
+                                 sizeof(VkVertexInputBindingDescription));
+    PipelineCache::appendKey(key, vertexInput.pVertexAttributeDescriptions,
+                             vertexInput.vertexAttributeDescriptionCount *
+                                 sizeof(VkVertexInputAttributeDescription));
+
+    // Dynamic states are left out, so every pipeline that only differs in them shares one entry.
+    if (!state.dynamicStateEnabled) {
+        PipelineCache::appendKey(key, pipelineInfo.pInputAssemblyState->topology);
+    }
+
+    if (!state.dynamicState2Enabled) {
+        PipelineCache::appendKey(key, pipelineInfo.pInputAssemblyState->primitiveRestartEnable);
+    }
+
+    // Field by field, since the structs' padding isn't guaranteed to be zeroed.
+    const VkPipelineRasterizationStateCreateInfo& rasterizer = *pipelineInfo.pRasterizationState;
+    PipelineCache::appendKey(key, rasterizer.depthClampEnable);
+    PipelineCache::appendKey(key, rasterizer.polygonMode);
+
+    if (!state.dynamicStateEnabled) {
+        PipelineCache::appendKey(key, rasterizer.cullMode);
+        PipelineCache::appendKey(key, rasterizer.frontFace);
+    }
+
+    if (!state.dynamicState2Enabled) {
+        PipelineCache::appendKey(key, rasterizer.rasterizerDiscardEnable);
+        PipelineCache::appendKey(key, rasterizer.depthBiasEnable);
+    }
+
+    PipelineCache::appendKey(key, rasterizer.depthBiasConstantFactor);
+    PipelineCache::appendKey(key, rasterizer.depthBiasClamp);
+    PipelineCache::appendKey(key, rasterizer.depthBiasSlopeFactor);
+    PipelineCache::appendKey(key, rasterizer.lineWidth);
+
+    const VkPipelineMultisampleStateCreateInfo& multisampling = *pipelineInfo.pMultisampleState;
+    PipelineCache::appendKey(key, multisampling.rasterizationSamples);
+    PipelineCache::appendKey(key, multisampling.sampleShadingEnable);
+    PipelineCache::appendKey(key, multisampling.minSampleShading);
+
+    const VkPipelineDepthStencilStateCreateInfo& depthStencil = *pipelineInfo.pDepthStencilState;
+
+    if (!state.dynamicStateEnabled) {
+        PipelineCache::appendKey(key, depthStencil.depthTestEnable);
+        PipelineCache::appendKey(key, depthStencil.depthWriteEnable);
+        PipelineCache::appendKey(key, depthStencil.depthCompareOp);
+    }
+
+    PipelineCache::appendKey(key, depthStencil.depthBoundsTestEnable);
+    PipelineCache::appendKey(key, depthStencil.stencilTestEnable);
+
+    const VkPipelineColorBlendStateCreateInfo& colorBlending = *pipelineInfo.pColorBlendState;
+    PipelineCache::appendKey(key, colorBlending.logicOpEnable);
+    PipelineCache::appendKey(key, colorBlending.logicOp);
+    PipelineCache::appendKey(key, colorBlending.pAttachments,
+                             colorBlending.attachmentCount *
+                                 sizeof(VkPipelineColorBlendAttachmentState));
+    PipelineCache::appendKey(key, colorBlending.blendConstants);
+
+    const VkPipelineDynamicStateCreateInfo& dynamicState = *pipelineInfo.pDynamicState;
+    PipelineCache::appendKey(key, dynamicState.pDynamicStates,
+                             dynamicState.dynamicStateCount * sizeof(VkDynamicState));
+
+    PipelineCache::appendKey(key, pipelineInfo.layout);
+    PipelineCache::appendKey(key, pipelineInfo.renderPass);
+    PipelineCache::appendKey(key, pipelineInfo.subpass);
+
+#ifdef VK_KHR_dynamic_rendering
+    // Without a render pass, the attachment formats chained by compilePipeline take its place.
+    if (pipelineInfo.renderPass == VK_NULL_HANDLE) {
+        const VkPipelineRenderingCreateInfoKHR& renderingInfo =
+            *static_cast<const VkPipelineRenderingCreateInfoKHR*>(pipelineInfo.pNext);
+        PipelineCache::appendKey(key, renderingInfo.pColorAttachmentFormats,
+                                 renderingInfo.colorAttachmentCount * sizeof(VkFormat));
+        PipelineCache::appendKey(key, renderingInfo.depthAttachmentFormat);
+    }
+#endif
+
+    return key;
+}
+
 void Pipeline::cleanup(VkDevice device) {
-    vkDestroyPipeline(device, graphicsPipeline, nullptr);
-    vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
-    vkDestroyDescriptorPool(device, descriptorPool, nullptr);
-    vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
+    // A pipeline still compiling in the background has to finish before it can be destroyed.
+    waitReady();
+
+#ifdef VK_EXT_shader_object
+    if (shaderObjectsEnabled) {
+        for (VkShaderEXT& shader : shaders) {
+            extensions->destroyShader(device, shader, nullptr);
+            shader = VK_NULL_HANDLE;
+        }
+    }
+#endif
+
+    if (pipelineCache == nullptr) {
+        vkDestroyPipeline(device, graphicsPipeline, nullptr);
+        vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+    }
+
+    descriptors.destroy(device);
 }
\ No newline at end of file
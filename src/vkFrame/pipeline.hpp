@@ -5,61 +5,280 @@
 
 #include <fstream>
 #include <functional>
+#include <future>
 #include <iostream>
+#include <stdexcept>
+#include <type_traits>
 #include <vector>
 
+#include "descriptorAllocator.hpp"
+#include "descriptorLayoutCache.hpp"
+#include "descriptorSets.hpp"
+#include "deviceExtensions.hpp"
+#include "pipelineCache.hpp"
+#include "pipelineCompiler.hpp"
 #include "renderPass.hpp"
+#include "specializationConstants.hpp"
+#include "stateTracker.hpp"
 #include "swapchain.hpp"
 
+// Used in place of a vertex or instance type by pipelines that read that data through buffer
+// device addresses instead of vertex bindings.
+struct NoVertexInput {};
+
 class Pipeline {
   public:
     template <typename V, typename I>
     void createCustom(const std::string& vertShader, const std::string& fragShader, VkDevice device,
-                RenderPass& renderPass, bool enableTransparency, VkPipelineRasterizationStateCreateInfo rasterizer) {
-        this->fragShader = fragShader;
-        this->vertShader = vertShader;
-        this->transparencyEnabled = enableTransparency;
+                      RenderPass& renderPass, bool enableTransparency,
+                      VkPipelineRasterizationStateCreateInfo rasterizer) {
+        setupPipeline(vertShader, fragShader, device, enableTransparency, rasterizer);
+
+        if (shaderObjectsEnabled) {
+            createShaderObjects<V, I>(device, renderPass);
+            return;
+        }
+
+        CompileState state = getCompileState(renderPass);
+        graphicsPipeline = compilePipeline<V, I>(device, state);
+    }
+
+    // Compiles the pipeline on one of the compiler's threads. Until it is ready, bind uses the
+    // fallback, which should share this pipeline's layout, or waits when there is none. The
+    // compile works on a copy of the state it needs, so the pipeline and render pass may change
+    // in the meantime, but the render pass's VkRenderPass has to outlive it.
+    template <typename V, typename I>
+    void createAsync(const std::string& vertShader, const std::string& fragShader, VkDevice device,
+                     RenderPass& renderPass, bool enableTransparency, PipelineCompiler& compiler,
+                     Pipeline* fallback = nullptr) {
+        setupPipeline(vertShader, fragShader, device, enableTransparency, getDefaultRasterizer());
+
+        if (shaderObjectsEnabled) {
+            createShaderObjects<V, I>(device, renderPass);
+            return;
+        }
+
+        this->fallback = fallback;
+
+        pendingPipeline = compiler.submit([device, state = getCompileState(renderPass)]() mutable {
+            return compilePipeline<V, I>(device, state);
+        });
+    }
+
+    template <typename V, typename I>
+    void create(const std::string& vertShader, const std::string& fragShader, VkDevice device,
+                RenderPass& renderPass, bool enableTransparency) {
+        createCustom<V, I>(vertShader, fragShader, device, renderPass, enableTransparency,
+                           getDefaultRasterizer());
+    }
+
+    template <typename V, typename I>
+    void recreate(VkDevice device, const uint32_t maxFramesInFlight, RenderPass& renderPass) {
+        cleanup(device);
+        descriptors.recreate(device, maxFramesInFlight, cmdPushDescriptorSet == nullptr);
+
+        createCustom<V, I>(vertShader, fragShader, device, renderPass, transparencyEnabled,
+                           rasterizerState);
+    }
+
+    // Both have to be called before the pipeline is created. With a pipeline cache, pipelines
+    // built from identical state share one VkPipeline and layout, and recreating a pipeline
+    // reuses them. The descriptor set layout then has to come from a DescriptorLayoutCache.
+    void setPipelineCache(PipelineCache* pipelineCache);
+    void setSpecialization(VkShaderStageFlagBits stage, const SpecializationConstants& constants);
+    // Where VK_EXT_shader_object is supported, the pipeline is made of linked vertex and fragment
+    // shader objects instead, and bind sets everything a pipeline would have baked in, so creating
+    // it compiles no pipeline. Has to be called before the pipeline is created, and the render pass
+    // it is created with has to use dynamic rendering.
+    void setShaderObjects(const DeviceExtensions& extensions);
+    // Where VK_EXT_extended_dynamic_state is supported, cull mode, front face, topology and the
+    // depth test, write and compare op are left out of the compiled pipeline, and with
+    // VK_EXT_extended_dynamic_state2 so are rasterizer discard, depth bias enable and primitive
+    // restart. Cached pipelines that only differ in them then share one VkPipeline. Bind sets
+    // this pipeline's own values, and the setters below override them until the next bind. Has
+    // to be called before the pipeline is created.
+    void setExtendedDynamicState(const DeviceExtensions& extensions);
+
+    // Only available for states that are dynamic in this pipeline, shader objects included.
+    // Topologies have to stay triangle topologies.
+    void setCullMode(VkCommandBuffer commandBuffer, VkCullModeFlags cullMode);
+    void setFrontFace(VkCommandBuffer commandBuffer, VkFrontFace frontFace);
+    void setPrimitiveTopology(VkCommandBuffer commandBuffer, VkPrimitiveTopology topology);
+    void setDepthTestEnable(VkCommandBuffer commandBuffer, bool enable);
+    void setDepthWriteEnable(VkCommandBuffer commandBuffer, bool enable);
+    void setDepthCompareOp(VkCommandBuffer commandBuffer, VkCompareOp compareOp);
+    void setRasterizerDiscardEnable(VkCommandBuffer commandBuffer, bool enable);
+    void setDepthBiasEnable(VkCommandBuffer commandBuffer, bool enable);
+    void setPrimitiveRestartEnable(VkCommandBuffer commandBuffer, bool enable);
+
+    void createDescriptorSetLayout(
+        VkDevice device,
+        std::function<void(std::vector<VkDescriptorSetLayoutBinding>&)> setupBindings,
+        DescriptorLayoutCache* layoutCache = nullptr);
+    // Set 0 is written with pushDescriptors while recording, so no pool or sets are needed.
+    void createPushDescriptorSetLayout(
+        VkDevice device, const DeviceExtensions& extensions,
+        std::function<void(std::vector<VkDescriptorSetLayoutBinding>&)> setupBindings);
+    void createDescriptorPool(
+        const uint32_t maxFramesInFlight, VkDevice device,
+        std::function<void(std::vector<VkDescriptorPoolSize>& poolSizes)> setupPool);
+    void createDescriptorSets(
+        const uint32_t maxFramesInFlight, VkDevice device,
+        std::function<void(std::vector<VkWriteDescriptorSet>&, VkDescriptorSet, uint32_t)>
+            setupDescriptor);
+    void createDescriptorSets(
+        const uint32_t maxFramesInFlight, VkDevice device, DescriptorAllocator& allocator,
+        std::function<void(std::vector<VkWriteDescriptorSet>&, VkDescriptorSet, uint32_t)>
+            setupDescriptor);
+    // Declares a push constant block of type T, must be called before the pipeline is created.
+    // Only 128 bytes of push constants are guaranteed to be available.
+    template <typename T>
+    void addPushConstantRange(VkShaderStageFlags stageFlags, uint32_t offset = 0) {
+        static_assert(sizeof(T) % 4 == 0, "Push constant size must be a multiple of 4!");
+        static_assert(sizeof(T) <= 128, "Push constants larger than 128 bytes aren't portable!");
+
+        if (offset % 4 != 0 || offset + sizeof(T) > 128) {
+            throw std::invalid_argument("Push constant range is out of bounds!");
+        }
+
+        VkPushConstantRange pushConstantRange{};
+        pushConstantRange.stageFlags = stageFlags;
+        pushConstantRange.offset = offset;
+        pushConstantRange.size = static_cast<uint32_t>(sizeof(T));
+        pushConstantRanges.push_back(pushConstantRange);
+    }
+
+    template <typename T>
+    void pushConstants(VkCommandBuffer commandBuffer, const T& data, uint32_t offset = 0) {
+        vkCmdPushConstants(commandBuffer, pipelineLayout,
+                           getPushConstantStages(offset, static_cast<uint32_t>(sizeof(T))), offset,
+                           static_cast<uint32_t>(sizeof(T)), &data);
+    }
 
-        auto vertShaderCode = readFile(vertShader);
-        auto fragShaderCode = readFile(fragShader);
+    void addSetLayout(VkDescriptorSetLayout setLayout);
+    void cleanup(VkDevice device);
 
-        VkShaderModule vertShaderModule = createShaderModule(vertShaderCode, device);
-        VkShaderModule fragShaderModule = createShaderModule(fragShaderCode, device);
+    void bind(VkCommandBuffer commandBuffer, int32_t currentFrame,
+              StateTracker* stateTracker = nullptr);
+    void pushDescriptors(VkCommandBuffer commandBuffer,
+                         const std::vector<VkWriteDescriptorSet>& descriptorWrites,
+                         StateTracker* stateTracker = nullptr);
+
+    // Picks up a finished background compile, rethrowing its error if it failed.
+    bool isReady();
+    void waitReady();
+
+    VkPipelineLayout getLayout();
+    bool getTransparencyEnabled();
+    bool getShaderObjectsEnabled();
+    bool getDynamicStateEnabled();
+    bool getDynamicState2Enabled();
+    bool getDescriptorSetsEnabled();
+    VkShaderStageFlags getPushConstantStages(uint32_t offset, uint32_t size);
+
+    static VkPipelineRasterizationStateCreateInfo getDefaultRasterizer();
+    static VkShaderModule createShaderModule(const std::vector<char>& code, VkDevice device);
+    static std::vector<char> readFile(const std::string& filename);
 
+  private:
+    template <typename V, typename I>
+    static void
+    getVertexInput(std::vector<VkVertexInputBindingDescription>& bindingDescriptions,
+                   std::vector<VkVertexInputAttributeDescription>& attributeDescriptions) {
+        if constexpr (!std::is_same_v<V, NoVertexInput>) {
+            bindingDescriptions.push_back(V::getBindingDescription());
+
+            for (VkVertexInputAttributeDescription desc : V::getAttributeDescriptions()) {
+                attributeDescriptions.push_back(desc);
+            }
+        }
+
+        if constexpr (!std::is_same_v<I, NoVertexInput>) {
+            bindingDescriptions.push_back(I::getBindingDescription());
+
+            for (VkVertexInputAttributeDescription desc : I::getAttributeDescriptions()) {
+                attributeDescriptions.push_back(desc);
+            }
+        }
+    }
+
+    template <typename V, typename I>
+    void createShaderObjects(VkDevice device, RenderPass& renderPass) {
+        std::vector<VkVertexInputBindingDescription> bindingDescriptions;
+        std::vector<VkVertexInputAttributeDescription> attributeDescriptions;
+        getVertexInput<V, I>(bindingDescriptions, attributeDescriptions);
+
+        createShaderObjects(device, renderPass, bindingDescriptions, attributeDescriptions);
+    }
+
+    void createShaderObjects(
+        VkDevice device, RenderPass& renderPass,
+        const std::vector<VkVertexInputBindingDescription>& bindingDescriptions,
+        const std::vector<VkVertexInputAttributeDescription>& attributeDescriptions);
+    void bindShaderObjects(VkCommandBuffer commandBuffer, int32_t currentFrame,
+                           StateTracker* stateTracker);
+    // Sets the dynamic states to the values compilePipeline would otherwise bake in.
+    void setDefaultDynamicState(VkCommandBuffer commandBuffer);
+    void requireDynamicState(bool enabled);
+
+    // Stores the state the pipeline is compiled from and creates its layout.
+    void setupPipeline(const std::string& vertShader, const std::string& fragShader,
+                       VkDevice device, bool enableTransparency,
+                       const VkPipelineRasterizationStateCreateInfo& rasterizer);
+
+    // Everything compilePipeline reads from the pipeline and its render pass, copied so that a
+    // background compile doesn't share any of it with the render loop.
+    struct CompileState {
+        std::string vertShader;
+        std::string fragShader;
+        SpecializationConstants vertSpecialization;
+        SpecializationConstants fragSpecialization;
+        bool transparencyEnabled;
+        bool dynamicStateEnabled;
+        bool dynamicState2Enabled;
+        VkPipelineRasterizationStateCreateInfo rasterizerState;
+        VkPipelineLayout pipelineLayout;
+        PipelineCache* pipelineCache;
+
+        VkRenderPass renderPass;
+        bool msaaEnabled;
+        VkSampleCountFlagBits msaaSamples;
+        bool depthEnabled;
+        bool dynamicRenderingEnabled;
+        VkFormat colorFormat;
+        VkFormat depthFormat;
+    };
+
+    CompileState getCompileState(RenderPass& renderPass);
+    static void addDynamicStates(std::vector<VkDynamicState>& dynamicStates,
+                                 const CompileState& state);
+
+    template <typename V, typename I>
+    static VkPipeline compilePipeline(VkDevice device, CompileState& state) {
+        // The modules are only created once the pipeline has to be compiled.
         VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
         vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
         vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-        vertShaderStageInfo.module = vertShaderModule;
         vertShaderStageInfo.pName = "main";
+        vertShaderStageInfo.pSpecializationInfo = state.vertSpecialization.getInfo();
 
         VkPipelineShaderStageCreateInfo fragShaderStageInfo{};
         fragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
         fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-        fragShaderStageInfo.module = fragShaderModule;
         fragShaderStageInfo.pName = "main";
+        fragShaderStageInfo.pSpecializationInfo = state.fragSpecialization.getInfo();
 
         VkPipelineShaderStageCreateInfo shaderStages[] = {vertShaderStageInfo, fragShaderStageInfo};
 
         VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
         vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
 
-        std::array<VkVertexInputBindingDescription, 2> bindingDescriptions = {
-            V::getBindingDescription(), I::getBindingDescription()};
-        auto vertexAttributeDescriptions = V::getAttributeDescriptions();
-        auto instanceAttributeDescriptions = I::getAttributeDescriptions();
+        std::vector<VkVertexInputBindingDescription> bindingDescriptions;
         std::vector<VkVertexInputAttributeDescription> attributeDescriptions;
-        attributeDescriptions.reserve(vertexAttributeDescriptions.size() +
-                                      instanceAttributeDescriptions.size());
+        getVertexInput<V, I>(bindingDescriptions, attributeDescriptions);
 
-        for (VkVertexInputAttributeDescription desc : vertexAttributeDescriptions) {
-            attributeDescriptions.push_back(desc);
-        }
-
-        for (VkVertexInputAttributeDescription desc : instanceAttributeDescriptions) {
-            attributeDescriptions.push_back(desc);
-        }
-
-        vertexInputInfo.vertexBindingDescriptionCount = 2;
+        vertexInputInfo.vertexBindingDescriptionCount =
+            static_cast<uint32_t>(bindingDescriptions.size());
         vertexInputInfo.vertexAttributeDescriptionCount =
             static_cast<uint32_t>(attributeDescriptions.size());
         vertexInputInfo.pVertexBindingDescriptions = bindingDescriptions.data();
@@ -78,10 +297,10 @@ class Pipeline {
         VkPipelineMultisampleStateCreateInfo multisampling{};
         multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
 
-        if (renderPass.getMsaaEnabled()) {
+        if (state.msaaEnabled) {
             multisampling.sampleShadingEnable = VK_TRUE;
             multisampling.minSampleShading = 0.2f;
-            multisampling.rasterizationSamples = renderPass.getMsaaSamples();
+            multisampling.rasterizationSamples = state.msaaSamples;
         } else {
             multisampling.sampleShadingEnable = VK_FALSE;
             multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
@@ -99,7 +318,7 @@ class Pipeline {
         colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
                                               VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
 
-        if (enableTransparency) {
+        if (state.transparencyEnabled) {
             colorBlendAttachment.blendEnable = VK_TRUE;
             colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
             colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
@@ -124,21 +343,12 @@ class Pipeline {
 
         std::vector<VkDynamicState> dynamicStates = {VK_DYNAMIC_STATE_VIEWPORT,
                                                      VK_DYNAMIC_STATE_SCISSOR};
+        addDynamicStates(dynamicStates, state);
         VkPipelineDynamicStateCreateInfo dynamicState{};
         dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
         dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
         dynamicState.pDynamicStates = dynamicStates.data();
 
-        VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
-        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-        pipelineLayoutInfo.setLayoutCount = 1;
-        pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
-
-        if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) !=
-            VK_SUCCESS) {
-            throw std::runtime_error("Failed to create pipeline layout!");
-        }
-
         VkGraphicsPipelineCreateInfo pipelineInfo{};
         pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
         pipelineInfo.stageCount = 2;
@@ -146,82 +356,91 @@ class Pipeline {
         pipelineInfo.pVertexInputState = &vertexInputInfo;
         pipelineInfo.pInputAssemblyState = &inputAssembly;
         pipelineInfo.pViewportState = &viewportState;
-        pipelineInfo.pRasterizationState = &rasterizer;
+        pipelineInfo.pRasterizationState = &state.rasterizerState;
         pipelineInfo.pMultisampleState = &multisampling;
         pipelineInfo.pDepthStencilState = &depthStencil;
         pipelineInfo.pColorBlendState = &colorBlending;
         pipelineInfo.pDynamicState = &dynamicState;
-        pipelineInfo.layout = pipelineLayout;
-        pipelineInfo.renderPass = renderPass.getRenderPass();
+        pipelineInfo.layout = state.pipelineLayout;
+        pipelineInfo.renderPass = state.renderPass;
         pipelineInfo.subpass = 0;
         pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 
-        if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr,
-                                      &graphicsPipeline) != VK_SUCCESS) {
-            throw std::runtime_error("Failed to create graphics pipeline!");
+#ifdef VK_KHR_dynamic_rendering
+        VkFormat colorFormat = state.colorFormat;
+        VkPipelineRenderingCreateInfoKHR renderingInfo{};
+        renderingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR;
+        renderingInfo.colorAttachmentCount = 1;
+        renderingInfo.pColorAttachmentFormats = &colorFormat;
+        renderingInfo.depthAttachmentFormat =
+            state.depthEnabled ? state.depthFormat : VK_FORMAT_UNDEFINED;
+
+        if (state.dynamicRenderingEnabled) {
+            pipelineInfo.pNext = &renderingInfo;
+            pipelineInfo.renderPass = VK_NULL_HANDLE;
         }
+#endif
 
-        vkDestroyShaderModule(device, fragShaderModule, nullptr);
-        vkDestroyShaderModule(device, vertShaderModule, nullptr);
-    }
+        auto compile = [&](VkPipelineCache cache) {
+            shaderStages[0].module = createShaderModule(readFile(state.vertShader), device);
+            shaderStages[1].module = createShaderModule(readFile(state.fragShader), device);
 
-    template <typename V, typename I>
-    void create(const std::string& vertShader, const std::string& fragShader, VkDevice device,
-                RenderPass& renderPass, bool enableTransparency) {
-        VkPipelineRasterizationStateCreateInfo rasterizer{};
-        rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-        rasterizer.depthClampEnable = VK_FALSE;
-        rasterizer.rasterizerDiscardEnable = VK_FALSE;
-        rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
-        rasterizer.lineWidth = 1.0f;
-        rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
-        rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
-        rasterizer.depthBiasEnable = VK_FALSE;
-
-        createCustom<V, I>(vertShader, fragShader, device, renderPass, enableTransparency, rasterizer);
-    }
+            VkPipeline pipeline;
+            VkResult result =
+                vkCreateGraphicsPipelines(device, cache, 1, &pipelineInfo, nullptr, &pipeline);
 
-    template <typename V, typename I>
-    void recreate(VkDevice device, const uint32_t maxFramesInFlight, RenderPass& renderPass) {
-        cleanup(device);
-        createDescriptorSetLayout(device, setupBindings);
-        createDescriptorPool(maxFramesInFlight, device, setupPool);
-        createDescriptorSets(maxFramesInFlight, device, setupDescriptor);
-        create<V, I>(vertShader, fragShader, device, renderPass, transparencyEnabled);
-    }
+            vkDestroyShaderModule(device, shaderStages[1].module, nullptr);
+            vkDestroyShaderModule(device, shaderStages[0].module, nullptr);
 
-    void createDescriptorSetLayout(
-        VkDevice device,
-        std::function<void(std::vector<VkDescriptorSetLayoutBinding>&)> setupBindings);
-    void createDescriptorPool(
-        const uint32_t maxFramesInFlight, VkDevice device,
-        std::function<void(std::vector<VkDescriptorPoolSize>& poolSizes)> setupPool);
-    void createDescriptorSets(
-        const uint32_t maxFramesInFlight, VkDevice device,
-        std::function<void(std::vector<VkWriteDescriptorSet>&, VkDescriptorSet, uint32_t)>
-            setupDescriptor);
-    void cleanup(VkDevice device);
+            if (result != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create graphics pipeline!");
+            }
 
-    void bind(VkCommandBuffer commandBuffer, int32_t currentFrame);
+            return pipeline;
+        };
 
-  private:
-    static VkShaderModule createShaderModule(const std::vector<char>& code, VkDevice device);
-    static std::vector<char> readFile(const std::string& filename);
+        if (state.pipelineCache != nullptr) {
+            return state.pipelineCache->get(device, getStateKey(pipelineInfo, state), compile);
+        }
 
-    VkPipelineLayout pipelineLayout;
-    VkPipeline graphicsPipeline;
+        return compile(VK_NULL_HANDLE);
+    }
 
-    VkDescriptorSetLayout descriptorSetLayout;
-    VkDescriptorPool descriptorPool;
-    std::vector<VkDescriptorSet> descriptorSets;
+    // Everything the pipeline is compiled from except the shader modules, which are keyed by
+    // their paths.
+    static PipelineCache::Key getStateKey(const VkGraphicsPipelineCreateInfo& pipelineInfo,
+                                          const CompileState& state);
+
+    VkPipelineLayout pipelineLayout;
+    VkPipeline graphicsPipeline = VK_NULL_HANDLE;
 
-    std::function<void(std::vector<VkDescriptorSetLayoutBinding>&)> setupBindings;
-    std::function<void(std::vector<VkDescriptorPoolSize>& poolSizes)> setupPool;
-    std::function<void(std::vector<VkWriteDescriptorSet>&, VkDescriptorSet, uint32_t)>
-        setupDescriptor;
+    DescriptorSets descriptors;
+    std::vector<VkPushConstantRange> pushConstantRanges;
+    // Layouts owned elsewhere, such as a bindless table, used for sets 1 and up.
+    std::vector<VkDescriptorSetLayout> extraSetLayouts;
+    PFN_vkCmdPushDescriptorSetKHR cmdPushDescriptorSet = nullptr;
 
     std::string vertShader;
     std::string fragShader;
 
     bool transparencyEnabled = false;
+    VkPipelineRasterizationStateCreateInfo rasterizerState{};
+    SpecializationConstants vertSpecialization;
+    SpecializationConstants fragSpecialization;
+    // When set, the pipeline and its layout belong to the cache.
+    PipelineCache* pipelineCache = nullptr;
+    std::future<VkPipeline> pendingPipeline;
+    Pipeline* fallback = nullptr;
+
+    // Set when the pipeline uses shader objects or extended dynamic state.
+    const DeviceExtensions* extensions = nullptr;
+    bool shaderObjectsEnabled = false;
+    bool dynamicStateEnabled = false;
+    bool dynamicState2Enabled = false;
+    RenderPass* shaderObjectRenderPass = nullptr;
+#ifdef VK_EXT_shader_object
+    VkShaderEXT shaders[2] = {VK_NULL_HANDLE, VK_NULL_HANDLE};
+    std::vector<VkVertexInputBindingDescription2EXT> vertexBindings;
+    std::vector<VkVertexInputAttributeDescription2EXT> vertexAttributes;
+#endif
 };
\ No newline at end of file
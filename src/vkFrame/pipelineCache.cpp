@@ -0,0 +1,135 @@
+#include "pipelineCache.hpp"
+
+void PipelineCache::create(VkDevice device, const std::string& path) {
+    std::vector<char> initialData;
+
+    if (!path.empty()) {
+        std::ifstream file(path, std::ios::ate | std::ios::binary);
+
+        if (file.is_open()) {
+            initialData.resize(static_cast<size_t>(file.tellg()));
+            file.seekg(0);
+            file.read(initialData.data(), initialData.size());
+        }
+    }
+
+    // The driver checks the header and ignores data from another device or driver version.
+    VkPipelineCacheCreateInfo cacheInfo{};
+    cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    cacheInfo.initialDataSize = initialData.size();
+    cacheInfo.pInitialData = initialData.data();
+
+    if (vkCreatePipelineCache(device, &cacheInfo, nullptr, &pipelineCache) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create pipeline cache!");
+    }
+}
+
+void PipelineCache::save(VkDevice device, const std::string& path) {
+    size_t dataSize = 0;
+
+    if (vkGetPipelineCacheData(device, pipelineCache, &dataSize, nullptr) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to get pipeline cache data!");
+    }
+
+    std::vector<char> data(dataSize);
+
+    if (vkGetPipelineCacheData(device, pipelineCache, &dataSize, data.data()) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to get pipeline cache data!");
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open file!");
+    }
+
+    file.write(data.data(), dataSize);
+}
+
+VkPipelineLayout
+PipelineCache::getLayout(VkDevice device, const std::vector<VkDescriptorSetLayout>& setLayouts,
+                         const std::vector<VkPushConstantRange>& pushConstantRanges) {
+    Key key;
+    appendKey(key, setLayouts.data(), setLayouts.size() * sizeof(VkDescriptorSetLayout));
+    appendKey(key, pushConstantRanges.data(),
+              pushConstantRanges.size() * sizeof(VkPushConstantRange));
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = layouts.find(key);
+
+    if (it != layouts.end()) {
+        return it->second;
+    }
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
+    pipelineLayoutInfo.pSetLayouts = setLayouts.data();
+    pipelineLayoutInfo.pushConstantRangeCount = static_cast<uint32_t>(pushConstantRanges.size());
+    pipelineLayoutInfo.pPushConstantRanges = pushConstantRanges.data();
+
+    VkPipelineLayout layout;
+
+    if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &layout) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create pipeline layout!");
+    }
+
+    layouts[key] = layout;
+    return layout;
+}
+
+VkPipeline PipelineCache::get(VkDevice device, const Key& key,
+                              std::function<VkPipeline(VkPipelineCache)> createPipeline) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = pipelines.find(key);
+
+        if (it != pipelines.end()) {
+            hitCount++;
+            return it->second;
+        }
+    }
+
+    // Compiled without the lock, so other permutations can be compiled at the same time.
+    VkPipeline pipeline = createPipeline(pipelineCache);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto [it, inserted] = pipelines.emplace(key, pipeline);
+
+    // Another thread compiled the same permutation in the meantime.
+    if (!inserted) {
+        vkDestroyPipeline(device, pipeline, nullptr);
+    }
+
+    return it->second;
+}
+
+void PipelineCache::destroy(VkDevice device) {
+    for (auto& [key, pipeline] : pipelines) {
+        vkDestroyPipeline(device, pipeline, nullptr);
+    }
+
+    for (auto& [key, layout] : layouts) {
+        vkDestroyPipelineLayout(device, layout, nullptr);
+    }
+
+    pipelines.clear();
+    layouts.clear();
+    vkDestroyPipelineCache(device, pipelineCache, nullptr);
+}
+
+VkPipelineCache PipelineCache::getHandle() { return pipelineCache; }
+
+size_t PipelineCache::getPipelineCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return pipelines.size();
+}
+
+uint32_t PipelineCache::getHitCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return hitCount;
+}
+
+size_t PipelineCache::KeyHash::operator()(const Key& key) const {
+    return static_cast<size_t>(hashBytes(key.data(), key.size()));
+}
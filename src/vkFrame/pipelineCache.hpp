@@ -0,0 +1,69 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cinttypes>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "hash.hpp"
+
+/*
+ * Keeps every pipeline permutation that has been compiled, keyed by all of the state it was
+ * created from, so pipelines that differ only in which object asked for them are compiled once
+ * and shared. Pipeline layouts are shared the same way by their set layouts and push constant
+ * ranges. Everything the cache hands out lives until the cache is destroyed. Compilation goes
+ * through a VkPipelineCache, so the driver can reuse work across permutations as well, and
+ * saving it lets the next run skip most of the compiles. All methods but create, save and
+ * destroy may be called from the compiler's worker threads.
+ */
+class PipelineCache {
+  public:
+    using Key = std::vector<uint8_t>;
+
+    // Seeds the driver cache with the data saved to path by an earlier run, if there is any.
+    void create(VkDevice device, const std::string& path = "");
+    void save(VkDevice device, const std::string& path);
+    VkPipelineLayout getLayout(VkDevice device,
+                               const std::vector<VkDescriptorSetLayout>& setLayouts,
+                               const std::vector<VkPushConstantRange>& pushConstantRanges);
+    // Returns the pipeline cached for the key, compiling it with createPipeline on a miss.
+    VkPipeline get(VkDevice device, const Key& key,
+                   std::function<VkPipeline(VkPipelineCache)> createPipeline);
+    void destroy(VkDevice device);
+
+    VkPipelineCache getHandle();
+    size_t getPipelineCount();
+    uint32_t getHitCount();
+
+    template <typename T> static void appendKey(Key& key, const T& value) {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+        key.insert(key.end(), bytes, bytes + sizeof(T));
+    }
+
+    static void appendKey(Key& key, const void* data, size_t byteSize) {
+        appendKey(key, byteSize);
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        key.insert(key.end(), bytes, bytes + byteSize);
+    }
+
+    static void appendKey(Key& key, const std::string& value) {
+        appendKey(key, value.data(), value.size());
+    }
+
+  private:
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+
+    VkPipelineCache pipelineCache = VK_NULL_HANDLE;
+    std::mutex mutex;
+    std::unordered_map<Key, VkPipeline, KeyHash> pipelines;
+    std::unordered_map<Key, VkPipelineLayout, KeyHash> layouts;
+    uint32_t hitCount = 0;
+};
@@ -0,0 +1,82 @@
+#include "pipelineCompiler.hpp"
+
+#include <algorithm>
+
+void PipelineCompiler::create(uint32_t threadCount) {
+    if (!threads.empty()) {
+        throw std::runtime_error("Pipeline compiler is already running!");
+    }
+
+    if (threadCount == 0) {
+        threadCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+    }
+
+    stopping = false;
+
+    for (uint32_t i = 0; i < threadCount; i++) {
+        threads.emplace_back(&PipelineCompiler::work, this);
+    }
+}
+
+std::future<VkPipeline> PipelineCompiler::submit(std::function<VkPipeline()> compile) {
+    std::packaged_task<VkPipeline()> job(std::move(compile));
+    std::future<VkPipeline> result = job.get_future();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (threads.empty()) {
+            throw std::runtime_error("Pipeline compiler isn't running!");
+        }
+
+        jobs.push_back(std::move(job));
+    }
+
+    jobAdded.notify_one();
+    return result;
+}
+
+void PipelineCompiler::destroy() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+
+    jobAdded.notify_all();
+
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    threads.clear();
+}
+
+uint32_t PipelineCompiler::getPendingCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return static_cast<uint32_t>(jobs.size()) + runningCount;
+}
+
+void PipelineCompiler::work() {
+    while (true) {
+        std::packaged_task<VkPipeline()> job;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            jobAdded.wait(lock, [this] { return stopping || !jobs.empty(); });
+
+            if (jobs.empty()) {
+                return;
+            }
+
+            job = std::move(jobs.front());
+            jobs.pop_front();
+            runningCount++;
+        }
+
+        // The task stores any exception in its future.
+        job();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        runningCount--;
+    }
+}
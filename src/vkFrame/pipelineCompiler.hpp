@@ -0,0 +1,38 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cinttypes>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+/*
+ * Worker threads that compile pipelines in the background. Jobs run in submission order, and
+ * exceptions thrown while compiling are rethrown from the returned future.
+ */
+class PipelineCompiler {
+  public:
+    // A thread count of 0 uses one thread per core, leaving one for the render loop.
+    void create(uint32_t threadCount = 0);
+    std::future<VkPipeline> submit(std::function<VkPipeline()> compile);
+    // Finishes the queued jobs before joining the threads.
+    void destroy();
+
+    uint32_t getPendingCount();
+
+  private:
+    void work();
+
+    std::vector<std::thread> threads;
+    std::deque<std::packaged_task<VkPipeline()>> jobs;
+    std::mutex mutex;
+    std::condition_variable jobAdded;
+    uint32_t runningCount = 0;
+    bool stopping = false;
+};
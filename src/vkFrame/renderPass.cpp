@@ -1,13 +1,35 @@
 #include "renderPass.hpp"
 #include "swapchain.hpp"
 
+void RenderPass::setDynamicRendering(const DeviceExtensions& extensions) {
+    if (!extensions.dynamicRendering) {
+        throw std::runtime_error("Dynamic rendering isn't supported!");
+    }
+
+    dynamicRenderingExtensions = &extensions;
+}
+
 void RenderPass::createCustom(
     VkDevice device, Swapchain& swapchain, std::function<VkRenderPass()> setupRenderPass,
     std::function<void(const VkExtent2D& extent)> recreateCallback,
     std::function<void()> cleanupCallback,
     std::function<void(std::vector<VkImageView>& attachments, VkImageView imageView)>
         setupFramebuffer) {
+    // Dynamic rendering only knows the attachments create sets up.
+    if (dynamicRenderingExtensions != nullptr) {
+        throw std::invalid_argument("Custom render passes can't use dynamic rendering!");
+    }
 
+    createPass(device, swapchain, setupRenderPass, recreateCallback, cleanupCallback,
+               setupFramebuffer);
+}
+
+void RenderPass::createPass(
+    VkDevice device, Swapchain& swapchain, std::function<VkRenderPass()> setupRenderPass,
+    std::function<void(const VkExtent2D& extent)> recreateCallback,
+    std::function<void()> cleanupCallback,
+    std::function<void(std::vector<VkImageView>& attachments, VkImageView imageView)>
+        setupFramebuffer) {
     imageFormat = swapchain.getImageFormat();
 
     this->cleanupCallback = cleanupCallback;
@@ -25,11 +47,18 @@ void RenderPass::createCustom(
 }
 
 void RenderPass::create(VkPhysicalDevice physicalDevice, VkDevice device, VmaAllocator allocator,
-                        Swapchain& swapchain, bool enableDepth, bool enableMsaa) {
+                        Swapchain& swapchain, bool enableDepth, bool enableMsaa,
+                        bool storeDepth) {
+    if (storeDepth && (!enableDepth || enableMsaa)) {
+        throw std::invalid_argument("Stored depth needs a depth attachment without MSAA!");
+    }
+
     std::function<VkRenderPass()> setupRenderPass = [&] {
         depthEnabled = enableDepth;
+        depthStored = storeDepth;
         msaaSamples = enableMsaa ? getMaxUsableSamples(physicalDevice) : VK_SAMPLE_COUNT_1_BIT;
         msaaEnabled = msaaSamples != VK_SAMPLE_COUNT_1_BIT;
+        depthFormat = findDepthFormat(physicalDevice);
 
         VkAttachmentDescription colorAttachment{};
         colorAttachment.format = imageFormat;
@@ -43,10 +72,11 @@ void RenderPass::create(VkPhysicalDevice physicalDevice, VkDevice device, VmaAll
                                                   : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 
         VkAttachmentDescription depthAttachment{};
-        depthAttachment.format = findDepthFormat(physicalDevice);
+        depthAttachment.format = depthFormat;
         depthAttachment.samples = msaaSamples;
         depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-        depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        depthAttachment.storeOp =
+            depthStored ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
         depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
         depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
         depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
@@ -113,12 +143,37 @@ void RenderPass::create(VkPhysicalDevice physicalDevice, VkDevice device, VmaAll
         renderPassInfo.dependencyCount = 1;
         renderPassInfo.pDependencies = &dependency;
 
-        VkRenderPass renderPass;
+        VkRenderPass renderPass = VK_NULL_HANDLE;
+
+        // Dynamic rendering describes the attachments when it begins, so no pass is created.
+        if (dynamicRenderingExtensions != nullptr) {
+            return renderPass;
+        }
 
         if (vkCreateRenderPass(device, &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS) {
             throw std::runtime_error("Failed to create render pass!");
         }
 
+        if (depthStored) {
+            // Only load ops, layouts and the dependency differ, so the resumed pass stays
+            // compatible with the framebuffers and pipelines of the first one.
+            attachments[0].loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+            attachments[0].initialLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+            attachments[1].loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+            attachments[1].initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+            dependency.srcStageMask |= VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+            dependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+                                       VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+            dependency.dstAccessMask |= VK_ACCESS_COLOR_ATTACHMENT_READ_BIT |
+                                        VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
+
+            if (vkCreateRenderPass(device, &renderPassInfo, nullptr, &resumeRenderPass) !=
+                VK_SUCCESS) {
+                throw std::runtime_error("Failed to create resumed render pass!");
+            }
+        }
+
         return renderPass;
     };
 
@@ -149,8 +204,8 @@ void RenderPass::create(VkPhysicalDevice physicalDevice, VkDevice device, VmaAll
             }
         };
 
-    createCustom(device, swapchain, setupRenderPass, recreateCallback, cleanupCallback,
-                 setupFramebuffer);
+    createPass(device, swapchain, setupRenderPass, recreateCallback, cleanupCallback,
+               setupFramebuffer);
 }
 
 void RenderPass::createImages(VkDevice device, Swapchain& swapchain) {
@@ -170,10 +225,38 @@ void RenderPass::createImages(VkDevice device, Swapchain& swapchain) {
 }
 
 void RenderPass::begin(const uint32_t imageIndex, VkCommandBuffer commandBuffer, VkExtent2D extent,
-                       const std::vector<VkClearValue>& clearValues) {
+                       const std::vector<VkClearValue>& clearValues,
+                       StateTracker* stateTracker) {
+    if (dynamicRenderingExtensions != nullptr) {
+        beginRendering(imageIndex, commandBuffer, extent, clearValues, false);
+    } else {
+        beginPass(renderPass, imageIndex, commandBuffer, extent, clearValues);
+    }
+
+    setViewportAndScissor(commandBuffer, extent, stateTracker);
+}
+
+void RenderPass::resume(const uint32_t imageIndex, VkCommandBuffer commandBuffer,
+                        VkExtent2D extent, StateTracker* stateTracker) {
+    if (!depthStored) {
+        throw std::runtime_error("Only render passes with stored depth can be resumed!");
+    }
+
+    if (dynamicRenderingExtensions != nullptr) {
+        beginRendering(imageIndex, commandBuffer, extent, {}, true);
+    } else {
+        beginPass(resumeRenderPass, imageIndex, commandBuffer, extent, {});
+    }
+
+    setViewportAndScissor(commandBuffer, extent, stateTracker);
+}
+
+void RenderPass::beginPass(VkRenderPass pass, const uint32_t imageIndex,
+                           VkCommandBuffer commandBuffer, VkExtent2D extent,
+                           const std::vector<VkClearValue>& clearValues) {
     VkRenderPassBeginInfo renderPassInfo{};
     renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    renderPassInfo.renderPass = renderPass;
+    renderPassInfo.renderPass = pass;
     renderPassInfo.framebuffer = framebuffers[imageIndex];
     renderPassInfo.renderArea.offset = {0, 0};
     renderPassInfo.renderArea.extent = extent;
@@ -182,23 +265,124 @@ void RenderPass::begin(const uint32_t imageIndex, VkCommandBuffer commandBuffer,
     renderPassInfo.pClearValues = clearValues.data();
 
     vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+}
+
+void RenderPass::beginRendering(const uint32_t imageIndex, VkCommandBuffer commandBuffer,
+                                VkExtent2D extent, const std::vector<VkClearValue>& clearValues,
+                                bool resume) {
+#ifdef VK_KHR_dynamic_rendering
+    if (!resume && clearValues.size() < (depthEnabled ? 2u : 1u)) {
+        throw std::invalid_argument("Every cleared attachment needs a clear value!");
+    }
+
+    renderingImageIndex = imageIndex;
+    Image& image = images[imageIndex];
+
+    if (!resume) {
+        // Cleared attachments are transitioned from undefined. The swapchain image is only
+        // available once the acquire semaphore is waited on at color attachment output.
+        ImageAccess colorAccess = {VK_IMAGE_LAYOUT_UNDEFINED,
+                                   VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0};
+        image.setSubresourceAccess(colorAccess);
+        colorImage.setSubresourceAccess(colorAccess);
+        depthImage.setSubresourceAccess({VK_IMAGE_LAYOUT_UNDEFINED,
+                                         VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT |
+                                             VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                                         0});
+    }
+
+    BarrierBatch barriers;
+    barriers.transition(image, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+
+    if (msaaEnabled) {
+        barriers.transition(colorImage, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+    }
+
+    if (depthEnabled) {
+        barriers.transition(depthImage, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+    }
+
+    barriers.flush(commandBuffer);
+
+    VkRenderingAttachmentInfoKHR colorAttachment{};
+    colorAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+    colorAttachment.imageView = msaaEnabled ? colorImageView : imageViews[imageIndex];
+    colorAttachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    colorAttachment.loadOp = resume ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_CLEAR;
+    colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+
+    if (msaaEnabled) {
+        colorAttachment.resolveMode = VK_RESOLVE_MODE_AVERAGE_BIT_KHR;
+        colorAttachment.resolveImageView = imageViews[imageIndex];
+        colorAttachment.resolveImageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    }
 
-    VkViewport viewport{};
+    VkRenderingAttachmentInfoKHR depthAttachment{};
+    depthAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+    depthAttachment.imageView = depthImageView;
+    depthAttachment.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    depthAttachment.loadOp = colorAttachment.loadOp;
+    depthAttachment.storeOp =
+        depthStored ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+
+    if (!resume) {
+        colorAttachment.clearValue = clearValues[0];
+
+        if (depthEnabled) {
+            depthAttachment.clearValue = clearValues[1];
+        }
+    }
+
+    VkRenderingInfoKHR renderingInfo{};
+    renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR;
+    renderingInfo.renderArea.offset = {0, 0};
+    renderingInfo.renderArea.extent = extent;
+    renderingInfo.layerCount = 1;
+    renderingInfo.colorAttachmentCount = 1;
+    renderingInfo.pColorAttachments = &colorAttachment;
+    renderingInfo.pDepthAttachment = depthEnabled ? &depthAttachment : nullptr;
+
+    dynamicRenderingExtensions->cmdBeginRendering(commandBuffer, &renderingInfo);
+#endif
+}
+
+void RenderPass::setViewportAndScissor(VkCommandBuffer commandBuffer, VkExtent2D extent,
+                                       StateTracker* stateTracker) {
     viewport.x = 0.0f;
     viewport.y = 0.0f;
     viewport.width = static_cast<float>(extent.width);
     viewport.height = static_cast<float>(extent.height);
     viewport.minDepth = 0.0f;
     viewport.maxDepth = 1.0f;
-    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
 
-    VkRect2D scissor{};
     scissor.offset = {0, 0};
     scissor.extent = extent;
+
+    if (stateTracker != nullptr) {
+        stateTracker->setViewport(commandBuffer, viewport);
+        stateTracker->setScissor(commandBuffer, scissor);
+        return;
+    }
+
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
     vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 }
 
-void RenderPass::end(VkCommandBuffer commandBuffer) { vkCmdEndRenderPass(commandBuffer); }
+void RenderPass::end(VkCommandBuffer commandBuffer) {
+    if (dynamicRenderingExtensions == nullptr) {
+        vkCmdEndRenderPass(commandBuffer);
+        return;
+    }
+
+#ifdef VK_KHR_dynamic_rendering
+    dynamicRenderingExtensions->cmdEndRendering(commandBuffer);
+
+    // Depth is left in its attachment layout, like the final layout of the render pass.
+    BarrierBatch barriers;
+    barriers.transition(images[renderingImageIndex], VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+    barriers.flush(commandBuffer);
+#endif
+}
 
 const VkRenderPass& RenderPass::getRenderPass() { return renderPass; }
 
@@ -206,6 +390,24 @@ const VkSampleCountFlagBits RenderPass::getMsaaSamples() { return msaaSamples; }
 
 const bool RenderPass::getMsaaEnabled() { return msaaEnabled; }
 
+const bool RenderPass::getDepthEnabled() { return depthEnabled; }
+
+const bool RenderPass::getDynamicRenderingEnabled() {
+    return dynamicRenderingExtensions != nullptr;
+}
+
+VkFormat RenderPass::getColorFormat() { return imageFormat; }
+
+VkFormat RenderPass::getDepthFormat() { return depthFormat; }
+
+Image& RenderPass::getDepthImage() { return depthImage; }
+
+const VkImageView& RenderPass::getDepthImageView() { return depthImageView; }
+
+const VkViewport& RenderPass::getViewport() { return viewport; }
+
+const VkRect2D& RenderPass::getScissor() { return scissor; }
+
 void RenderPass::createImageViews(VkDevice device) {
     imageViews.resize(images.size());
 
@@ -215,6 +417,11 @@ void RenderPass::createImageViews(VkDevice device) {
 }
 
 void RenderPass::createFramebuffers(VkDevice device, VkExtent2D extent) {
+    // Dynamic rendering draws into the image views directly.
+    if (dynamicRenderingExtensions != nullptr) {
+        return;
+    }
+
     framebuffers.resize(imageViews.size());
 
     for (size_t i = 0; i < imageViews.size(); i++) {
@@ -241,9 +448,14 @@ void RenderPass::createDepthResources(VmaAllocator allocator, VkPhysicalDevice p
                                       VkDevice device, VkExtent2D extent) {
     VkFormat depthFormat = findDepthFormat(physicalDevice);
 
+    VkImageUsageFlags usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+
+    if (depthStored) {
+        usage |= VK_IMAGE_USAGE_SAMPLED_BIT;
+    }
+
     depthImage = Image(allocator, extent.width, extent.height, depthFormat, VK_IMAGE_TILING_OPTIMAL,
-                       VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
-                       VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 1, 1, msaaSamples);
+                       usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 1, 1, msaaSamples);
     depthImageView = depthImage.createView(VK_IMAGE_ASPECT_DEPTH_BIT, device);
 }
 
@@ -309,6 +521,10 @@ void RenderPass::cleanupForRecreation(VmaAllocator allocator, VkDevice device) {
 void RenderPass::cleanup(VmaAllocator allocator, VkDevice device) {
     cleanupForRecreation(allocator, device);
     vkDestroyRenderPass(device, renderPass, nullptr);
+
+    if (resumeRenderPass != VK_NULL_HANDLE) {
+        vkDestroyRenderPass(device, resumeRenderPass, nullptr);
+    }
 }
 
 const VkFramebuffer& RenderPass::getFramebuffer(const uint32_t imageIndex) {
@@ -7,11 +7,18 @@
 #include <functional>
 #include <vector>
 
+#include "barriers.hpp"
+#include "deviceExtensions.hpp"
 #include "image.hpp"
+#include "stateTracker.hpp"
 #include "swapchain.hpp"
 
 class RenderPass {
   public:
+    // Has to be called before create. The pass is then recorded with vkCmdBeginRendering instead
+    // of a VkRenderPass and framebuffers, which is what shader objects have to be drawn in, and
+    // pipelines are compiled against its attachment formats. Custom passes can't use it.
+    void setDynamicRendering(const DeviceExtensions& extensions);
     void
     createCustom(VkDevice device, Swapchain& swapchain,
                  std::function<VkRenderPass()> setupRenderPass,
@@ -19,13 +26,20 @@ class RenderPass {
                  std::function<void()> cleanupCallback,
                  std::function<void(std::vector<VkImageView>& attachments, VkImageView imageView)>
                      setupFramebuffer);
+    // Stored depth stays valid after the pass so it can be sampled, for example to build a depth
+    // pyramid, and the pass can be resumed on top of it. It can't be combined with MSAA.
     void create(VkPhysicalDevice physicalDevice, VkDevice device, VmaAllocator allocator,
-                Swapchain& swapchain, bool enableDepth, bool enableMsaa);
+                Swapchain& swapchain, bool enableDepth, bool enableMsaa, bool storeDepth = false);
     void recreate(VkPhysicalDevice physicalDevice, VkDevice device, VmaAllocator allocator,
                   Swapchain& swapchain);
 
     void begin(const uint32_t imageIndex, VkCommandBuffer commandBuffer, VkExtent2D extent,
-               const std::vector<VkClearValue>& clearValues);
+               const std::vector<VkClearValue>& clearValues,
+               StateTracker* stateTracker = nullptr);
+    // Begins a pass that loads the color and depth left by the previous one instead of clearing
+    // them. The depth image must be back in VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL.
+    void resume(const uint32_t imageIndex, VkCommandBuffer commandBuffer, VkExtent2D extent,
+                StateTracker* stateTracker = nullptr);
     void end(VkCommandBuffer commandBuffer);
 
     VkFormat findSupportedFormat(VkPhysicalDevice physicalDevice,
@@ -37,10 +51,35 @@ class RenderPass {
     const VkFramebuffer& getFramebuffer(const uint32_t imageIndex);
     const VkSampleCountFlagBits getMsaaSamples();
     const bool getMsaaEnabled();
+    const bool getDepthEnabled();
+    const bool getDynamicRenderingEnabled();
+    VkFormat getColorFormat();
+    VkFormat getDepthFormat();
+    Image& getDepthImage();
+    const VkImageView& getDepthImageView();
+    // The viewport and scissor set by the last begin or resume.
+    const VkViewport& getViewport();
+    const VkRect2D& getScissor();
 
     void cleanup(VmaAllocator, VkDevice device);
 
   private:
+    void createPass(VkDevice device, Swapchain& swapchain,
+                    std::function<VkRenderPass()> setupRenderPass,
+                    std::function<void(const VkExtent2D& extent)> recreateCallback,
+                    std::function<void()> cleanupCallback,
+                    std::function<void(std::vector<VkImageView>& attachments,
+                                       VkImageView imageView)>
+                        setupFramebuffer);
+    void beginPass(VkRenderPass pass, const uint32_t imageIndex, VkCommandBuffer commandBuffer,
+                   VkExtent2D extent, const std::vector<VkClearValue>& clearValues);
+    // Moves the attachments to their attachment layouts itself, as there is no render pass to do
+    // it. Resuming keeps their contents.
+    void beginRendering(const uint32_t imageIndex, VkCommandBuffer commandBuffer,
+                        VkExtent2D extent, const std::vector<VkClearValue>& clearValues,
+                        bool resume);
+    void setViewportAndScissor(VkCommandBuffer commandBuffer, VkExtent2D extent,
+                               StateTracker* stateTracker);
     void createImages(VkDevice device, Swapchain& swapchain);
     void createFramebuffers(VkDevice device, VkExtent2D extent);
     void createDepthResources(VmaAllocator allocator, VkPhysicalDevice physicalDevice,
@@ -58,6 +97,7 @@ class RenderPass {
         setupFramebuffer;
 
     VkRenderPass renderPass;
+    VkRenderPass resumeRenderPass = VK_NULL_HANDLE;
 
     std::vector<Image> images;
     std::vector<VkImageView> imageViews;
@@ -68,7 +108,14 @@ class RenderPass {
     Image colorImage;
     VkImageView colorImageView;
     VkFormat imageFormat;
+    VkFormat depthFormat = VK_FORMAT_UNDEFINED;
     bool depthEnabled = false;
+    bool depthStored = false;
     bool msaaEnabled = false;
     VkSampleCountFlagBits msaaSamples = VK_SAMPLE_COUNT_1_BIT;
+    VkViewport viewport{};
+    VkRect2D scissor{};
+
+    const DeviceExtensions* dynamicRenderingExtensions = nullptr;
+    uint32_t renderingImageIndex = 0;
 };
\ No newline at end of file
@@ -0,0 +1,180 @@
+#include "renderQueue.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+const uint32_t passShift = 60;
+const uint32_t transparentShift = 59;
+
+uint16_t RenderQueue::addMaterial(
+    std::function<void(VkCommandBuffer commandBuffer, Pipeline& pipeline, uint32_t currentFrame)>
+        bindMaterial) {
+    if (materials.size() >= NoMaterial) {
+        throw std::runtime_error("Exceeded the maximum number of materials!");
+    }
+
+    materials.push_back(bindMaterial);
+    return static_cast<uint16_t>(materials.size() - 1);
+}
+
+void RenderQueue::addDraw(uint32_t pass, const Draw& draw, float depth) {
+    if (pass >= MaxPasses) {
+        throw std::invalid_argument("Render queue pass is out of range!");
+    }
+
+    if (draw.materialSystem == nullptr && draw.material != NoMaterial &&
+        draw.material >= materials.size()) {
+        throw std::invalid_argument("Unknown render queue material!");
+    }
+
+    uint64_t pipelineId = getPipelineId(*draw.pipeline);
+    uint64_t material = draw.material;
+    uint64_t depthBits = getDepthBits(depth);
+    uint64_t key = static_cast<uint64_t>(pass) << passShift;
+
+    if (draw.pipeline->getTransparencyEnabled()) {
+        key |= 1ull << transparentShift;
+        key |= static_cast<uint64_t>(UINT32_MAX - depthBits) << 27;
+        key |= pipelineId << 16;
+        key |= material;
+    } else {
+        key |= pipelineId << 48;
+        key |= material << 32;
+        key |= depthBits;
+    }
+
+    entries.push_back({key, static_cast<uint32_t>(draws.size())});
+    draws.push_back(draw);
+    sorted = false;
+}
+
+void RenderQueue::execute(VkCommandBuffer commandBuffer, uint32_t currentFrame, uint32_t pass,
+                          StateTracker* stateTracker) {
+    if (!sorted) {
+        sort();
+    }
+
+    auto passBegin = std::lower_bound(
+        entries.begin(), entries.end(), static_cast<uint64_t>(pass) << passShift,
+        [](const SortEntry& entry, uint64_t key) { return entry.key < key; });
+
+    Pipeline* boundPipeline = nullptr;
+    MaterialSystem* boundMaterialSystem = nullptr;
+    uint16_t boundMaterial = NoMaterial;
+    const void* boundGeometry = nullptr;
+
+    for (auto it = passBegin; it != entries.end() && (it->key >> passShift) == pass; it++) {
+        Draw& draw = draws[it->draw];
+
+        // Binding another pipeline may disturb the material's sets, so it is bound again.
+        if (draw.pipeline != boundPipeline) {
+            draw.pipeline->bind(commandBuffer, currentFrame, stateTracker);
+            boundPipeline = draw.pipeline;
+            boundMaterial = NoMaterial;
+        } else {
+            skippedBindCount++;
+        }
+
+        if (draw.material != boundMaterial || draw.materialSystem != boundMaterialSystem) {
+            if (draw.materialSystem != nullptr) {
+                draw.materialSystem->bind(commandBuffer, draw.material, stateTracker);
+            } else if (draw.material != NoMaterial) {
+                materials[draw.material](commandBuffer, *draw.pipeline, currentFrame);
+            }
+
+            boundMaterialSystem = draw.materialSystem;
+            boundMaterial = draw.material;
+        } else if (draw.material != NoMaterial) {
+            skippedBindCount++;
+        }
+
+        // Vertex and index buffers stay bound across pipeline changes.
+        if (draw.geometry != boundGeometry) {
+            draw.bindBuffers(commandBuffer, stateTracker);
+            boundGeometry = draw.geometry;
+        } else {
+            skippedBindCount++;
+        }
+
+        vkCmdDrawIndexed(commandBuffer, draw.command.indexCount, draw.command.instanceCount,
+                         draw.command.firstIndex, draw.command.vertexOffset,
+                         draw.command.firstInstance);
+    }
+}
+
+void RenderQueue::clear() {
+    draws.clear();
+    entries.clear();
+    sorted = true;
+    skippedBindCount = 0;
+}
+
+uint32_t RenderQueue::getDrawCount() { return static_cast<uint32_t>(draws.size()); }
+
+uint32_t RenderQueue::getSkippedBindCount() { return skippedBindCount; }
+
+// Least significant digit first radix sort on 8-bit digits, which keeps the submission order of
+// equal keys. Digits that are the same in every key, such as unused passes, are skipped.
+void RenderQueue::sort() {
+    sorted = true;
+
+    if (entries.empty()) {
+        return;
+    }
+
+    scratch.resize(entries.size());
+
+    for (uint32_t shift = 0; shift < 64; shift += 8) {
+        std::array<uint32_t, 256> counts{};
+
+        for (const SortEntry& entry : entries) {
+            counts[(entry.key >> shift) & 0xFF]++;
+        }
+
+        if (counts[(entries.front().key >> shift) & 0xFF] == entries.size()) {
+            continue;
+        }
+
+        uint32_t offset = 0;
+
+        for (uint32_t& count : counts) {
+            uint32_t digitCount = count;
+            count = offset;
+            offset += digitCount;
+        }
+
+        for (const SortEntry& entry : entries) {
+            scratch[counts[(entry.key >> shift) & 0xFF]++] = entry;
+        }
+
+        entries.swap(scratch);
+    }
+}
+
+uint16_t RenderQueue::getPipelineId(Pipeline& pipeline) {
+    auto it = pipelineIds.find(&pipeline);
+
+    if (it != pipelineIds.end()) {
+        return it->second;
+    }
+
+    if (pipelineIds.size() >= MaxPipelines) {
+        throw std::runtime_error("Exceeded the maximum number of render queue pipelines!");
+    }
+
+    uint16_t id = static_cast<uint16_t>(pipelineIds.size());
+    pipelineIds[&pipeline] = id;
+
+    return id;
+}
+
+uint32_t RenderQueue::getDepthBits(float depth) {
+    // The bits of non-negative floats sort like the floats themselves.
+    depth = std::max(depth, 0.0f);
+
+    uint32_t bits;
+    memcpy(&bits, &depth, sizeof(bits));
+
+    return bits;
+}
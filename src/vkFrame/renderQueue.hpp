@@ -0,0 +1,112 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cinttypes>
+#include <functional>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include "materialSystem.hpp"
+#include "model.hpp"
+#include "pipeline.hpp"
+
+/*
+ * Collects the draws of a frame as 64-bit sort keys and replays them in key order, skipping
+ * pipeline, material and buffer binds that are already in place. From the most significant bit
+ * down, a key holds the pass, whether the pipeline is transparent and then either the pipeline,
+ * material and depth for opaque draws, which are drawn front to back within a state, or the
+ * inverted depth, pipeline and material for transparent ones, which are drawn back to front.
+ */
+class RenderQueue {
+  public:
+    static const uint16_t NoMaterial = UINT16_MAX;
+    static const uint32_t MaxPasses = 16;
+    static const uint32_t MaxPipelines = 2048;
+
+    // Binds whatever a material adds to its pipeline, such as descriptor sets or push constants.
+    uint16_t addMaterial(
+        std::function<void(VkCommandBuffer commandBuffer, Pipeline& pipeline,
+                           uint32_t currentFrame)>
+            bindMaterial);
+
+    // Depth is the distance from the camera, only its order within a pass matters.
+    template <typename V, typename I, typename D>
+    void submit(uint32_t pass, Pipeline& pipeline, Model<V, I, D>& model, float depth,
+                uint16_t material = NoMaterial) {
+        if (!model.isDrawable())
+            return;
+
+        Draw draw{};
+        draw.pipeline = &pipeline;
+        draw.material = material;
+        draw.geometry = &model;
+        draw.bindBuffers = [&model](VkCommandBuffer commandBuffer, StateTracker* stateTracker) {
+            model.bindBuffers(commandBuffer, stateTracker);
+        };
+        draw.command = model.getDrawCommand();
+
+        addDraw(pass, draw, depth);
+    }
+
+    // Draws with a material of the material system, which also decides the pipeline.
+    template <typename V, typename I, typename D>
+    void submit(uint32_t pass, MaterialSystem& materialSystem, uint16_t material,
+                Model<V, I, D>& model, float depth) {
+        if (!model.isDrawable())
+            return;
+
+        Draw draw{};
+        draw.pipeline = &materialSystem.getPipeline(material);
+        draw.materialSystem = &materialSystem;
+        draw.material = material;
+        draw.geometry = &model;
+        draw.bindBuffers = [&model](VkCommandBuffer commandBuffer, StateTracker* stateTracker) {
+            model.bindBuffers(commandBuffer, stateTracker);
+        };
+        draw.command = model.getDrawCommand();
+
+        addDraw(pass, draw, depth);
+    }
+
+    // Draws everything submitted for the pass, which has to match the render pass being recorded.
+    void execute(VkCommandBuffer commandBuffer, uint32_t currentFrame, uint32_t pass = 0,
+                 StateTracker* stateTracker = nullptr);
+    // Forgets the frame's draws, pipelines and materials stay registered.
+    void clear();
+
+    uint32_t getDrawCount();
+    uint32_t getSkippedBindCount();
+
+  private:
+    struct Draw {
+        Pipeline* pipeline;
+        // Set when the material comes from a material system instead of addMaterial.
+        MaterialSystem* materialSystem;
+        uint16_t material;
+        const void* geometry;
+        std::function<void(VkCommandBuffer, StateTracker*)> bindBuffers;
+        VkDrawIndexedIndirectCommand command;
+    };
+
+    struct SortEntry {
+        uint64_t key;
+        uint32_t draw;
+    };
+
+    void addDraw(uint32_t pass, const Draw& draw, float depth);
+    void sort();
+    uint16_t getPipelineId(Pipeline& pipeline);
+
+    static uint32_t getDepthBits(float depth);
+
+    std::vector<Draw> draws;
+    std::vector<SortEntry> entries;
+    std::vector<SortEntry> scratch;
+    bool sorted = true;
+
+    std::unordered_map<Pipeline*, uint16_t> pipelineIds;
+    std::vector<std::function<void(VkCommandBuffer, Pipeline&, uint32_t)>> materials;
+    uint32_t skippedBindCount = 0;
+};
@@ -4,6 +4,8 @@ const std::vector<const char*> validationLayers = {"VK_LAYER_KHRONOS_validation"
 
 const std::vector<const char*> deviceExtensions = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
 
+const VkDeviceSize stagingRingFrameSize = 8 * 1024 * 1024;
+
 #ifdef NDEBUG
 const bool enableValidationLayers = false;
 #else
@@ -76,11 +78,21 @@ void Renderer::initVulkan(
     createLogicalDevice();
     createAllocator();
 
+    vulkanState.samplerCache.create(vulkanState.physicalDevice);
+
     int32_t width;
     int32_t height;
     glfwGetFramebufferSize(window, &width, &height);
 
     vulkanState.maxFramesInFlight = maxFramesInFlight;
+    vulkanState.stagingRing.create(vulkanState.allocator, stagingRingFrameSize, maxFramesInFlight);
+    vulkanState.descriptorAllocator.create();
+    vulkanState.frameDescriptorAllocators.resize(maxFramesInFlight);
+    vulkanState.stateTrackers.resize(maxFramesInFlight);
+
+    for (DescriptorAllocator& frameDescriptorAllocator : vulkanState.frameDescriptorAllocators) {
+        frameDescriptorAllocator.create();
+    }
 
     initCallback(vulkanState, window, width, height);
 
@@ -100,6 +112,14 @@ void Renderer::createAllocator() {
     aci.instance = instance;
     aci.pVulkanFunctions = &vkFuncs;
 
+    if (vulkanState.extensions.memoryBudget) {
+        aci.flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
+    }
+
+    if (vulkanState.extensions.bufferDeviceAddress) {
+        aci.flags |= VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT;
+    }
+
     vmaCreateAllocator(&aci, &vulkanState.allocator);
 }
 
@@ -134,6 +154,17 @@ void Renderer::cleanup(std::function<void(VulkanState& vulkanState)> cleanupCall
 
     cleanupCallback(vulkanState);
 
+    vulkanState.imageViewCache.destroy(vulkanState.device);
+    vulkanState.samplerCache.destroy(vulkanState.device);
+    vulkanState.stagingRing.destroy(vulkanState.allocator);
+
+    for (DescriptorAllocator& frameDescriptorAllocator : vulkanState.frameDescriptorAllocators) {
+        frameDescriptorAllocator.destroy(vulkanState.device);
+    }
+
+    vulkanState.descriptorAllocator.destroy(vulkanState.device);
+    vulkanState.descriptorLayoutCache.destroy(vulkanState.device);
+
     vmaDestroyAllocator(vulkanState.allocator);
 
     for (size_t i = 0; i < vulkanState.maxFramesInFlight; i++) {
@@ -269,9 +300,18 @@ void Renderer::createLogicalDevice() {
         queueCreateInfos.push_back(queueCreateInfo);
     }
 
+    VkPhysicalDeviceFeatures supportedFeatures{};
+    vkGetPhysicalDeviceFeatures(vulkanState.physicalDevice, &supportedFeatures);
+
     VkPhysicalDeviceFeatures deviceFeatures{};
     deviceFeatures.samplerAnisotropy = VK_TRUE;
     deviceFeatures.sampleRateShading = VK_TRUE;
+    deviceFeatures.textureCompressionBC = supportedFeatures.textureCompressionBC;
+    vulkanState.extensions.textureCompressionBC = supportedFeatures.textureCompressionBC;
+    deviceFeatures.multiDrawIndirect = supportedFeatures.multiDrawIndirect;
+    vulkanState.extensions.multiDrawIndirect = supportedFeatures.multiDrawIndirect;
+    deviceFeatures.drawIndirectFirstInstance = supportedFeatures.drawIndirectFirstInstance;
+    vulkanState.extensions.drawIndirectFirstInstance = supportedFeatures.drawIndirectFirstInstance;
 
     VkDeviceCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
@@ -281,8 +321,151 @@ void Renderer::createLogicalDevice() {
 
     createInfo.pEnabledFeatures = &deviceFeatures;
 
-    createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-    createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+    std::vector<const char*> enabledExtensions = deviceExtensions;
+
+    if (checkOptionalExtensionSupport(vulkanState.physicalDevice,
+                                      VK_EXT_MEMORY_BUDGET_EXTENSION_NAME)) {
+        enabledExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+        vulkanState.extensions.memoryBudget = true;
+    }
+
+    if (checkOptionalExtensionSupport(vulkanState.physicalDevice,
+                                      VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME)) {
+        enabledExtensions.push_back(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME);
+        vulkanState.extensions.pushDescriptor = true;
+    }
+
+    // Optional features are chained onto the create info for every extension that is enabled.
+    void* featuresChain = nullptr;
+
+#ifdef VK_EXT_host_image_copy
+    VkPhysicalDeviceHostImageCopyFeaturesEXT hostImageCopyFeatures{};
+    hostImageCopyFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_FEATURES_EXT;
+    hostImageCopyFeatures.hostImageCopy = VK_TRUE;
+
+    if (checkHostImageCopySupport(vulkanState.physicalDevice)) {
+        enabledExtensions.push_back(VK_EXT_HOST_IMAGE_COPY_EXTENSION_NAME);
+        enabledExtensions.push_back(VK_KHR_COPY_COMMANDS_2_EXTENSION_NAME);
+        enabledExtensions.push_back(VK_KHR_FORMAT_FEATURE_FLAGS_2_EXTENSION_NAME);
+        hostImageCopyFeatures.pNext = featuresChain;
+        featuresChain = &hostImageCopyFeatures;
+        vulkanState.extensions.hostImageCopy = true;
+    }
+#endif
+
+#ifdef VK_EXT_shader_object
+    VkPhysicalDeviceShaderObjectFeaturesEXT shaderObjectFeatures{};
+    shaderObjectFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_OBJECT_FEATURES_EXT;
+    shaderObjectFeatures.shaderObject = VK_TRUE;
+
+    // Shader objects can only be drawn while dynamic rendering, so RenderPass needs it as well.
+    VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeatures{};
+    dynamicRenderingFeatures.sType =
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR;
+    dynamicRenderingFeatures.dynamicRendering = VK_TRUE;
+
+    if (checkShaderObjectSupport(vulkanState.physicalDevice)) {
+        enabledExtensions.push_back(VK_EXT_SHADER_OBJECT_EXTENSION_NAME);
+        enabledExtensions.push_back(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
+        dynamicRenderingFeatures.pNext = featuresChain;
+        shaderObjectFeatures.pNext = &dynamicRenderingFeatures;
+        featuresChain = &shaderObjectFeatures;
+        vulkanState.extensions.shaderObject = true;
+        vulkanState.extensions.dynamicRendering = true;
+    }
+#endif
+
+#ifdef VK_EXT_extended_dynamic_state
+    VkPhysicalDeviceExtendedDynamicStateFeaturesEXT extendedDynamicStateFeatures{};
+    extendedDynamicStateFeatures.sType =
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_FEATURES_EXT;
+
+    if (checkOptionalExtensionSupport(vulkanState.physicalDevice,
+                                      VK_EXT_EXTENDED_DYNAMIC_STATE_EXTENSION_NAME)) {
+        VkPhysicalDeviceFeatures2 features{};
+        features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        features.pNext = &extendedDynamicStateFeatures;
+        vkGetPhysicalDeviceFeatures2(vulkanState.physicalDevice, &features);
+    }
+
+    if (extendedDynamicStateFeatures.extendedDynamicState) {
+        enabledExtensions.push_back(VK_EXT_EXTENDED_DYNAMIC_STATE_EXTENSION_NAME);
+        extendedDynamicStateFeatures.pNext = featuresChain;
+        featuresChain = &extendedDynamicStateFeatures;
+        vulkanState.extensions.extendedDynamicState = true;
+    }
+#endif
+
+#ifdef VK_EXT_extended_dynamic_state2
+    VkPhysicalDeviceExtendedDynamicState2FeaturesEXT supportedDynamicState2Features{};
+    supportedDynamicState2Features.sType =
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_2_FEATURES_EXT;
+
+    if (checkOptionalExtensionSupport(vulkanState.physicalDevice,
+                                      VK_EXT_EXTENDED_DYNAMIC_STATE_2_EXTENSION_NAME)) {
+        VkPhysicalDeviceFeatures2 features{};
+        features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        features.pNext = &supportedDynamicState2Features;
+        vkGetPhysicalDeviceFeatures2(vulkanState.physicalDevice, &features);
+    }
+
+    // Only the base feature is used, not the dynamic logic op or patch control points.
+    VkPhysicalDeviceExtendedDynamicState2FeaturesEXT extendedDynamicState2Features{};
+    extendedDynamicState2Features.sType =
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_2_FEATURES_EXT;
+    extendedDynamicState2Features.extendedDynamicState2 = VK_TRUE;
+
+    if (supportedDynamicState2Features.extendedDynamicState2) {
+        enabledExtensions.push_back(VK_EXT_EXTENDED_DYNAMIC_STATE_2_EXTENSION_NAME);
+        extendedDynamicState2Features.pNext = featuresChain;
+        featuresChain = &extendedDynamicState2Features;
+        vulkanState.extensions.extendedDynamicState2 = true;
+    }
+#endif
+
+    VkPhysicalDeviceVulkan12Features supportedVulkan12Features{};
+    supportedVulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+    VkPhysicalDeviceFeatures2 supportedFeatures2{};
+    supportedFeatures2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    supportedFeatures2.pNext = &supportedVulkan12Features;
+    vkGetPhysicalDeviceFeatures2(vulkanState.physicalDevice, &supportedFeatures2);
+
+    VkPhysicalDeviceVulkan12Features vulkan12Features{};
+    vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+    // Bindless texture tables index a partially bound array that is updated while in use.
+    if (supportedVulkan12Features.descriptorIndexing &&
+        supportedVulkan12Features.shaderSampledImageArrayNonUniformIndexing &&
+        supportedVulkan12Features.descriptorBindingSampledImageUpdateAfterBind &&
+        supportedVulkan12Features.descriptorBindingPartiallyBound &&
+        supportedVulkan12Features.runtimeDescriptorArray) {
+        vulkan12Features.descriptorIndexing = VK_TRUE;
+        vulkan12Features.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+        vulkan12Features.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+        vulkan12Features.descriptorBindingPartiallyBound = VK_TRUE;
+        vulkan12Features.runtimeDescriptorArray = VK_TRUE;
+        vulkanState.extensions.descriptorIndexing = true;
+    }
+
+    // Lets shaders read vertex, instance and material data through pointers in push constants.
+    if (supportedVulkan12Features.bufferDeviceAddress) {
+        vulkan12Features.bufferDeviceAddress = VK_TRUE;
+        vulkanState.extensions.bufferDeviceAddress = true;
+    }
+
+    if (supportedVulkan12Features.drawIndirectCount) {
+        vulkan12Features.drawIndirectCount = VK_TRUE;
+        vulkanState.extensions.drawIndirectCount = true;
+    }
+
+    vulkan12Features.pNext = featuresChain;
+    featuresChain = &vulkan12Features;
+
+    createInfo.pNext = featuresChain;
+
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());
+    createInfo.ppEnabledExtensionNames = enabledExtensions.data();
 
     if (enableValidationLayers) {
         createInfo.enabledLayerCount = static_cast<uint32_t>(validationLayers.size());
@@ -296,6 +479,8 @@ void Renderer::createLogicalDevice() {
         throw std::runtime_error("Failed to create logical device!");
     }
 
+    vulkanState.extensions.loadFunctions(vulkanState.device);
+
     vkGetDeviceQueue(vulkanState.device, indices.graphicsFamily.value(), 0,
                      &vulkanState.graphicsQueue);
     vkGetDeviceQueue(vulkanState.device, indices.presentFamily.value(), 0, &presentQueue);
@@ -371,7 +556,12 @@ void Renderer::drawFrame(
 
     vkResetFences(vulkanState.device, 1, &inFlightFences[currentFrame]);
 
+    // The frame's fence has been waited on, so its staging ring part and sets are free again.
+    vulkanState.stagingRing.beginFrame(currentFrame);
+    vulkanState.frameDescriptorAllocators[currentFrame].reset(vulkanState.device);
+
     vulkanState.commands.resetBuffer(imageIndex, currentFrame);
+    vulkanState.stateTrackers[currentFrame].reset();
     const VkCommandBuffer& currentBuffer = vulkanState.commands.getBuffer(currentFrame);
     renderCallback(vulkanState, currentBuffer, imageIndex, currentFrame);
 
@@ -464,6 +654,105 @@ bool Renderer::checkDeviceExtensionSupport(VkPhysicalDevice device) {
     return requiredExtensions.empty();
 }
 
+bool Renderer::checkOptionalExtensionSupport(VkPhysicalDevice device, const char* extension) {
+    uint32_t extensionCount;
+    vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+
+    std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+    vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount,
+                                         availableExtensions.data());
+
+    for (const auto& availableExtension : availableExtensions) {
+        if (strcmp(availableExtension.extensionName, extension) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool Renderer::checkHostImageCopySupport(VkPhysicalDevice device) {
+#ifdef VK_EXT_host_image_copy
+    if (!checkOptionalExtensionSupport(device, VK_EXT_HOST_IMAGE_COPY_EXTENSION_NAME) ||
+        !checkOptionalExtensionSupport(device, VK_KHR_COPY_COMMANDS_2_EXTENSION_NAME) ||
+        !checkOptionalExtensionSupport(device, VK_KHR_FORMAT_FEATURE_FLAGS_2_EXTENSION_NAME)) {
+        return false;
+    }
+
+    VkPhysicalDeviceHostImageCopyFeaturesEXT hostImageCopyFeatures{};
+    hostImageCopyFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_FEATURES_EXT;
+
+    VkPhysicalDeviceFeatures2 features{};
+    features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features.pNext = &hostImageCopyFeatures;
+    vkGetPhysicalDeviceFeatures2(device, &features);
+
+    if (!hostImageCopyFeatures.hostImageCopy) {
+        return false;
+    }
+
+    // Textures are copied straight into the layout they are sampled in.
+    VkPhysicalDeviceHostImageCopyPropertiesEXT hostImageCopyProperties{};
+    hostImageCopyProperties.sType =
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_PROPERTIES_EXT;
+
+    VkPhysicalDeviceProperties2 properties{};
+    properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    properties.pNext = &hostImageCopyProperties;
+    vkGetPhysicalDeviceProperties2(device, &properties);
+
+    std::vector<VkImageLayout> copySrcLayouts(hostImageCopyProperties.copySrcLayoutCount);
+    std::vector<VkImageLayout> copyDstLayouts(hostImageCopyProperties.copyDstLayoutCount);
+    hostImageCopyProperties.pCopySrcLayouts = copySrcLayouts.data();
+    hostImageCopyProperties.pCopyDstLayouts = copyDstLayouts.data();
+    vkGetPhysicalDeviceProperties2(device, &properties);
+
+    if (std::find(copyDstLayouts.begin(), copyDstLayouts.end(),
+                  VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) == copyDstLayouts.end()) {
+        return false;
+    }
+
+    VkFormatProperties3 formatProperties3{};
+    formatProperties3.sType = VK_STRUCTURE_TYPE_FORMAT_PROPERTIES_3;
+
+    VkFormatProperties2 formatProperties{};
+    formatProperties.sType = VK_STRUCTURE_TYPE_FORMAT_PROPERTIES_2;
+    formatProperties.pNext = &formatProperties3;
+    vkGetPhysicalDeviceFormatProperties2(device, VK_FORMAT_R8G8B8A8_SRGB, &formatProperties);
+
+    return (formatProperties3.optimalTilingFeatures &
+            VK_FORMAT_FEATURE_2_HOST_IMAGE_TRANSFER_BIT_EXT) != 0;
+#else
+    return false;
+#endif
+}
+
+bool Renderer::checkShaderObjectSupport(VkPhysicalDevice device) {
+#ifdef VK_EXT_shader_object
+    if (!checkOptionalExtensionSupport(device, VK_EXT_SHADER_OBJECT_EXTENSION_NAME) ||
+        !checkOptionalExtensionSupport(device, VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME)) {
+        return false;
+    }
+
+    VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeatures{};
+    dynamicRenderingFeatures.sType =
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR;
+
+    VkPhysicalDeviceShaderObjectFeaturesEXT shaderObjectFeatures{};
+    shaderObjectFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_OBJECT_FEATURES_EXT;
+    shaderObjectFeatures.pNext = &dynamicRenderingFeatures;
+
+    VkPhysicalDeviceFeatures2 features{};
+    features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features.pNext = &shaderObjectFeatures;
+    vkGetPhysicalDeviceFeatures2(device, &features);
+
+    return shaderObjectFeatures.shaderObject && dynamicRenderingFeatures.dynamicRendering;
+#else
+    return false;
+#endif
+}
+
 std::vector<const char*> Renderer::getRequiredExtensions() {
     uint32_t glfwExtensionCount = 0;
     const char** glfwExtensions;
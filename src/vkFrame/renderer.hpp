@@ -26,12 +26,35 @@
 #include <stdexcept>
 #include <vector>
 
+#include "atlas.hpp"
+#include "barriers.hpp"
+#include "bindlessTable.hpp"
 #include "buffer.hpp"
 #include "commands.hpp"
+#include "computePipeline.hpp"
+#include "descriptorAllocator.hpp"
+#include "descriptorLayoutCache.hpp"
+#include "deviceExtensions.hpp"
+#include "frustumCuller.hpp"
+#include "geometryPool.hpp"
+#include "hiZPyramid.hpp"
+#include "imageViewCache.hpp"
+#include "indirectDrawBuffer.hpp"
+#include "materialSystem.hpp"
+#include "mipmaps.hpp"
 #include "model.hpp"
+#include "occlusionCuller.hpp"
 #include "pipeline.hpp"
+#include "pipelineCache.hpp"
+#include "pipelineCompiler.hpp"
 #include "queueFamilyIndices.hpp"
+#include "renderQueue.hpp"
+#include "samplerCache.hpp"
+#include "specializationConstants.hpp"
+#include "stagingRing.hpp"
+#include "stateTracker.hpp"
 #include "swapchain.hpp"
+#include "textureStreamer.hpp"
 #include "uniformBuffer.hpp"
 
 VkResult CreateDebugUtilsMessengerEXT(VkInstance instance,
@@ -49,6 +72,17 @@ struct VulkanState {
     VmaAllocator allocator;
     Swapchain swapchain;
     Commands commands;
+    SamplerCache samplerCache;
+    ImageViewCache imageViewCache;
+    DescriptorLayoutCache descriptorLayoutCache;
+    // Sets that live as long as their owner, such as a pipeline's per-frame sets.
+    DescriptorAllocator descriptorAllocator;
+    // Transient sets, reset at the start of the frame that allocated them.
+    std::vector<DescriptorAllocator> frameDescriptorAllocators;
+    // Filters redundant binds in the command buffer of each frame.
+    std::vector<StateTracker> stateTrackers;
+    StagingRing stagingRing;
+    DeviceExtensions extensions;
     uint32_t maxFramesInFlight;
 };
 
@@ -125,6 +159,9 @@ class Renderer {
 
     bool isDeviceSuitable(VkPhysicalDevice device);
     bool checkDeviceExtensionSupport(VkPhysicalDevice device);
+    bool checkOptionalExtensionSupport(VkPhysicalDevice device, const char* extension);
+    bool checkHostImageCopySupport(VkPhysicalDevice device);
+    bool checkShaderObjectSupport(VkPhysicalDevice device);
     QueueFamilyIndices findQueueFamilies(VkPhysicalDevice device);
     std::vector<const char*> getRequiredExtensions();
     bool checkValidationLayerSupport();
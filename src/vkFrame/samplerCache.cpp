@@ -0,0 +1,94 @@
+#include "samplerCache.hpp"
+
+#include <cstring>
+
+void SamplerCache::create(VkPhysicalDevice physicalDevice) {
+    VkPhysicalDeviceProperties properties{};
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+    limits = properties.limits;
+}
+
+VkSampler SamplerCache::get(VkDevice device, const VkSamplerCreateInfo& samplerInfo) {
+    if (samplerInfo.pNext != nullptr) {
+        throw std::invalid_argument("Cached samplers can't have extension structures!");
+    }
+
+    Key key = makeKey(samplerInfo);
+    auto it = samplers.find(key);
+
+    if (it != samplers.end()) {
+        it->second.refCount++;
+        return it->second.sampler;
+    }
+
+    if (samplers.size() >= limits.maxSamplerAllocationCount) {
+        throw std::runtime_error("Exceeded the maximum number of samplers!");
+    }
+
+    VkSampler sampler;
+
+    if (vkCreateSampler(device, &samplerInfo, nullptr, &sampler) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create texture sampler!");
+    }
+
+    samplers[key] = Entry{sampler, 1};
+    samplerKeys[sampler] = key;
+
+    return sampler;
+}
+
+void SamplerCache::release(VkDevice device, VkSampler sampler) {
+    auto keyIt = samplerKeys.find(sampler);
+
+    if (keyIt == samplerKeys.end()) {
+        return;
+    }
+
+    auto it = samplers.find(keyIt->second);
+
+    if (--it->second.refCount == 0) {
+        vkDestroySampler(device, sampler, nullptr);
+        samplers.erase(it);
+        samplerKeys.erase(keyIt);
+    }
+}
+
+void SamplerCache::destroy(VkDevice device) {
+    for (auto& [key, entry] : samplers) {
+        vkDestroySampler(device, entry.sampler, nullptr);
+    }
+
+    samplers.clear();
+    samplerKeys.clear();
+}
+
+const VkPhysicalDeviceLimits& SamplerCache::getLimits() { return limits; }
+
+size_t SamplerCache::getSamplerCount() { return samplers.size(); }
+
+SamplerCache::Key SamplerCache::makeKey(const VkSamplerCreateInfo& samplerInfo) {
+    Key key{};
+    key[0] = samplerInfo.flags;
+    key[1] = samplerInfo.magFilter;
+    key[2] = samplerInfo.minFilter;
+    key[3] = samplerInfo.mipmapMode;
+    key[4] = samplerInfo.addressModeU;
+    key[5] = samplerInfo.addressModeV;
+    key[6] = samplerInfo.addressModeW;
+    memcpy(&key[7], &samplerInfo.mipLodBias, sizeof(float));
+    key[8] = samplerInfo.anisotropyEnable;
+    memcpy(&key[9], &samplerInfo.maxAnisotropy, sizeof(float));
+    key[10] = samplerInfo.compareEnable;
+    key[11] = samplerInfo.compareOp;
+    memcpy(&key[12], &samplerInfo.minLod, sizeof(float));
+    memcpy(&key[13], &samplerInfo.maxLod, sizeof(float));
+    key[14] = samplerInfo.borderColor;
+    key[15] = samplerInfo.unnormalizedCoordinates;
+
+    return key;
+}
+
+size_t SamplerCache::KeyHash::operator()(const Key& key) const {
+    return static_cast<size_t>(hashBytes(key.data(), sizeof(Key)));
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <cinttypes>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "hash.hpp"
+
+/*
+ * Deduplicates samplers by their full creation state and reference counts them, so identical
+ * samplers are only created once no matter how many textures use them.
+ */
+class SamplerCache {
+  public:
+    void create(VkPhysicalDevice physicalDevice);
+    VkSampler get(VkDevice device, const VkSamplerCreateInfo& samplerInfo);
+    void release(VkDevice device, VkSampler sampler);
+    void destroy(VkDevice device);
+
+    const VkPhysicalDeviceLimits& getLimits();
+    size_t getSamplerCount();
+
+  private:
+    using Key = std::array<uint32_t, 16>;
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+
+    struct Entry {
+        VkSampler sampler;
+        uint32_t refCount;
+    };
+
+    static Key makeKey(const VkSamplerCreateInfo& samplerInfo);
+
+    VkPhysicalDeviceLimits limits{};
+    std::unordered_map<Key, Entry, KeyHash> samplers;
+    std::unordered_map<VkSampler, Key> samplerKeys;
+};
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cinttypes>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+/*
+ * Values for a shader's constant_id declarations, resolved when the pipeline is compiled so the
+ * driver can fold them and drop the branches they disable:
+ *
+ *     layout(constant_id = 0) const uint layerCount = 1;
+ *     layout(constant_id = 1) const bool enableFog = false;
+ */
+class SpecializationConstants {
+  public:
+    template <typename T> SpecializationConstants& set(uint32_t constantId, const T& value) {
+        static_assert(!std::is_same_v<T, bool>, "Booleans have to be passed as VkBool32!");
+        static_assert(sizeof(T) == 4 || sizeof(T) == 8,
+                      "Specialization constants must be 32 or 64-bit scalars!");
+
+        for (const VkSpecializationMapEntry& entry : entries) {
+            if (entry.constantID == constantId) {
+                if (entry.size != sizeof(T)) {
+                    throw std::invalid_argument("Specialization constant changed its size!");
+                }
+
+                memcpy(data.data() + entry.offset, &value, sizeof(T));
+                return *this;
+            }
+        }
+
+        VkSpecializationMapEntry entry{};
+        entry.constantID = constantId;
+        entry.offset = static_cast<uint32_t>(data.size());
+        entry.size = sizeof(T);
+        entries.push_back(entry);
+
+        data.resize(data.size() + sizeof(T));
+        memcpy(data.data() + entry.offset, &value, sizeof(T));
+
+        return *this;
+    }
+
+    // Null when no constants are set, so the shader's defaults apply.
+    const VkSpecializationInfo* getInfo() {
+        if (entries.empty()) {
+            return nullptr;
+        }
+
+        info.mapEntryCount = static_cast<uint32_t>(entries.size());
+        info.pMapEntries = entries.data();
+        info.dataSize = data.size();
+        info.pData = data.data();
+
+        return &info;
+    }
+
+  private:
+    std::vector<VkSpecializationMapEntry> entries;
+    std::vector<uint8_t> data;
+    VkSpecializationInfo info{};
+};
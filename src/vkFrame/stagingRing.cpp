@@ -0,0 +1,38 @@
+#include "stagingRing.hpp"
+
+#include <cstring>
+
+void StagingRing::create(VmaAllocator allocator, VkDeviceSize frameSize,
+                         uint32_t maxFramesInFlight) {
+    this->frameSize = frameSize;
+    buffer = Buffer(allocator, frameSize * maxFramesInFlight, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                    true);
+}
+
+void StagingRing::beginFrame(uint32_t currentFrame) {
+    frameStart = frameSize * currentFrame;
+    frameOffset = 0;
+}
+
+VkDeviceSize StagingRing::push(const void* data, VkDeviceSize byteSize, VkDeviceSize alignment) {
+    VkDeviceSize offset = (frameOffset + alignment - 1) / alignment * alignment;
+
+    if (offset + byteSize > frameSize) {
+        throw std::runtime_error("Staging ring is out of space for this frame!");
+    }
+
+    memcpy(static_cast<uint8_t*>(buffer.getMappedData()) + frameStart + offset, data, byteSize);
+    frameOffset = offset + byteSize;
+
+    return frameStart + offset;
+}
+
+bool StagingRing::fits(VkDeviceSize byteSize, VkDeviceSize alignment) {
+    return (frameOffset + alignment - 1) / alignment * alignment + byteSize <= frameSize;
+}
+
+void StagingRing::destroy(VmaAllocator allocator) { buffer.destroy(allocator); }
+
+const VkBuffer& StagingRing::getBuffer() { return buffer.getBuffer(); }
+
+VkDeviceSize StagingRing::getFrameSize() { return frameSize; }
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <vk_mem_alloc.h>
+#include <vulkan/vulkan.h>
+
+#include <cinttypes>
+#include <stdexcept>
+
+#include "buffer.hpp"
+
+/*
+ * A persistently mapped upload buffer split into one region per frame in flight. Each frame's
+ * region is reused once that frame's fence has been waited on, so uploads recorded into the
+ * frame's command buffer never need their own staging allocation or submit.
+ */
+class StagingRing {
+  public:
+    void create(VmaAllocator allocator, VkDeviceSize frameSize, uint32_t maxFramesInFlight);
+    void beginFrame(uint32_t currentFrame);
+    VkDeviceSize push(const void* data, VkDeviceSize byteSize, VkDeviceSize alignment = 16);
+    bool fits(VkDeviceSize byteSize, VkDeviceSize alignment = 16);
+    void destroy(VmaAllocator allocator);
+
+    const VkBuffer& getBuffer();
+    VkDeviceSize getFrameSize();
+
+  private:
+    Buffer buffer;
+    VkDeviceSize frameSize = 0;
+    VkDeviceSize frameStart = 0;
+    VkDeviceSize frameOffset = 0;
+};
@@ -0,0 +1,177 @@
+#include "stateTracker.hpp"
+
+#include <stdexcept>
+
+void StateTracker::reset() { *this = StateTracker(); }
+
+void StateTracker::bindPipeline(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint,
+                                VkPipeline pipeline) {
+    BindPointState& state = getBindPointState(bindPoint);
+
+    if (state.pipeline == pipeline) {
+        elidedCount++;
+        return;
+    }
+
+    vkCmdBindPipeline(commandBuffer, bindPoint, pipeline);
+    state.pipeline = pipeline;
+    issuedCount++;
+}
+
+void StateTracker::invalidatePipeline(VkPipelineBindPoint bindPoint) {
+    getBindPointState(bindPoint).pipeline = VK_NULL_HANDLE;
+}
+
+void StateTracker::bindDescriptorSets(VkCommandBuffer commandBuffer,
+                                      VkPipelineBindPoint bindPoint, VkPipelineLayout layout,
+                                      uint32_t firstSet, uint32_t setCount,
+                                      const VkDescriptorSet* descriptorSets,
+                                      uint32_t dynamicOffsetCount,
+                                      const uint32_t* dynamicOffsets) {
+    BindPointState& state = getBindPointState(bindPoint);
+    bool tracked = firstSet + setCount <= MaxDescriptorSets && dynamicOffsetCount == 0;
+    bool changed = !tracked;
+
+    for (uint32_t i = 0; i < setCount && !changed; i++) {
+        const BoundSet& bound = state.sets[firstSet + i];
+        changed = bound.layout != layout || bound.descriptorSet != descriptorSets[i];
+    }
+
+    if (!changed) {
+        elidedCount++;
+        return;
+    }
+
+    vkCmdBindDescriptorSets(commandBuffer, bindPoint, layout, firstSet, setCount, descriptorSets,
+                            dynamicOffsetCount, dynamicOffsets);
+    issuedCount++;
+
+    // Binding with another layout may disturb sets that were bound with the old one.
+    for (uint32_t i = 0; i < MaxDescriptorSets; i++) {
+        bool inRange = i >= firstSet && i < firstSet + setCount;
+
+        if (inRange && tracked) {
+            state.sets[i] = {layout, descriptorSets[i - firstSet]};
+        } else if (inRange || state.sets[i].layout != layout) {
+            state.sets[i] = {};
+        }
+    }
+}
+
+void StateTracker::invalidateDescriptorSets(VkPipelineBindPoint bindPoint, uint32_t firstSet) {
+    BindPointState& state = getBindPointState(bindPoint);
+
+    for (uint32_t i = firstSet; i < MaxDescriptorSets; i++) {
+        state.sets[i] = {};
+    }
+}
+
+void StateTracker::bindVertexBuffers(VkCommandBuffer commandBuffer, uint32_t firstBinding,
+                                     uint32_t bindingCount, const VkBuffer* buffers,
+                                     const VkDeviceSize* offsets) {
+    bool tracked = firstBinding + bindingCount <= MaxVertexBindings;
+    bool changed = !tracked;
+
+    for (uint32_t i = 0; i < bindingCount && !changed; i++) {
+        const VertexBinding& bound = vertexBindings[firstBinding + i];
+        changed = bound.buffer != buffers[i] || bound.offset != offsets[i];
+    }
+
+    if (!changed) {
+        elidedCount++;
+        return;
+    }
+
+    vkCmdBindVertexBuffers(commandBuffer, firstBinding, bindingCount, buffers, offsets);
+    issuedCount++;
+
+    for (uint32_t i = 0; i < bindingCount && firstBinding + i < MaxVertexBindings; i++) {
+        vertexBindings[firstBinding + i] = {buffers[i], offsets[i]};
+    }
+}
+
+void StateTracker::bindIndexBuffer(VkCommandBuffer commandBuffer, VkBuffer buffer,
+                                   VkDeviceSize offset, VkIndexType indexType) {
+    if (indexBuffer == buffer && indexOffset == offset && this->indexType == indexType) {
+        elidedCount++;
+        return;
+    }
+
+    vkCmdBindIndexBuffer(commandBuffer, buffer, offset, indexType);
+    indexBuffer = buffer;
+    indexOffset = offset;
+    this->indexType = indexType;
+    issuedCount++;
+}
+
+void StateTracker::setViewport(VkCommandBuffer commandBuffer, const VkViewport& viewport) {
+    if (viewportSet && this->viewport.x == viewport.x && this->viewport.y == viewport.y &&
+        this->viewport.width == viewport.width && this->viewport.height == viewport.height &&
+        this->viewport.minDepth == viewport.minDepth &&
+        this->viewport.maxDepth == viewport.maxDepth) {
+        elidedCount++;
+        return;
+    }
+
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+    this->viewport = viewport;
+    viewportSet = true;
+    issuedCount++;
+}
+
+void StateTracker::setScissor(VkCommandBuffer commandBuffer, const VkRect2D& scissor) {
+    if (scissorSet && this->scissor.offset.x == scissor.offset.x &&
+        this->scissor.offset.y == scissor.offset.y &&
+        this->scissor.extent.width == scissor.extent.width &&
+        this->scissor.extent.height == scissor.extent.height) {
+        elidedCount++;
+        return;
+    }
+
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+    this->scissor = scissor;
+    scissorSet = true;
+    issuedCount++;
+}
+
+void StateTracker::setLineWidth(VkCommandBuffer commandBuffer, float lineWidth) {
+    if (lineWidthSet && this->lineWidth == lineWidth) {
+        elidedCount++;
+        return;
+    }
+
+    vkCmdSetLineWidth(commandBuffer, lineWidth);
+    this->lineWidth = lineWidth;
+    lineWidthSet = true;
+    issuedCount++;
+}
+
+void StateTracker::setDepthBias(VkCommandBuffer commandBuffer, float constantFactor, float clamp,
+                                float slopeFactor) {
+    std::array<float, 3> newDepthBias = {constantFactor, clamp, slopeFactor};
+
+    if (depthBiasSet && depthBias == newDepthBias) {
+        elidedCount++;
+        return;
+    }
+
+    vkCmdSetDepthBias(commandBuffer, constantFactor, clamp, slopeFactor);
+    depthBias = newDepthBias;
+    depthBiasSet = true;
+    issuedCount++;
+}
+
+uint32_t StateTracker::getIssuedCount() { return issuedCount; }
+
+uint32_t StateTracker::getElidedCount() { return elidedCount; }
+
+StateTracker::BindPointState& StateTracker::getBindPointState(VkPipelineBindPoint bindPoint) {
+    switch (bindPoint) {
+    case VK_PIPELINE_BIND_POINT_GRAPHICS:
+        return graphicsState;
+    case VK_PIPELINE_BIND_POINT_COMPUTE:
+        return computeState;
+    default:
+        throw std::invalid_argument("Unsupported pipeline bind point!");
+    }
+}
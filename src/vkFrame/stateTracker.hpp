@@ -0,0 +1,86 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <cinttypes>
+
+/*
+ * Remembers what has been bound and set in one command buffer and drops the calls that wouldn't
+ * change anything. Must be reset whenever its command buffer starts recording, since nothing
+ * carries over from the previous recording. Only viewport, scissor, line width and depth bias
+ * are tracked as dynamic state, so pipelines that set any of them statically shouldn't be mixed
+ * with the tracked setters.
+ */
+class StateTracker {
+  public:
+    static const uint32_t MaxDescriptorSets = 8;
+    static const uint32_t MaxVertexBindings = 16;
+
+    void reset();
+
+    void bindPipeline(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint,
+                      VkPipeline pipeline);
+    // Forgets the bound pipeline after something else replaced it, such as shader objects.
+    void invalidatePipeline(VkPipelineBindPoint bindPoint);
+    // Sets bound with dynamic offsets are always rebound, as the offsets usually change per draw.
+    void bindDescriptorSets(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint,
+                            VkPipelineLayout layout, uint32_t firstSet, uint32_t setCount,
+                            const VkDescriptorSet* descriptorSets,
+                            uint32_t dynamicOffsetCount = 0,
+                            const uint32_t* dynamicOffsets = nullptr);
+    // Forgets firstSet and every set after it once they were changed behind the tracker's back,
+    // such as by pushed descriptors.
+    void invalidateDescriptorSets(VkPipelineBindPoint bindPoint, uint32_t firstSet);
+    void bindVertexBuffers(VkCommandBuffer commandBuffer, uint32_t firstBinding,
+                           uint32_t bindingCount, const VkBuffer* buffers,
+                           const VkDeviceSize* offsets);
+    void bindIndexBuffer(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset,
+                         VkIndexType indexType);
+    void setViewport(VkCommandBuffer commandBuffer, const VkViewport& viewport);
+    void setScissor(VkCommandBuffer commandBuffer, const VkRect2D& scissor);
+    void setLineWidth(VkCommandBuffer commandBuffer, float lineWidth);
+    void setDepthBias(VkCommandBuffer commandBuffer, float constantFactor, float clamp,
+                      float slopeFactor);
+
+    // Calls passed on to the command buffer and calls dropped since the last reset.
+    uint32_t getIssuedCount();
+    uint32_t getElidedCount();
+
+  private:
+    struct BoundSet {
+        VkPipelineLayout layout = VK_NULL_HANDLE;
+        VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+    };
+
+    struct BindPointState {
+        VkPipeline pipeline = VK_NULL_HANDLE;
+        std::array<BoundSet, MaxDescriptorSets> sets{};
+    };
+
+    struct VertexBinding {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VkDeviceSize offset = 0;
+    };
+
+    BindPointState& getBindPointState(VkPipelineBindPoint bindPoint);
+
+    BindPointState graphicsState;
+    BindPointState computeState;
+    std::array<VertexBinding, MaxVertexBindings> vertexBindings{};
+    VkBuffer indexBuffer = VK_NULL_HANDLE;
+    VkDeviceSize indexOffset = 0;
+    VkIndexType indexType = VK_INDEX_TYPE_UINT16;
+
+    bool viewportSet = false;
+    VkViewport viewport{};
+    bool scissorSet = false;
+    VkRect2D scissor{};
+    bool lineWidthSet = false;
+    float lineWidth = 1.0f;
+    bool depthBiasSet = false;
+    std::array<float, 3> depthBias{};
+
+    uint32_t issuedCount = 0;
+    uint32_t elidedCount = 0;
+};
@@ -0,0 +1,366 @@
+#include "textureStreamer.hpp"
+#include "barriers.hpp"
+#include "mipmaps.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+void TextureStreamer::create(VkDeviceSize memoryCap, uint32_t maxFramesInFlight,
+                             uint32_t tailSize, VkDeviceSize uploadBudget) {
+    this->memoryCap = memoryCap;
+    retiredImages.resize(maxFramesInFlight);
+    this->tailSize = tailSize;
+    this->uploadBudget = uploadBudget;
+}
+
+uint32_t TextureStreamer::add(const std::string& image, VmaAllocator allocator, Commands& commands,
+                              VkQueue graphicsQueue, VkDevice device) {
+    int32_t width, height, texChannels;
+    stbi_uc* pixels = stbi_load(image.c_str(), &width, &height, &texChannels, STBI_rgb_alpha);
+
+    if (!pixels) {
+        throw std::runtime_error("Failed to load streamed texture image!");
+    }
+
+    Texture texture;
+    texture.width = width;
+    texture.height = height;
+    texture.levelCount = Image::calcMipmapLevels(width, height);
+    texture.requestedMip = texture.levelCount;
+
+    std::vector<VkDeviceSize> chainOffsets;
+    std::vector<uint8_t> chain = MipmapGenerator::downsampleCpu(
+        pixels, width, height, 1, texture.levelCount, true, false, chainOffsets);
+
+    VkDeviceSize baseByteSize = static_cast<VkDeviceSize>(width) * height * 4;
+    texture.mipChain.resize(baseByteSize + chain.size());
+    memcpy(texture.mipChain.data(), pixels, baseByteSize);
+    memcpy(texture.mipChain.data() + baseByteSize, chain.data(), chain.size());
+
+    stbi_image_free(pixels);
+
+    texture.levelOffsets.push_back(0);
+    for (VkDeviceSize offset : chainOffsets) {
+        texture.levelOffsets.push_back(baseByteSize + offset);
+    }
+
+    texture.tailMip = 0;
+    while (texture.tailMip + 1 < texture.levelCount &&
+           std::max(texture.width >> texture.tailMip, texture.height >> texture.tailMip) >
+               tailSize) {
+        texture.tailMip++;
+    }
+
+    texture.residentMip = texture.tailMip;
+    texture.image = Image(allocator, std::max(texture.width >> texture.tailMip, 1u),
+                          std::max(texture.height >> texture.tailMip, 1u),
+                          VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL,
+                          VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT |
+                              VK_IMAGE_USAGE_SAMPLED_BIT,
+                          VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                          texture.levelCount - texture.tailMip);
+
+    VkDeviceSize tailByteSize = getResidentBytes(texture, texture.tailMip);
+    Buffer stagingBuffer(allocator, tailByteSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, true);
+    stagingBuffer.setData(texture.mipChain.data() + texture.levelOffsets[texture.tailMip]);
+
+    VkCommandBuffer commandBuffer = commands.beginSingleTime(graphicsQueue, device);
+
+    BarrierBatch barriers;
+    barriers.transition(texture.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+    barriers.flush(commandBuffer);
+
+    uploadLevels(texture, texture.image, texture.tailMip, texture.tailMip, texture.levelCount,
+                 stagingBuffer.getBuffer(), 0, commandBuffer);
+
+    barriers.transition(texture.image, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    barriers.flush(commandBuffer);
+
+    commands.endSingleTime(commandBuffer, graphicsQueue, device);
+
+    stagingBuffer.destroy(allocator);
+
+    texture.view = texture.image.createTextureView(device);
+    residentBytes += tailByteSize;
+    textures.push_back(std::move(texture));
+
+    return static_cast<uint32_t>(textures.size() - 1);
+}
+
+void TextureStreamer::requestMip(uint32_t id, uint32_t mipLevel) {
+    textures[id].requestedMip = std::min(textures[id].requestedMip, mipLevel);
+}
+
+void TextureStreamer::setDistance(uint32_t id, float distance) { textures[id].distance = distance; }
+
+void TextureStreamer::update(VmaAllocator allocator, StagingRing& stagingRing,
+                             VkCommandBuffer commandBuffer, VkDevice device,
+                             uint32_t currentFrame) {
+    // The frame's fence covers every frame submitted before it as well, so nothing that could
+    // have sampled the images replaced when this frame was last recorded is still running.
+    destroyRetired(retiredImages[currentFrame], allocator, device);
+
+    std::vector<uint32_t> desiredMips(textures.size());
+    std::vector<uint32_t> newResidentMips(textures.size());
+    VkDeviceSize projectedBytes = 0;
+
+    for (size_t i = 0; i < textures.size(); i++) {
+        Texture& texture = textures[i];
+        desiredMips[i] = getDesiredMip(texture);
+        texture.requestedMip = texture.levelCount;
+
+        // Levels more detailed than what is needed are dropped straight away.
+        newResidentMips[i] = std::max(texture.residentMip, desiredMips[i]);
+        projectedBytes += getResidentBytes(texture, newResidentMips[i]);
+    }
+
+    std::vector<uint32_t> order(textures.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        if (desiredMips[a] != desiredMips[b]) {
+            return desiredMips[a] < desiredMips[b];
+        }
+
+        return textures[a].distance < textures[b].distance;
+    });
+
+    VkDeviceSize targetBytes = getTargetBytes(allocator);
+
+    // When over the target, the least important textures give up their levels first.
+    for (auto it = order.rbegin(); it != order.rend() && projectedBytes > targetBytes; ++it) {
+        Texture& texture = textures[*it];
+        uint32_t& residentMip = newResidentMips[*it];
+
+        while (projectedBytes > targetBytes && residentMip < texture.tailMip) {
+            projectedBytes -= getLevelBytes(texture, residentMip);
+            residentMip++;
+        }
+    }
+
+    // Stream in at most one level per texture per frame, most important first.
+    VkDeviceSize uploadedBytes = 0;
+
+    for (uint32_t i : order) {
+        Texture& texture = textures[i];
+        uint32_t& residentMip = newResidentMips[i];
+
+        if (residentMip != texture.residentMip || residentMip <= desiredMips[i]) {
+            continue;
+        }
+
+        VkDeviceSize levelBytes = getLevelBytes(texture, residentMip - 1);
+
+        if (projectedBytes + levelBytes > targetBytes ||
+            (uploadedBytes > 0 && uploadedBytes + levelBytes > uploadBudget)) {
+            continue;
+        }
+
+        residentMip--;
+        projectedBytes += levelBytes;
+        uploadedBytes += levelBytes;
+    }
+
+    for (size_t i = 0; i < textures.size(); i++) {
+        if (newResidentMips[i] != textures[i].residentMip) {
+            resize(textures[i], newResidentMips[i], allocator, stagingRing, commandBuffer, device,
+                   currentFrame);
+        }
+    }
+}
+
+void TextureStreamer::resize(Texture& texture, uint32_t newResidentMip, VmaAllocator allocator,
+                             StagingRing& stagingRing, VkCommandBuffer commandBuffer,
+                             VkDevice device, uint32_t currentFrame) {
+    Image image(allocator, std::max(texture.width >> newResidentMip, 1u),
+                std::max(texture.height >> newResidentMip, 1u), VK_FORMAT_R8G8B8A8_SRGB,
+                VK_IMAGE_TILING_OPTIMAL,
+                VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT |
+                    VK_IMAGE_USAGE_SAMPLED_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, texture.levelCount - newResidentMip);
+
+    // Levels held by both images are copied on the GPU, only missing ones come from the host.
+    uint32_t firstKeptMip = std::max(newResidentMip, texture.residentMip);
+
+    BarrierBatch barriers;
+    barriers.transition(image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+    barriers.transition(texture.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                        firstKeptMip - texture.residentMip);
+    barriers.flush(commandBuffer);
+
+    std::vector<VkImageCopy> copies;
+
+    for (uint32_t level = firstKeptMip; level < texture.levelCount; level++) {
+        VkImageCopy copy{};
+        copy.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        copy.srcSubresource.mipLevel = level - texture.residentMip;
+        copy.srcSubresource.baseArrayLayer = 0;
+        copy.srcSubresource.layerCount = 1;
+        copy.dstSubresource = copy.srcSubresource;
+        copy.dstSubresource.mipLevel = level - newResidentMip;
+        copy.extent = {std::max(texture.width >> level, 1u), std::max(texture.height >> level, 1u),
+                       1};
+        copies.push_back(copy);
+    }
+
+    vkCmdCopyImage(commandBuffer, texture.image.getImage(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                   image.getImage(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                   static_cast<uint32_t>(copies.size()), copies.data());
+
+    RetiredImage retired{texture.image, texture.view};
+
+    if (newResidentMip < texture.residentMip) {
+        VkDeviceSize offset = texture.levelOffsets[newResidentMip];
+        VkDeviceSize byteSize = texture.levelOffsets[texture.residentMip] - offset;
+        const uint8_t* data = texture.mipChain.data() + offset;
+
+        VkBuffer buffer;
+        VkDeviceSize bufferOffset = 0;
+
+        if (stagingRing.fits(byteSize)) {
+            bufferOffset = stagingRing.push(data, byteSize);
+            buffer = stagingRing.getBuffer();
+        } else {
+            // Levels too large for the staging ring get their own buffer, freed with the old image.
+            retired.stagingBuffer =
+                Buffer(allocator, byteSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, true);
+            retired.stagingBuffer.setData(data);
+            buffer = retired.stagingBuffer.getBuffer();
+        }
+
+        uploadLevels(texture, image, newResidentMip, newResidentMip, texture.residentMip, buffer,
+                     bufferOffset, commandBuffer);
+    }
+
+    // Descriptors that haven't been rewritten yet still expect the old image to be readable.
+    barriers.transition(image, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    barriers.transition(texture.image, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    barriers.flush(commandBuffer);
+
+    retiredImages[currentFrame].push_back(retired);
+
+    residentBytes = residentBytes - getResidentBytes(texture, texture.residentMip) +
+                    getResidentBytes(texture, newResidentMip);
+
+    texture.image = image;
+    texture.view = image.createTextureView(device);
+    texture.residentMip = newResidentMip;
+    texture.generation++;
+}
+
+void TextureStreamer::uploadLevels(Texture& texture, Image& image, uint32_t imageBaseMip,
+                                   uint32_t firstLevel, uint32_t endLevel, VkBuffer buffer,
+                                   VkDeviceSize bufferOffset, VkCommandBuffer commandBuffer) {
+    std::vector<VkBufferImageCopy> regions;
+
+    for (uint32_t level = firstLevel; level < endLevel; level++) {
+        VkBufferImageCopy region{};
+        region.bufferOffset =
+            bufferOffset + texture.levelOffsets[level] - texture.levelOffsets[firstLevel];
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel = level - imageBaseMip;
+        region.imageSubresource.baseArrayLayer = 0;
+        region.imageSubresource.layerCount = 1;
+        region.imageExtent = {std::max(texture.width >> level, 1u),
+                              std::max(texture.height >> level, 1u), 1};
+        regions.push_back(region);
+    }
+
+    vkCmdCopyBufferToImage(commandBuffer, buffer, image.getImage(),
+                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           static_cast<uint32_t>(regions.size()), regions.data());
+}
+
+uint32_t TextureStreamer::getDesiredMip(const Texture& texture) {
+    uint32_t desiredMip = texture.tailMip;
+
+    if (texture.requestedMip < texture.levelCount) {
+        desiredMip = std::min(desiredMip, texture.requestedMip);
+    }
+
+    if (texture.distance >= 0.0f) {
+        // Every doubling of the distance past the reference distance halves the detail needed.
+        uint32_t distanceMip = 0;
+
+        if (texture.distance > referenceDistance) {
+            distanceMip = static_cast<uint32_t>(
+                std::floor(std::log2(texture.distance / referenceDistance)));
+        }
+
+        desiredMip = std::min(desiredMip, distanceMip);
+    }
+
+    return desiredMip;
+}
+
+VkDeviceSize TextureStreamer::getTargetBytes(VmaAllocator allocator) {
+    const VkPhysicalDeviceMemoryProperties* memoryProperties;
+    vmaGetMemoryProperties(allocator, &memoryProperties);
+
+    // Without VK_EXT_memory_budget, VMA estimates the budget from its own allocations.
+    std::vector<VmaBudget> budgets(memoryProperties->memoryHeapCount);
+    vmaGetHeapBudgets(allocator, budgets.data());
+
+    VkDeviceSize freeBytes = 0;
+
+    for (uint32_t i = 0; i < memoryProperties->memoryHeapCount; i++) {
+        if ((memoryProperties->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) &&
+            budgets[i].budget > budgets[i].usage) {
+            freeBytes += budgets[i].budget - budgets[i].usage;
+        }
+    }
+
+    return std::min(memoryCap, residentBytes + freeBytes);
+}
+
+VkDeviceSize TextureStreamer::getLevelBytes(const Texture& texture, uint32_t mipLevel) {
+    VkDeviceSize end = mipLevel + 1 < texture.levelCount ? texture.levelOffsets[mipLevel + 1]
+                                                         : texture.mipChain.size();
+    return end - texture.levelOffsets[mipLevel];
+}
+
+VkDeviceSize TextureStreamer::getResidentBytes(const Texture& texture, uint32_t residentMip) {
+    return texture.mipChain.size() - texture.levelOffsets[residentMip];
+}
+
+void TextureStreamer::destroyRetired(std::vector<RetiredImage>& retired, VmaAllocator allocator,
+                                     VkDevice device) {
+    for (RetiredImage& retiredImage : retired) {
+        vkDestroyImageView(device, retiredImage.view, nullptr);
+        retiredImage.image.destroy(allocator);
+        retiredImage.stagingBuffer.destroy(allocator);
+    }
+
+    retired.clear();
+}
+
+void TextureStreamer::destroy(VmaAllocator allocator, VkDevice device) {
+    for (std::vector<RetiredImage>& retired : retiredImages) {
+        destroyRetired(retired, allocator, device);
+    }
+
+    for (Texture& texture : textures) {
+        vkDestroyImageView(device, texture.view, nullptr);
+        texture.image.destroy(allocator);
+    }
+
+    textures.clear();
+    residentBytes = 0;
+}
+
+VkImageView TextureStreamer::getView(uint32_t id) { return textures[id].view; }
+
+uint32_t TextureStreamer::getGeneration(uint32_t id) { return textures[id].generation; }
+
+uint32_t TextureStreamer::getResidentMip(uint32_t id) { return textures[id].residentMip; }
+
+uint32_t TextureStreamer::getMipmapLevels(uint32_t id) { return textures[id].levelCount; }
+
+VkDeviceSize TextureStreamer::getResidentBytes() { return residentBytes; }
+
+void TextureStreamer::setMemoryCap(VkDeviceSize memoryCap) { this->memoryCap = memoryCap; }
+
+void TextureStreamer::setReferenceDistance(float referenceDistance) {
+    this->referenceDistance = referenceDistance;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <vk_mem_alloc.h>
+#include <vulkan/vulkan.h>
+
+#include <cinttypes>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "commands.hpp"
+#include "image.hpp"
+#include "stagingRing.hpp"
+
+/*
+ * Keeps textures resident at the detail they are actually used at while holding their combined
+ * size under a memory cap. The smallest mips of every texture always stay resident. Higher mips
+ * are uploaded from a host copy one level at a time through the frame's command buffer, and
+ * dropped again when unused or when the cap or the device's memory budget is exceeded.
+ *
+ * A texture's image and view are replaced whenever its resident mips change, which bumps its
+ * generation. Descriptors referencing it have to be rewritten when the generation changes.
+ */
+class TextureStreamer {
+  public:
+    void create(VkDeviceSize memoryCap, uint32_t maxFramesInFlight, uint32_t tailSize = 64,
+                VkDeviceSize uploadBudget = 4 * 1024 * 1024);
+    uint32_t add(const std::string& image, VmaAllocator allocator, Commands& commands,
+                 VkQueue graphicsQueue, VkDevice device);
+    void requestMip(uint32_t id, uint32_t mipLevel);
+    void setDistance(uint32_t id, float distance);
+    // Has to be called once per frame, after the frame's fence has been waited on.
+    void update(VmaAllocator allocator, StagingRing& stagingRing, VkCommandBuffer commandBuffer,
+                VkDevice device, uint32_t currentFrame);
+    void destroy(VmaAllocator allocator, VkDevice device);
+
+    VkImageView getView(uint32_t id);
+    uint32_t getGeneration(uint32_t id);
+    uint32_t getResidentMip(uint32_t id);
+    uint32_t getMipmapLevels(uint32_t id);
+    VkDeviceSize getResidentBytes();
+    void setMemoryCap(VkDeviceSize memoryCap);
+    void setReferenceDistance(float referenceDistance);
+
+  private:
+    struct Texture {
+        // Every level of the texture, tightly packed one after another.
+        std::vector<uint8_t> mipChain;
+        std::vector<VkDeviceSize> levelOffsets;
+        uint32_t width;
+        uint32_t height;
+        uint32_t levelCount;
+        uint32_t tailMip;
+        uint32_t residentMip;
+        uint32_t requestedMip;
+        float distance = -1.0f;
+        Image image;
+        VkImageView view;
+        uint32_t generation = 0;
+    };
+
+    struct RetiredImage {
+        Image image;
+        VkImageView view;
+        Buffer stagingBuffer;
+    };
+
+    void resize(Texture& texture, uint32_t newResidentMip, VmaAllocator allocator,
+                StagingRing& stagingRing, VkCommandBuffer commandBuffer, VkDevice device,
+                uint32_t currentFrame);
+    void destroyRetired(std::vector<RetiredImage>& retired, VmaAllocator allocator,
+                        VkDevice device);
+    void uploadLevels(Texture& texture, Image& image, uint32_t imageBaseMip, uint32_t firstLevel,
+                      uint32_t endLevel, VkBuffer buffer, VkDeviceSize bufferOffset,
+                      VkCommandBuffer commandBuffer);
+    uint32_t getDesiredMip(const Texture& texture);
+    VkDeviceSize getTargetBytes(VmaAllocator allocator);
+    VkDeviceSize getLevelBytes(const Texture& texture, uint32_t mipLevel);
+    VkDeviceSize getResidentBytes(const Texture& texture, uint32_t residentMip);
+
+    std::vector<Texture> textures;
+    // Images replaced while recording each frame in flight, freed once its fence is waited on.
+    std::vector<std::vector<RetiredImage>> retiredImages;
+    VkDeviceSize memoryCap = 0;
+    VkDeviceSize uploadBudget = 0;
+    VkDeviceSize residentBytes = 0;
+    uint32_t tailSize = 64;
+    float referenceDistance = 1.0f;
+};